@@ -1,12 +1,21 @@
 from .atomic_ops import AtomicOpsPlan
+from .compile_time import CompileTimePlan
+from .dynamic_list import DynamicListPlan
 from .fill import FillPlan
+from .kernel_launch import KernelLaunchPlan
+from .launch_overhead import LaunchOverheadPlan
 from .math_opts import MathOpsPlan
 from .matrix_ops import MatrixOpsPlan
 from .memcpy import MemcpyPlan
+from .pointer_activate import PointerActivatePlan
+from .range_for_vectorize import RangeForVectorizePlan
+from .reduction import ReductionPlan
 from .saxpy import SaxpyPlan
 from .stencil2d import Stencil2DPlan
 
 benchmark_plan_list = [
-    AtomicOpsPlan, FillPlan, MathOpsPlan, MatrixOpsPlan, MemcpyPlan, SaxpyPlan,
-    Stencil2DPlan
+    AtomicOpsPlan, CompileTimePlan, DynamicListPlan, FillPlan,
+    KernelLaunchPlan, LaunchOverheadPlan, MathOpsPlan, MatrixOpsPlan,
+    MemcpyPlan, PointerActivatePlan, RangeForVectorizePlan, ReductionPlan,
+    SaxpyPlan, Stencil2DPlan
 ]
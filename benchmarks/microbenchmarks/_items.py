@@ -5,6 +5,8 @@ import taichi as ti
 
 class BenchmarkItem:
     name = 'item'
+    # Items passed to ti.init() instead of the benchmark function
+    is_init_config = False
 
     def __init__(self):
         self._items = {}  # {'tag': impl, ...}
@@ -64,6 +66,14 @@ class Container(BenchmarkItem):
         self._items = {'field': ti.field, 'ndarray': ti.ndarray}
 
 
+class CpuScheduler(BenchmarkItem):
+    name = 'cpu_work_stealing'
+    is_init_config = True
+
+    def __init__(self):
+        self._items = {'thread_pool': False, 'work_stealing': True}
+
+
 class MathOps(BenchmarkItem):
     name = 'math_op'
 
@@ -1,5 +1,6 @@
 from microbenchmarks._items import BenchmarkItem
 from microbenchmarks._utils import End2EndTimer, get_ti_arch
+from taichi._lib import core as ti_python_core
 
 import taichi as ti
 
@@ -27,6 +28,19 @@ def kernel_executor(repeat, func, *args):
     return ti.profiler.get_kernel_profiler_total_time() * 1000 / repeat  #ms
 
 
+def ir_allocation_executor(counter):
+    # Returns an executor which reports the number of IR statements allocated,
+    # or of IR allocations that went to the heap, per call of func
+    def executor(repeat, func, *args):
+        before = ti_python_core.get_ir_allocation_stats()[counter]
+        for i in range(repeat):
+            func(*args)
+        after = ti_python_core.get_ir_allocation_stats()[counter]
+        return (after - before) / repeat
+
+    return executor
+
+
 class MetricType(BenchmarkItem):
     name = 'get_metric'
 
@@ -36,12 +50,19 @@ class MetricType(BenchmarkItem):
             'end2end_time_ms': end2end_executor
         }
 
+    # Metrics which plans can add with update()
+    ir_allocation_items = {
+        'ir_allocations': ir_allocation_executor('num_allocations'),
+        'ir_heap_allocations': ir_allocation_executor('num_heap_allocations')
+    }
+
     @staticmethod
-    def init_taichi(arch: str, tag_list: list):
+    def init_taichi(arch: str, tag_list: list, **kwargs):
         if set(['kernel_elapsed_time_ms']).issubset(tag_list):
-            ti.init(kernel_profiler=True, arch=get_ti_arch(arch))
-        elif set(['end2end_time_ms']).issubset(tag_list):
-            ti.init(kernel_profiler=False, arch=get_ti_arch(arch))
+            ti.init(kernel_profiler=True, arch=get_ti_arch(arch), **kwargs)
+        elif set(['end2end_time_ms']).issubset(tag_list) or set(
+                MetricType.ir_allocation_items).intersection(tag_list):
+            ti.init(kernel_profiler=False, arch=get_ti_arch(arch), **kwargs)
         else:
             return False
         return True
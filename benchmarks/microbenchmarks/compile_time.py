@@ -0,0 +1,87 @@
+from microbenchmarks._items import BenchmarkItem
+from microbenchmarks._metric import MetricType
+from microbenchmarks._plan import BenchmarkPlan
+
+import taichi as ti
+
+
+class KernelShape(BenchmarkItem):
+    name = 'kernel_shape'
+
+    def __init__(self):
+        self._items = {'large_task': None, 'many_tasks': None}
+
+
+class KernelSize(BenchmarkItem):
+    name = 'kernel_size'
+
+    def __init__(self):
+        # The number of unrolled steps of the large task, each of which adds a
+        # branch and a few scalarized local stores to the kernel, or the number
+        # of offloaded tasks, each of which is cloned on its own by codegen
+        self._items = {'steps_256': 256, 'steps_1024': 1024}
+
+
+class OfflineCache(BenchmarkItem):
+    name = 'offline_cache'
+    is_init_config = True
+
+    def __init__(self):
+        # Every repeat must compile the kernel again
+        self._items = {'no_offline_cache': False}
+
+
+def compile_large_task(arch, repeat, kernel_shape, kernel_size, get_metric):
+    n = 64
+    x = ti.field(ti.f32, shape=n)
+    y = ti.field(ti.f32, shape=8)
+
+    def compile_and_run():
+        # A new kernel is defined by each call, so that the time measured is
+        # dominated by its compilation
+        @ti.kernel
+        def large():
+            for _ in range(1):
+                acc = ti.Vector.zero(ti.f32, 8)
+                for j in ti.static(range(kernel_size)):
+                    t = x[j % n]
+                    if t > j:
+                        acc[j % 8] += t * j
+                    else:
+                        acc[(j + 1) % 8] -= t
+                for k in ti.static(range(8)):
+                    y[k] = acc[k]
+
+        large()
+
+    return get_metric(repeat, compile_and_run)
+
+
+def compile_many_tasks(arch, repeat, kernel_shape, kernel_size, get_metric):
+    n = 64
+    x = ti.field(ti.f32, shape=n)
+
+    def compile_and_run():
+        @ti.kernel
+        def many():
+            for j in ti.static(range(kernel_size)):
+                for i in x:
+                    x[i] = x[i] * 0.5 + j
+
+        many()
+
+    return get_metric(repeat, compile_and_run)
+
+
+class CompileTimePlan(BenchmarkPlan):
+    def __init__(self, arch: str):
+        super().__init__('compile_time', arch, basic_repeat_times=1)
+        # Allocation counts tell the IR allocator apart from the rest of the
+        # compilation time
+        metric = MetricType()
+        metric.update(MetricType.ir_allocation_items)
+        self.create_plan(KernelShape(), KernelSize(), OfflineCache(), metric)
+        # Only the end-to-end time includes the compilation
+        self.remove_cases_with_tags(['kernel_elapsed_time_ms'])
+        self.add_func(['large_task'], compile_large_task)
+        self.add_func(['many_tasks'], compile_many_tasks)
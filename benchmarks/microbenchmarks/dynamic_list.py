@@ -0,0 +1,73 @@
+from microbenchmarks._items import BenchmarkItem
+from microbenchmarks._metric import MetricType
+from microbenchmarks._plan import BenchmarkPlan
+
+import taichi as ti
+
+
+class ListOp(BenchmarkItem):
+    name = 'list_op'
+
+    def __init__(self):
+        self._items = {'append': None, 'read': None}
+
+
+class ListLength(BenchmarkItem):
+    name = 'list_length'
+
+    def __init__(self):
+        self._items = {'1K': 1024, '16K': 16 * 1024, '64K': 64 * 1024}
+
+
+def _make_lists(list_length, num_lists=64, chunk_size=64):
+    x = ti.field(ti.i32)
+    ti.root.dense(ti.i, num_lists).dynamic(ti.j,
+                                           list_length,
+                                           chunk_size=chunk_size).place(x)
+    return x, num_lists
+
+
+def dynamic_append(arch, repeat, list_op, list_length, get_metric):
+    x, num_lists = _make_lists(list_length)
+
+    @ti.kernel
+    def append(n: ti.i32):
+        for i in range(num_lists):
+            ti.deactivate(x.parent(), [i])
+            for j in range(n):
+                ti.append(x.parent(), i, j)
+
+    return get_metric(repeat, append, list_length)
+
+
+def dynamic_read(arch, repeat, list_op, list_length, get_metric):
+    x, num_lists = _make_lists(list_length)
+    y = ti.field(ti.i32, shape=num_lists)
+
+    @ti.kernel
+    def fill(n: ti.i32):
+        for i in range(num_lists):
+            for j in range(n):
+                ti.append(x.parent(), i, j)
+
+    @ti.kernel
+    def read(n: ti.i32):
+        for i in range(num_lists):
+            s = 0
+            for j in range(n):
+                s += x[i, j]
+            y[i] = s
+
+    fill(list_length)
+    return get_metric(repeat, read, list_length)
+
+
+class DynamicListPlan(BenchmarkPlan):
+    def __init__(self, arch: str):
+        super().__init__('dynamic_list', arch, basic_repeat_times=10)
+        self.create_plan(ListOp(), ListLength(), MetricType())
+        if arch not in ['x64', 'arm64', 'cuda']:
+            # Dynamic SNodes require the sparse extension
+            self.remove_cases_with_tags(['dynamic_list'])
+        self.add_func(['append'], dynamic_append)
+        self.add_func(['read'], dynamic_read)
@@ -0,0 +1,74 @@
+import numpy as np
+from microbenchmarks._items import BenchmarkItem
+from microbenchmarks._metric import MetricType
+from microbenchmarks._plan import BenchmarkPlan
+
+import taichi as ti
+
+
+class ArgumentKind(BenchmarkItem):
+    name = 'arguments'
+
+    def __init__(self):
+        self._items = {
+            'no_args': None,
+            'scalars': None,
+            'ndarrays': None,
+            'numpy_arrays': None
+        }
+
+
+# Each kernel has a single serial task doing nearly nothing, so that the time
+# measured is the cost of a launch.
+def launch_no_args(arch, repeat, arguments, get_metric):
+    x = ti.field(ti.i32, shape=())
+
+    @ti.kernel
+    def empty():
+        x[None] = 1
+
+    return get_metric(repeat, empty)
+
+
+def launch_scalars(arch, repeat, arguments, get_metric):
+    x = ti.field(ti.i32, shape=())
+
+    @ti.kernel
+    def empty(a: ti.i32, b: ti.i32, c: ti.f32, d: ti.f32):
+        x[None] = a
+
+    return get_metric(repeat, empty, 1, 2, 3.0, 4.0)
+
+
+def launch_ndarrays(arch, repeat, arguments, get_metric):
+    a = ti.ndarray(ti.f32, shape=16)
+    b = ti.ndarray(ti.f32, shape=16)
+
+    @ti.kernel
+    def empty(a: ti.types.ndarray(), b: ti.types.ndarray()):
+        a[0] = b[0]
+
+    return get_metric(repeat, empty, a, b)
+
+
+def launch_numpy_arrays(arch, repeat, arguments, get_metric):
+    a = np.zeros(16, dtype=np.float32)
+    b = np.zeros(16, dtype=np.float32)
+
+    @ti.kernel
+    def empty(a: ti.types.ndarray(), b: ti.types.ndarray()):
+        a[0] = b[0]
+
+    return get_metric(repeat, empty, a, b)
+
+
+class KernelLaunchPlan(BenchmarkPlan):
+    def __init__(self, arch: str):
+        super().__init__('kernel_launch', arch, basic_repeat_times=10000)
+        self.create_plan(ArgumentKind(), MetricType())
+        # The kernels do no work worth profiling, only end-to-end time counts
+        self.remove_cases_with_tags(['kernel_elapsed_time_ms'])
+        self.add_func(['no_args'], launch_no_args)
+        self.add_func(['scalars'], launch_scalars)
+        self.add_func(['ndarrays'], launch_ndarrays)
+        self.add_func(['numpy_arrays'], launch_numpy_arrays)
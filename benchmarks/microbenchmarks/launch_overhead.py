@@ -0,0 +1,33 @@
+from microbenchmarks._items import BenchmarkItem, CpuScheduler
+from microbenchmarks._metric import MetricType
+from microbenchmarks._plan import BenchmarkPlan
+
+import taichi as ti
+
+
+class LoopSize(BenchmarkItem):
+    name = 'loop_size'
+
+    def __init__(self):
+        self._items = {'empty': 0, 'tiny': 64, 'small': 4096}
+
+
+def launch_overhead_default(arch, repeat, loop_size, get_metric):
+    x = ti.field(ti.f32, shape=4096)
+
+    @ti.kernel
+    def range_for(n: ti.i32):
+        for i in range(n):
+            x[i] += 1.0
+
+    return get_metric(repeat, range_for, loop_size)
+
+
+class LaunchOverheadPlan(BenchmarkPlan):
+    def __init__(self, arch: str):
+        super().__init__('launch_overhead', arch, basic_repeat_times=1000)
+        self.create_plan(CpuScheduler(), LoopSize(), MetricType())
+        if arch not in ['x64', 'arm64']:
+            # The scheduler only affects the CPU backends
+            self.remove_cases_with_tags(['work_stealing'])
+        self.add_func(['launch_overhead'], launch_overhead_default)
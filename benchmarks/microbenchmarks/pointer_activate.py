@@ -0,0 +1,50 @@
+from microbenchmarks._items import BenchmarkItem, CpuScheduler
+from microbenchmarks._metric import MetricType
+from microbenchmarks._plan import BenchmarkPlan
+
+import taichi as ti
+
+
+class AccessPattern(BenchmarkItem):
+    name = 'access_pattern'
+
+    def __init__(self):
+        # Number of distinct blocks that all threads activate
+        self._items = {'same': 8, 'disjoint': 64 * 1024}
+
+
+def pointer_activate_default(arch, repeat, access_pattern, get_metric):
+    num_blocks = 64 * 1024
+    num_activations = 1024 * 1024
+    x = ti.field(ti.f32)
+    block = ti.root.pointer(ti.i, num_blocks)
+    block.dense(ti.i, 8).place(x)
+
+    @ti.kernel
+    def activate():
+        for i in range(num_activations):
+            ti.activate(block, [i % access_pattern])
+
+    @ti.kernel
+    def deactivate():
+        for i in range(access_pattern):
+            ti.deactivate(block, [i])
+
+    def activate_and_clear():
+        activate()
+        deactivate()
+
+    return get_metric(repeat, activate_and_clear)
+
+
+class PointerActivatePlan(BenchmarkPlan):
+    def __init__(self, arch: str):
+        super().__init__('pointer_activate', arch, basic_repeat_times=10)
+        self.create_plan(CpuScheduler(), AccessPattern(), MetricType())
+        if arch not in ['x64', 'arm64']:
+            # The scheduler only affects the CPU backends
+            self.remove_cases_with_tags(['work_stealing'])
+        if arch not in ['x64', 'arm64', 'cuda']:
+            # Pointer SNodes require the sparse extension
+            self.remove_cases_with_tags(['pointer_activate'])
+        self.add_func(['pointer_activate'], pointer_activate_default)
@@ -0,0 +1,71 @@
+from microbenchmarks._items import BenchmarkItem, DataSize, DataType
+from microbenchmarks._metric import MetricType
+from microbenchmarks._plan import BenchmarkPlan
+from microbenchmarks._utils import dtype_size, fill_random, scaled_repeat_times
+
+import taichi as ti
+
+
+class LoopKind(BenchmarkItem):
+    name = 'loop_kind'
+
+    def __init__(self):
+        self._items = {'saxpy': None, 'stencil_1d': None}
+
+
+class RangeForSplit(BenchmarkItem):
+    name = 'make_cpu_multithreading_loop'
+    is_init_config = True
+
+    def __init__(self):
+        # Whether range-fors are split into a serial loop per thread by the
+        # IR, or loop over the blocks scheduled by the runtime in codegen
+        self._items = {'split_per_thread': True, 'block_body': False}
+
+
+def saxpy(arch, repeat, loop_kind, dtype, dsize, get_metric):
+    repeat = scaled_repeat_times(arch, dsize, repeat)
+    n = dsize // dtype_size(dtype) // 3
+
+    x = ti.field(dtype, n)
+    y = ti.field(dtype, n)
+    z = ti.field(dtype, n)
+
+    @ti.kernel
+    def saxpy_range(a: dtype):
+        for i in range(n):
+            z[i] = a * x[i] + y[i]
+
+    fill_random(x, dtype, ti.field)
+    fill_random(y, dtype, ti.field)
+    return get_metric(repeat, saxpy_range, 17)
+
+
+def stencil_1d(arch, repeat, loop_kind, dtype, dsize, get_metric):
+    repeat = scaled_repeat_times(arch, dsize, repeat)
+    n = dsize // dtype_size(dtype) // 2
+
+    x = ti.field(dtype, n)
+    y = ti.field(dtype, n)
+
+    @ti.kernel
+    def stencil_range():
+        for i in range(1, n - 1):
+            y[i] = 0.25 * x[i - 1] + 0.5 * x[i] + 0.25 * x[i + 1]
+
+    fill_random(x, dtype, ti.field)
+    return get_metric(repeat, stencil_range)
+
+
+class RangeForVectorizePlan(BenchmarkPlan):
+    def __init__(self, arch: str):
+        super().__init__('range_for_vectorize', arch, basic_repeat_times=10)
+        dtype = DataType()
+        dtype.remove_integer()
+        self.create_plan(LoopKind(), RangeForSplit(), dtype, DataSize(),
+                         MetricType())
+        if arch not in ['x64', 'arm64']:
+            # Range-fors are only split per thread on the CPU backends
+            self.remove_cases_with_tags(['block_body'])
+        self.add_func(['saxpy'], saxpy)
+        self.add_func(['stencil_1d'], stencil_1d)
@@ -0,0 +1,68 @@
+from microbenchmarks._items import BenchmarkItem
+from microbenchmarks._metric import MetricType
+from microbenchmarks._plan import BenchmarkPlan
+
+import taichi as ti
+
+
+class LoopKind(BenchmarkItem):
+    name = 'loop_kind'
+
+    def __init__(self):
+        self._items = {'range_for': None, 'struct_for': None}
+
+
+class BlockDim(BenchmarkItem):
+    name = 'block_dim'
+
+    def __init__(self):
+        # Small blocks mean many blocks per thread, i.e. many TLS flushes if
+        # the TLS lived with the blocks
+        self._items = {'block_dim_16': 16, 'block_dim_1024': 1024}
+
+
+def range_for_reduction(arch, repeat, loop_kind, block_dim, get_metric):
+    n = 4 * 1024 * 1024
+    x = ti.field(ti.f32, shape=n)
+    s = ti.field(ti.f32, shape=())
+
+    @ti.kernel
+    def reduce():
+        ti.loop_config(block_dim=block_dim)
+        for i in range(n):
+            s[None] += x[i]
+
+    x.fill(1.0)
+    return get_metric(repeat, reduce)
+
+
+def struct_for_reduction(arch, repeat, loop_kind, block_dim, get_metric):
+    n = 4 * 1024 * 1024
+    x = ti.field(ti.f32)
+    ti.root.pointer(ti.i, n // 1024).dense(ti.i, 1024).place(x)
+    s = ti.field(ti.f32, shape=())
+
+    @ti.kernel
+    def fill():
+        for i in range(n):
+            x[i] = 1.0
+
+    @ti.kernel
+    def reduce():
+        ti.loop_config(block_dim=block_dim)
+        for i in x:
+            s[None] += x[i]
+
+    fill()
+    return get_metric(repeat, reduce)
+
+
+class ReductionPlan(BenchmarkPlan):
+    def __init__(self, arch: str):
+        super().__init__('reduction', arch, basic_repeat_times=10)
+        self.create_plan(LoopKind(), BlockDim(), MetricType())
+        if arch not in ['x64', 'arm64', 'cuda']:
+            # Pointer SNodes require the sparse extension
+            self.remove_cases_with_tags(['struct_for'])
+        self.add_func(['range_for'], range_for_reduction)
+        self.add_func(['struct_for'], struct_for_reduction)
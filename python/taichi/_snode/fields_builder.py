@@ -83,9 +83,12 @@ class FieldsBuilder:
         self.empty = False
         return self.root.pointer(indices, dimensions)
 
-    def _hash(self, indices, dimensions):
+    def hash(self, indices: Union[Sequence[_Axis], _Axis],
+             dimensions: Union[Sequence[int], int]):
         """Same as :func:`taichi.lang.snode.SNode.hash`"""
-        raise NotImplementedError()
+        self._check_not_finalized()
+        self.empty = False
+        return self.root.hash(indices, dimensions)
 
     def dynamic(self,
                 index: Union[Sequence[_Axis], _Axis],
@@ -356,6 +356,60 @@ class ScalarField(Field):
             arr = np.ascontiguousarray(arr)
         self._from_external_arr(arr)
 
+    def _batch_indices(self, indices):
+        import numpy as np  # pylint: disable=C0415
+        indices = np.ascontiguousarray(indices, dtype=np.int32)
+        ndim = len(self.shape)
+        if ndim == 0:
+            raise ValueError("Batched access is not supported on 0-D fields")
+        if indices.ndim == 1 and ndim == 1:
+            indices = indices.reshape(-1, 1)
+        if indices.ndim != 2 or indices.shape[1] != ndim:
+            raise ValueError(
+                f"Expected indices of shape (n, {ndim}), got {indices.shape}")
+        return indices
+
+    @python_scope
+    def gather(self, indices):
+        """Reads the elements at a batch of indices at once.
+
+        This costs at most a single kernel launch, instead of one per element
+        as with ``field[i]``.
+
+        Args:
+            indices (numpy.ndarray): Integer array of shape ``(n, ndim)``,
+                or ``(n,)`` for 1D fields.
+
+        Returns:
+            numpy.ndarray: The ``n`` elements.
+        """
+        import numpy as np  # pylint: disable=C0415
+        impl.get_runtime().materialize()
+        indices = self._batch_indices(indices)
+        values = np.empty(indices.shape[0], dtype=to_numpy_type(self.dtype))
+        self.snode.ptr.read_batch(indices.ctypes.data, values.ctypes.data,
+                                  indices.shape[0])
+        return values
+
+    @python_scope
+    def scatter(self, indices, values):
+        """Writes the elements at a batch of indices at once.
+
+        Args:
+            indices (numpy.ndarray): Integer array of shape ``(n, ndim)``,
+                or ``(n,)`` for 1D fields.
+            values (numpy.ndarray): The ``n`` elements to write.
+        """
+        import numpy as np  # pylint: disable=C0415
+        impl.get_runtime().materialize()
+        indices = self._batch_indices(indices)
+        values = np.ascontiguousarray(values, dtype=to_numpy_type(self.dtype))
+        if values.shape != (indices.shape[0], ):
+            raise ValueError(
+                f"Expected {indices.shape[0]} values, got {values.shape}")
+        self.snode.ptr.write_batch(indices.ctypes.data, values.ctypes.data,
+                                   indices.shape[0])
+
     @python_scope
     def __setitem__(self, key, value):
         self._initialize_host_accessors()
@@ -54,14 +54,26 @@ class SNode:
             dimensions = [dimensions] * len(axes)
         return SNode(self.ptr.pointer(axes, dimensions, get_traceback()))
 
-    @staticmethod
-    def _hash(axes, dimensions):
-        # original code is #def hash(self,axes, dimensions) without #@staticmethod   before fix pylint R0201
-        """Not supported."""
-        raise RuntimeError('hash not yet supported')
-        # if isinstance(dimensions, int):
-        #     dimensions = [dimensions] * len(axes)
-        # return SNode(self.ptr.hash(axes, dimensions))
+    def hash(self, axes, dimensions):
+        """Adds a hash SNode as a child component of `self`.
+
+        A hash SNode only allocates memory for its active cells, which makes
+        it suitable for very sparse fields with a large index space. It must
+        be a direct child of the root and is only supported on CPU backends.
+
+        Args:
+            axes (List[Axis]): Axes to activate.
+            dimensions (Union[List[int], int]): Shape of each axis.
+
+        Returns:
+            The added :class:`~taichi.lang.SNode` instance.
+        """
+        if impl.current_cfg().arch not in (_ti_core.x64, _ti_core.arm64):
+            raise TaichiRuntimeError(
+                "Hash SNode is not supported on this backend.")
+        if isinstance(dimensions, numbers.Number):
+            dimensions = [dimensions] * len(axes)
+        return SNode(self.ptr.hash(axes, dimensions, get_traceback()))
 
     def dynamic(self, axis, dimension, chunk_size=None):
         """Adds a dynamic SNode as a child component of `self`.
@@ -296,7 +308,8 @@ class SNode:
         for c in ch:
             c.deactivate_all()
         SNodeType = _ti_core.SNodeType
-        if self.ptr.type == SNodeType.pointer or self.ptr.type == SNodeType.bitmasked:
+        if self.ptr.type in (SNodeType.pointer, SNodeType.hash,
+                             SNodeType.bitmasked):
             from taichi._kernels import \
                 snode_deactivate  # pylint: disable=C0415
             snode_deactivate(self)
@@ -10,4 +10,19 @@ def print_memory_profiler_info():
     get_runtime().prog.print_memory_profiler_info()
 
 
-__all__ = ['print_memory_profiler_info']
+def get_memory_pool_stats():
+    """Returns the statistics of the host memory pool of the current arch.
+
+    The pool backs SNode trees, ndarrays and the runtime of the CPU backend.
+
+    Returns:
+        dict: ``reserved_bytes`` is the virtual address space obtained from
+        the OS, ``committed_bytes`` the part of it handed out and not yet
+        returned to the OS, and ``in_use_bytes`` the bytes currently
+        allocated.
+    """
+    get_runtime().materialize()
+    return get_runtime().prog.get_memory_pool_stats()
+
+
+__all__ = ['print_memory_profiler_info', 'get_memory_pool_stats']
@@ -119,6 +119,10 @@ class IRCloner : public IRVisitor {
   }
 
   static std::unique_ptr<IRNode> run(IRNode *root) {
+    // The copy is allocated from an arena of its own. If it is a block, it
+    // owns the arena, so that the passes run on it can allocate from it too.
+    auto arena = IRArena::create();
+    IRArena::Scope arena_scope(arena.get());
     std::unique_ptr<IRNode> new_root = root->clone();
     IRCloner cloner(new_root.get());
     cloner.phase = IRCloner::register_operand_map;
@@ -126,6 +130,9 @@ class IRCloner : public IRVisitor {
     cloner.phase = IRCloner::replace_operand;
     root->accept(&cloner);
 
+    if (auto block = dynamic_cast<Block *>(new_root.get())) {
+      block->arena = std::move(arena);
+    }
     return new_root;
   }
 };
@@ -368,6 +368,16 @@ class UniquelyAccessedBitStructGatherer : public BasicStmtVisitor {
   }
 };
 
+const PassID GatherUniquelyAccessedPointersPass::id =
+    "GatherUniquelyAccessedPointersPass";
+
+GatherUniquelyAccessedPointersPass::Result
+GatherUniquelyAccessedPointersPass::run(IRNode *root) {
+  auto [ptrs, arr_ptrs] =
+      irpass::analysis::gather_uniquely_accessed_pointers(root);
+  return {std::move(ptrs), std::move(arr_ptrs)};
+}
+
 const std::string GatherUniquelyAccessedBitStructsPass::id =
     "GatherUniquelyAccessedBitStructsPass";
 
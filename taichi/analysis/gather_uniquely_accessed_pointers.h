@@ -4,6 +4,20 @@
 
 namespace taichi::lang {
 
+// The pointers accessed by exactly one iteration of an offloaded loop, see
+// irpass::analysis::gather_uniquely_accessed_pointers.
+class GatherUniquelyAccessedPointersPass : public Pass {
+ public:
+  static const PassID id;
+
+  struct Result {
+    std::unordered_map<const SNode *, GlobalPtrStmt *> ptrs;
+    std::unordered_map<int, ExternalPtrStmt *> arr_ptrs;
+  };
+
+  static Result run(IRNode *root);
+};
+
 class GatherUniquelyAccessedBitStructsPass : public Pass {
  public:
   static const PassID id;
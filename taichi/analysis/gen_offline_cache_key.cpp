@@ -57,6 +57,12 @@ class ASTSerializer : public IRVisitor, public ExpressionVisitor {
     this->allow_undefined_visitor = false;
   }
 
+  // Feeds the fields to |hasher| instead of writing them to a stream
+  explicit ASTSerializer(FingerprintHasher *hasher)
+      : ExpressionVisitor(false), hasher_(hasher) {
+    this->allow_undefined_visitor = false;
+  }
+
   void set_ostream(std::ostream *os) {
     this->os_ = os;
   }
@@ -417,8 +423,9 @@ class ASTSerializer : public IRVisitor, public ExpressionVisitor {
     emit(stmt->outputs);
   }
 
-  static void run(IRNode *ast, std::ostream *os) {
-    ASTSerializer serializer(os);
+  template <typename Output>
+  static void run(IRNode *ast, Output *output) {
+    ASTSerializer serializer(output);
     ast->accept(&serializer);
     serializer.emit_dependencies();
   }
@@ -450,14 +457,22 @@ class ASTSerializer : public IRVisitor, public ExpressionVisitor {
   template <typename T>
   void emit_pod(const T &val) {
     static_assert(std::is_pod<T>::value);
+    if (hasher_) {
+      hasher_->update(&val, sizeof(T));
+      return;
+    }
     TI_ASSERT(os_);
     os_->write((const char *)&val, sizeof(T));
   }
 
   void emit_bytes(const char *bytes, std::size_t len) {
-    TI_ASSERT(os_);
     if (!bytes)
       return;
+    if (hasher_) {
+      hasher_->update(bytes, len);
+      return;
+    }
+    TI_ASSERT(os_);
     os_->write(bytes, len);
   }
 
@@ -495,6 +510,11 @@ class ASTSerializer : public IRVisitor, public ExpressionVisitor {
 
   void emit(const std::string &str) {
     std::size_t size = str.size();
+    if (hasher_) {
+      emit(size);
+      emit_bytes(str.data(), size);
+      return;
+    }
     std::size_t offset = string_pool_.size();
     string_pool_.insert(string_pool_.end(), str.begin(), str.end());
     emit(size);
@@ -647,6 +667,7 @@ class ASTSerializer : public IRVisitor, public ExpressionVisitor {
 #undef DEFINE_EMIT_ENUM
 
   std::ostream *os_{nullptr};
+  FingerprintHasher *hasher_{nullptr};
   std::unordered_set<const SNode *> snode_tree_roots_;
   std::unordered_map<Function *, std::size_t> real_funcs_;
   std::vector<char> string_pool_;
@@ -658,4 +679,8 @@ void gen_offline_cache_key(IRNode *ast, std::ostream *os) {
   ASTSerializer::run(ast, os);
 }
 
+void gen_offline_cache_fingerprint(IRNode *ast, FingerprintHasher *hasher) {
+  ASTSerializer::run(ast, hasher);
+}
+
 }  // namespace taichi::lang
@@ -10,10 +10,41 @@
 
 #include "picosha2.h"
 
+#ifdef TI_WITH_LLVM
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Host.h"
+#endif
+
+#include <algorithm>
+#include <cstring>
 #include <vector>
 
 namespace taichi::lang {
 
+#ifdef TI_WITH_LLVM
+// The object code of CPU kernels is specific to the host CPU
+static const std::string &get_host_cpu_key() {
+  static const std::string key = [] {
+    std::string result = llvm::sys::getHostCPUName().str();
+    llvm::StringMap<bool> features;
+    if (llvm::sys::getHostCPUFeatures(features)) {
+      std::vector<std::string> enabled;
+      for (const auto &feature : features) {
+        if (feature.getValue()) {
+          enabled.push_back(feature.getKey().str());
+        }
+      }
+      std::sort(enabled.begin(), enabled.end());
+      for (const auto &feature : enabled) {
+        result += "," + feature;
+      }
+    }
+    return result;
+  }();
+  return key;
+}
+#endif
+
 static std::vector<std::uint8_t> get_offline_cache_key_of_compile_config(
     const CompileConfig &config) {
   BinaryOutputSerializer serializer;
@@ -24,6 +55,8 @@ static std::vector<std::uint8_t> get_offline_cache_key_of_compile_config(
   serializer(config.check_out_of_bound);
   serializer(config.opt_level);
   serializer(config.external_optimization_level);
+  // The CPU backend only honors external_optimization_level with tiered JIT
+  serializer(config.tiered_jit);
   serializer(config.move_loop_invariant_outside_if);
   serializer(config.demote_dense_struct_fors);
   serializer(config.advanced_optimization);
@@ -39,6 +72,16 @@ static std::vector<std::uint8_t> get_offline_cache_key_of_compile_config(
   if (arch_is_cpu(config.arch)) {
     serializer(config.default_cpu_block_dim);
     serializer(config.cpu_max_num_threads);
+    serializer(config.cpu_adaptive_chunking);
+    serializer(config.cpu_slp_vectorization);
+    serializer(config.llvm_per_task_opt);
+    serializer(config.llvm_shared_runtime);
+    serializer(config.offline_cache_object_code);
+#ifdef TI_WITH_LLVM
+    if (config.offline_cache_object_code) {
+      serializer(get_host_cpu_key());
+    }
+#endif
   } else if (arch_is_gpu(config.arch)) {
     serializer(config.default_gpu_block_dim);
     serializer(config.gpu_max_reg);
@@ -48,6 +91,8 @@ static std::vector<std::uint8_t> get_offline_cache_key_of_compile_config(
   serializer(config.ad_stack_size);
   serializer(config.default_ad_stack_size);
   serializer(config.random_seed);
+  serializer(config.incremental_gc);
+  serializer(config.incremental_gc_budget);
   if (config.arch == Arch::cc) {
     serializer(config.cc_compile_cmd);
     serializer(config.cc_link_cmd);
@@ -151,6 +196,68 @@ std::string get_hashed_offline_cache_key_of_snode(const SNode *snode) {
   return picosha2::get_hash_hex_string(hasher);
 }
 
+void FingerprintHasher::update(const void *data, std::size_t size) {
+  auto *bytes = (const unsigned char *)data;
+  size_ += size;
+  for (; size >= 8; bytes += 8, size -= 8) {
+    std::uint64_t word;
+    std::memcpy(&word, bytes, 8);
+    mix(word);
+  }
+  if (size > 0) {
+    std::uint64_t word = 0;
+    std::memcpy(&word, bytes, size);
+    mix(word ^ (std::uint64_t)size << 56);
+  }
+}
+
+void FingerprintHasher::mix(std::uint64_t word) {
+  // The per-block steps of MurmurHash3_x64_128
+  word *= 0x87c37b91114253d5ull;
+  word = (word << 31 | word >> 33) * 0x4cf5ad432745937full;
+  h1_ ^= word;
+  h1_ = (h1_ << 27 | h1_ >> 37) + h2_;
+  h1_ = h1_ * 5 + 0x52dce729;
+  h2_ ^= word * 0x9fb21c651e98df25ull;
+  h2_ = (h2_ << 31 | h2_ >> 33) + h1_;
+  h2_ = h2_ * 5 + 0x38495ab5;
+}
+
+std::string FingerprintHasher::hex() const {
+  auto fmix = [](std::uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdull;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ull;
+    k ^= k >> 33;
+    return k;
+  };
+  auto h1 = h1_ ^ size_;
+  auto h2 = h2_ ^ size_;
+  h1 += h2;
+  h2 += h1;
+  h1 = fmix(h1);
+  h2 = fmix(h2);
+  h1 += h2;
+  h2 += h1;
+  return fmt::format("{:016x}{:016x}", h1, h2);
+}
+
+std::string get_kernel_fingerprint(const CompileConfig &config,
+                                   const DeviceCapabilityConfig &caps,
+                                   Kernel *kernel) {
+  TI_ASSERT(kernel);
+  FingerprintHasher hasher;
+  auto compile_config_key = get_offline_cache_key_of_compile_config(config);
+  auto device_caps_key = get_offline_cache_key_of_device_caps(caps);
+  hasher.update(compile_config_key.data(), compile_config_key.size());
+  hasher.update(device_caps_key.data(), device_caps_key.size());
+  gen_offline_cache_fingerprint(kernel->ir.get(), &hasher);
+  auto autodiff_mode = static_cast<std::size_t>(kernel->autodiff_mode);
+  hasher.update(&autodiff_mode, sizeof(autodiff_mode));
+  return hasher.hex();
+}
+
 std::string get_hashed_offline_cache_key(const CompileConfig &config,
                                          const DeviceCapabilityConfig &caps,
                                          Kernel *kernel) {
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 
 #include "taichi/rhi/arch.h"
@@ -17,6 +18,29 @@ std::string get_hashed_offline_cache_key_of_snode(const SNode *snode);
 std::string get_hashed_offline_cache_key(const CompileConfig &config,
                                          const DeviceCapabilityConfig &caps,
                                          Kernel *kernel);
+// Hashes the fields the offline cache key is made of into two 64-bit lanes.
+// Not cryptographic: only suitable for looking up kernels compiled by the
+// current process.
+class FingerprintHasher {
+ public:
+  void update(const void *data, std::size_t size);
+  std::string hex() const;
+
+ private:
+  void mix(std::uint64_t word);
+
+  std::uint64_t h1_{0x9e3779b97f4a7c15ull};
+  std::uint64_t h2_{0xc2b2ae3d27d4eb4full};
+  std::uint64_t size_{0};
+};
+
+// A cheap fingerprint of everything get_hashed_offline_cache_key() hashes.
+// It walks the same fields of the AST, but feeds them to a FingerprintHasher
+// instead of serializing them.
+std::string get_kernel_fingerprint(const CompileConfig &config,
+                                   const DeviceCapabilityConfig &caps,
+                                   Kernel *kernel);
 void gen_offline_cache_key(IRNode *ast, std::ostream *os);
+void gen_offline_cache_fingerprint(IRNode *ast, FingerprintHasher *hasher);
 
 }  // namespace taichi::lang
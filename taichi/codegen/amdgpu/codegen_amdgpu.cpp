@@ -283,6 +283,18 @@ class TaskCodeGenAMDGPU : public TaskCodeGenLLVM {
 
   void emit_amdgpu_gc(OffloadedStmt *stmt) {
     auto snode_id = tlctx->get_constant(stmt->snode->id);
+    if (compile_config.incremental_gc) {
+      // The amount of work is bounded, so a single thread suffices.
+      init_offloaded_task_function(stmt, "incremental_gc");
+      call("node_gc_incremental", get_runtime(), snode_id,
+           tlctx->get_constant(compile_config.incremental_gc_budget));
+      finalize_offloaded_task_function();
+      current_task->grid_dim = 1;
+      current_task->block_dim = 1;
+      offloaded_tasks.push_back(*current_task);
+      current_task = nullptr;
+      return;
+    }
     {
       init_offloaded_task_function(stmt, "gather_list");
       call("gc_parallel_0", get_context(), snode_id);
@@ -513,7 +525,7 @@ FunctionType AMDGPUModuleToFunctionConverter::convert(
         const auto arr_sz = context.array_runtime_sizes[i];
         if (arr_sz == 0)
           continue;
-        arg_buffers[i] = context.array_ptrs[{i}];
+        arg_buffers[i] = context.array_ptrs[i];
         if (context.device_allocation_type[i] ==
             LaunchContextBuilder::DevAllocType::kNone) {
           unsigned int attr_val[8];
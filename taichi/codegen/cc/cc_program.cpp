@@ -22,8 +22,10 @@ FunctionType CCProgramImpl::compile(const CompileConfig &compile_config,
   auto ker_ptr = ker.get();
   this->add_kernel(std::move(ker));
   return [ker_ptr](LaunchContextBuilder &ctx) {
-    for (auto &[idx, ptr] : ctx.array_ptrs) {
-      ctx.get_context().args[idx[0]] = (uint64)ptr;
+    for (int i = 0; i < taichi_max_num_args_total; i++) {
+      if (ctx.array_ptrs[i]) {
+        ctx.get_context().args[i] = (uint64)ctx.array_ptrs[i];
+      }
     }
     return ker_ptr->launch(&ctx.get_context());
   };
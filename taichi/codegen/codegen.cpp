@@ -2,6 +2,8 @@
 
 #include "codegen.h"
 
+#include <numeric>
+
 #if defined(TI_WITH_LLVM)
 #include "taichi/codegen/cpu/codegen_cpu.h"
 #include "taichi/runtime/llvm/llvm_offline_cache.h"
@@ -75,27 +77,77 @@ std::unique_ptr<KernelCodeGen> KernelCodeGen::create(
 #ifdef TI_WITH_LLVM
 
 LLVMCompiledKernel KernelCodeGen::compile_kernel_to_module() {
+  auto start_time = Time::get_time();
   irpass::ast_to_ir(compile_config_, *kernel, false);
+  auto ast_to_ir_end_time = Time::get_time();
+
+  auto data =
+      compile_tasks(&get_llvm_program(kernel->program)->compilation_workers);
+  auto tasks_end_time = Time::get_time();
+
+  auto llvm_compiled_kernel = tlctx_.link_compiled_tasks(std::move(data));
+  auto link_end_time = Time::get_time();
+  optimize_module(llvm_compiled_kernel.module.get());
+  auto end_time = Time::get_time();
 
+  if (compile_config_.print_compile_time_breakdown) {
+    auto ms = [](double t) { return t * 1000; };
+    TI_INFO(
+        "Compiled kernel {} in {:.2f} ms: ast_to_ir {:.2f} ms, {} tasks "
+        "{:.2f} ms (codegen {:.2f} ms, optimization {:.2f} ms summed over "
+        "tasks), linking {:.2f} ms, module optimization {:.2f} ms",
+        kernel->get_name(), ms(end_time - start_time),
+        ms(ast_to_ir_end_time - start_time), codegen_times_.size(),
+        ms(tasks_end_time - ast_to_ir_end_time),
+        ms(std::accumulate(codegen_times_.begin(), codegen_times_.end(), 0.0)),
+        ms(std::accumulate(task_opt_times_.begin(), task_opt_times_.end(),
+                           0.0)),
+        ms(link_end_time - tasks_end_time), ms(end_time - link_end_time));
+  }
+  return llvm_compiled_kernel;
+}
+
+std::vector<std::unique_ptr<LLVMCompiledTask>> KernelCodeGen::compile_tasks(
+    ParallelExecutor *worker) {
   auto block = dynamic_cast<Block *>(ir);
-  auto &worker = get_llvm_program(kernel->program)->compilation_workers;
   TI_ASSERT(block);
 
+  const bool separate_opt = optimize_tasks_separately();
   auto &offloads = block->statements;
   std::vector<std::unique_ptr<LLVMCompiledTask>> data(offloads.size());
+  codegen_times_.assign(offloads.size(), 0);
+  task_opt_times_.assign(offloads.size(), 0);
   for (int i = 0; i < offloads.size(); i++) {
     auto compile_func = [&, i] {
+      auto task_start_time = Time::get_time();
       tlctx_.fetch_this_thread_struct_module();
       auto offload = irpass::analysis::clone(offloads[i].get());
       irpass::re_id(offload.get());
       auto new_data = this->compile_task(compile_config_, nullptr,
                                          offload->as<OffloadedStmt>());
+      auto codegen_end_time = Time::get_time();
+      codegen_times_[i] = codegen_end_time - task_start_time;
+      if (separate_opt) {
+        tlctx_.link_task_with_runtime(new_data);
+        this->optimize_task_module(new_data.module.get());
+        task_opt_times_[i] = Time::get_time() - codegen_end_time;
+      }
       data[i] = std::make_unique<LLVMCompiledTask>(std::move(new_data));
     };
-    worker.enqueue(compile_func);
+    if (worker != nullptr) {
+      worker->enqueue(compile_func);
+    } else {
+      compile_func();
+    }
   }
-  worker.flush();
+  if (worker != nullptr) {
+    worker->flush();
+  }
+  return data;
+}
 
+LLVMCompiledKernel KernelCodeGen::link_tasks(
+    std::vector<std::unique_ptr<LLVMCompiledTask>> data) {
   auto llvm_compiled_kernel = tlctx_.link_compiled_tasks(std::move(data));
   optimize_module(llvm_compiled_kernel.module.get());
   return llvm_compiled_kernel;
@@ -12,6 +12,7 @@
 #endif
 namespace taichi::lang {
 class TaichiLLVMContext;
+class ParallelExecutor;
 
 /*
  [Note] Codegen of LLVM-based backends
@@ -59,6 +60,17 @@ class KernelCodeGen {
 #ifdef TI_WITH_LLVM
   virtual LLVMCompiledKernel compile_kernel_to_module();
 
+  // Compiles the offloaded tasks on |worker|, or on the calling thread if it
+  // is null. Only uses the LLVM contexts of the threads that run the tasks,
+  // unlike linking the tasks, which needs the shared linking context.
+  std::vector<std::unique_ptr<LLVMCompiledTask>> compile_tasks(
+      ParallelExecutor *worker);
+
+  // Links the tasks from compile_tasks() into a kernel module and optimizes
+  // it.
+  LLVMCompiledKernel link_tasks(
+      std::vector<std::unique_ptr<LLVMCompiledTask>> data);
+
   virtual LLVMCompiledTask compile_task(
       const CompileConfig &config,
       std::unique_ptr<llvm::Module> &&module = nullptr,
@@ -66,9 +78,29 @@ class KernelCodeGen {
     TI_NOT_IMPLEMENTED
   }
 
+  // Replaces the module of |data| with its object code for the host, which
+  // can be cached and loaded into the JIT without running the LLVM backend.
+  virtual void emit_object_code(LLVMCompiledKernel &data) {
+    TI_NOT_IMPLEMENTED
+  }
+
  protected:
+  // Whether each task is linked with the runtime and optimized by
+  // optimize_task_module() on the compilation workers. optimize_module() then
+  // only has to clean up the linked kernel module.
+  virtual bool optimize_tasks_separately() const {
+    return false;
+  }
+
+  virtual void optimize_task_module(llvm::Module *module) {
+  }
+
   virtual void optimize_module(llvm::Module *module) {
   }
+
+  // Per-task times of the last compile_tasks(), in seconds
+  std::vector<double> codegen_times_;
+  std::vector<double> task_opt_times_;
 #endif
 
   const CompileConfig &get_compile_config() const {
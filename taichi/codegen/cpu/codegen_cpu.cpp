@@ -15,6 +15,7 @@
 #include "llvm/Support/Host.h"
 #include "llvm/MC/TargetRegistry.h"
 #include "llvm/Transforms/IPO.h"
+#include "llvm/Transforms/IPO/AlwaysInliner.h"
 #include "llvm/Transforms/IPO/PassManagerBuilder.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
@@ -47,18 +48,16 @@ class TaskCodeGenCPU : public TaskCodeGenLLVM {
 
     auto *tls_prologue = create_xlogue(stmt->tls_prologue);
 
-    // The loop body
+    // The body runs a whole block [block_begin, block_end) of indices, so
+    // that the index loop is visible to LLVM, which can vectorize it.
     llvm::Function *body;
     {
       auto guard = get_function_creation_guard(
           {llvm::PointerType::get(get_runtime_type("RuntimeContext"), 0),
            llvm::Type::getInt8PtrTy(*llvm_context),
-           tlctx->get_data_type<int>()});
+           tlctx->get_data_type<int>(), tlctx->get_data_type<int>()});
 
-      auto loop_var = create_entry_block_alloca(PrimitiveType::i32);
-      loop_vars_llvm[stmt].push_back(loop_var);
-      builder->CreateStore(get_arg(2), loop_var);
-      stmt->body->accept(this);
+      create_block_loop(stmt, get_arg(2), get_arg(3));
 
       body = guard.body;
     }
@@ -67,12 +66,66 @@ class TaskCodeGenCPU : public TaskCodeGenLLVM {
 
     auto [begin, end] = get_range_for_bounds(stmt);
 
-    call("cpu_parallel_range_for", get_arg(0),
-         tlctx->get_constant(stmt->num_cpu_threads), begin, end,
+    // A serial range-for (num_cpu_threads = 1) has nothing to balance.
+    const bool adaptive = compile_config.cpu_adaptive_chunking &&
+                          compile_config.cpu_block_dim_adaptive &&
+                          stmt->num_cpu_threads > 1;
+    call(adaptive ? "cpu_parallel_range_for_adaptive"
+                  : "cpu_parallel_range_for",
+         get_arg(0), tlctx->get_constant(stmt->num_cpu_threads), begin, end,
          tlctx->get_constant(step), tlctx->get_constant(stmt->block_dim),
          tls_prologue, body, epilogue, tlctx->get_constant(stmt->tls_size));
   }
 
+  void create_block_loop(OffloadedStmt *stmt,
+                         llvm::Value *block_begin,
+                         llvm::Value *block_end) {
+    using namespace llvm;
+    BasicBlock *loop_test =
+        BasicBlock::Create(*llvm_context, "block_loop_test", func);
+    BasicBlock *loop_body =
+        BasicBlock::Create(*llvm_context, "block_loop_body", func);
+    BasicBlock *loop_inc =
+        BasicBlock::Create(*llvm_context, "block_loop_inc", func);
+    BasicBlock *after_loop =
+        BasicBlock::Create(*llvm_context, "after_block_loop", func);
+
+    auto loop_var_ty = tlctx->get_data_type(PrimitiveType::i32);
+    auto loop_var = create_entry_block_alloca(PrimitiveType::i32);
+    loop_vars_llvm[stmt].push_back(loop_var);
+    if (!stmt->reversed) {
+      builder->CreateStore(block_begin, loop_var);
+    } else {
+      builder->CreateStore(
+          builder->CreateSub(block_end, tlctx->get_constant(1)), loop_var);
+    }
+    builder->CreateBr(loop_test);
+
+    builder->SetInsertPoint(loop_test);
+    auto index = builder->CreateLoad(loop_var_ty, loop_var);
+    auto cond = stmt->reversed ? builder->CreateICmpSGE(index, block_begin)
+                               : builder->CreateICmpSLT(index, block_end);
+    builder->CreateCondBr(cond, loop_body, after_loop);
+
+    // A continue of the offloaded loop goes on with the next index
+    auto saved_loop_reentry = current_loop_reentry;
+    current_loop_reentry = loop_inc;
+    builder->SetInsertPoint(loop_body);
+    stmt->body->accept(this);
+    current_loop_reentry = saved_loop_reentry;
+    if (!returned) {
+      builder->CreateBr(loop_inc);
+    } else {
+      returned = false;
+    }
+
+    builder->SetInsertPoint(loop_inc);
+    create_increment(loop_var, tlctx->get_constant(stmt->reversed ? -1 : 1));
+    builder->CreateBr(loop_test);
+
+    builder->SetInsertPoint(after_loop);
+  }
+
   void create_offload_mesh_for(OffloadedStmt *stmt) override {
     auto *tls_prologue = create_mesh_xlogue(stmt->tls_prologue);
 
@@ -231,56 +284,112 @@ static llvm::Triple get_host_target_triple() {
 }  // namespace
 
 #ifdef TI_WITH_LLVM
+namespace {
+
+using TaskFunc = int32 (*)(void *);
+
+// Everything about launching a kernel that is known once it is compiled, so
+// that a launch only touches its array arguments and calls the tasks.
+struct CPUKernelLauncher {
+  LlvmRuntimeExecutor *executor;
+  std::string kernel_name;
+  // The indices of the array arguments, i.e. the ones a launch may patch
+  std::vector<int> array_arg_ids;
+  std::vector<TaskFunc> task_funcs;
+
+  void operator()(LaunchContextBuilder &context) const;
+};
+
+void CPUKernelLauncher::operator()(LaunchContextBuilder &context) const {
+  // Don't format the message unless it is going to be printed
+  TI_TRACE_IF(Logger::get_instance().get_level() <= spdlog::level::trace,
+              "Launching kernel {}", kernel_name);
+  context.get_context().runtime = executor->get_llvm_runtime();
+  bool has_external_array = false;
+  for (int i : array_arg_ids) {
+    if (context.device_allocation_type[i] ==
+        LaunchContextBuilder::DevAllocType::kNone) {
+      // External arrays live in host memory owned by the caller, which may be
+      // modified or freed as soon as we return.
+      has_external_array = true;
+      context.set_arg(i, (uint64)context.array_ptrs[i]);
+    } else if (context.array_runtime_sizes[i] > 0) {
+      // For taichi ndarrays, context.array_ptrs saves pointer to its
+      // |DeviceAllocation|, CPU backend actually want to use the raw ptr here.
+      DeviceAllocation *ptr =
+          static_cast<DeviceAllocation *>(context.array_ptrs[i]);
+      uint64 host_ptr = (uint64)executor->get_ndarray_alloc_info_ptr(*ptr);
+      context.set_arg(i, host_ptr);
+      context.set_array_device_allocation_type(
+          i, LaunchContextBuilder::DevAllocType::kNone);
+
+      if (context.has_grad[i]) {
+        DeviceAllocation *ptr_grad =
+            static_cast<DeviceAllocation *>(context.get_grad_arg<void *>(i));
+        uint64 host_ptr_grad =
+            (uint64)executor->get_ndarray_alloc_info_ptr(*ptr_grad);
+        context.set_grad_arg(i, host_ptr_grad);
+      }
+    }
+  }
+  auto *launch_queue = executor->get_cpu_launch_queue();
+  if (launch_queue == nullptr || has_external_array ||
+      context.result_buffer_size > 0) {
+    executor->wait_for_cpu_launches();
+    for (auto task : task_funcs) {
+      task(&context.get_context());
+    }
+    return;
+  }
+  // The launch context belongs to the caller, so the deferred launch works
+  // on its own copy of the runtime context and the argument buffer.
+  auto runtime_context =
+      std::make_shared<RuntimeContext>(context.get_context());
+  std::shared_ptr<char[]> arg_buffer(new char[context.arg_buffer_size]);
+  std::memcpy(arg_buffer.get(), runtime_context->arg_buffer,
+              context.arg_buffer_size);
+  runtime_context->arg_buffer = arg_buffer.get();
+  std::shared_ptr<uint64[]> result_buffer(
+      new uint64[taichi_result_buffer_entries]());
+  runtime_context->result_buffer = result_buffer.get();
+  launch_queue->enqueue(
+      [task_funcs = task_funcs, runtime_context, arg_buffer, result_buffer] {
+        for (auto task : task_funcs) {
+          task(runtime_context.get());
+        }
+      });
+}
+
+}  // namespace
+
 FunctionType CPUModuleToFunctionConverter::convert(
     const std::string &kernel_name,
     const std::vector<Callable::Parameter> &args,
     LLVMCompiledKernel data) const {
   TI_AUTO_PROF;
-  auto jit_module = executor_->create_jit_module(std::move(data.module));
-  using TaskFunc = int32 (*)(void *);
-  std::vector<TaskFunc> task_funcs;
-  task_funcs.reserve(data.tasks.size());
+  auto jit_module =
+      data.object_code.empty()
+          ? executor_->create_jit_module(std::move(data.module))
+          : executor_->create_jit_module_from_object(data.object_code);
+  CPUKernelLauncher launcher;
+  launcher.executor = executor_;
+  launcher.kernel_name = kernel_name;
+  for (int i = 0; i < (int)args.size(); i++) {
+    if (args[i].is_array) {
+      launcher.array_arg_ids.push_back(i);
+    }
+  }
+  launcher.task_funcs.reserve(data.tasks.size());
   for (auto &task : data.tasks) {
     auto *func_ptr = jit_module->lookup_function(task.name);
     TI_ASSERT_INFO(func_ptr, "Offloaded datum function {} not found",
                    task.name);
-    task_funcs.push_back((TaskFunc)(func_ptr));
+    launcher.task_funcs.push_back((TaskFunc)(func_ptr));
   }
-  // Do NOT capture `this`...
-  return [executor = this->executor_, args, kernel_name,
-          task_funcs](LaunchContextBuilder &context) {
-    TI_TRACE("Launching kernel {}", kernel_name);
-    context.get_context().runtime = executor->get_llvm_runtime();
-    // For taichi ndarrays, context.array_ptrs saves pointer to its
-    // |DeviceAllocation|, CPU backend actually want to use the raw ptr here.
-    for (int i = 0; i < (int)args.size(); i++) {
-      if (args[i].is_array && context.device_allocation_type[i] ==
-                                  LaunchContextBuilder::DevAllocType::kNone) {
-        context.set_arg(i, (uint64)context.array_ptrs[{i}]);
-      }
-      if (args[i].is_array &&
-          context.device_allocation_type[i] !=
-              LaunchContextBuilder::DevAllocType::kNone &&
-          context.array_runtime_sizes[i] > 0) {
-        DeviceAllocation *ptr =
-            static_cast<DeviceAllocation *>(context.array_ptrs[{i}]);
-        uint64 host_ptr = (uint64)executor->get_ndarray_alloc_info_ptr(*ptr);
-        context.set_arg(i, host_ptr);
-        context.set_array_device_allocation_type(
-            i, LaunchContextBuilder::DevAllocType::kNone);
-
-        if (context.has_grad[i]) {
-          DeviceAllocation *ptr_grad =
-              static_cast<DeviceAllocation *>(context.get_grad_arg<void *>(i));
-          uint64 host_ptr_grad =
-              (uint64)executor->get_ndarray_alloc_info_ptr(*ptr_grad);
-          context.set_grad_arg(i, host_ptr_grad);
-        }
-      }
-    }
-    for (auto task : task_funcs) {
-      task(&context.get_context());
-    }
+  // Shared, so that copying the FunctionType doesn't copy the launcher
+  return [launcher = std::make_shared<const CPUKernelLauncher>(
+              std::move(launcher))](LaunchContextBuilder &context) {
+    (*launcher)(context);
   };
 }
 
@@ -292,9 +401,10 @@ LLVMCompiledTask KernelCodeGenCPU::compile_task(
   return gen.run_compilation();
 }
 
-void KernelCodeGenCPU::optimize_module(llvm::Module *module) {
-  TI_AUTO_PROF
-  const auto &compile_config = get_compile_config();
+namespace {
+
+std::unique_ptr<llvm::TargetMachine> create_host_target_machine(
+    const CompileConfig &compile_config) {
   auto triple = get_host_target_triple();
 
   std::string err_str;
@@ -318,9 +428,6 @@ void KernelCodeGenCPU::optimize_module(llvm::Module *module) {
   options.NoZerosInBSS = false;
   options.GuaranteedTailCallOpt = false;
 
-  llvm::legacy::FunctionPassManager function_pass_manager(module);
-  llvm::legacy::PassManager module_pass_manager;
-
   llvm::StringRef mcpu = llvm::sys::getHostCPUName();
   std::unique_ptr<llvm::TargetMachine> target_machine(
       target->createTargetMachine(triple.str(), mcpu.str(), "", options,
@@ -328,8 +435,44 @@ void KernelCodeGenCPU::optimize_module(llvm::Module *module) {
                                   llvm::CodeGenOpt::Aggressive));
 
   TI_ERROR_UNLESS(target_machine.get(), "Could not allocate target machine!");
+  return target_machine;
+}
 
-  module->setDataLayout(target_machine->createDataLayout());
+// The CPU backend only honors external_optimization_level with tiered JIT,
+// and compiles at O3 otherwise.
+int get_opt_level(const CompileConfig &compile_config) {
+  if (!compile_config.tiered_jit) {
+    return 3;
+  }
+  return std::clamp(compile_config.external_optimization_level, 0, 3);
+}
+
+// Adds the module passes of the pipeline for |opt_level| to
+// |module_pass_manager| after running its function passes on |module|.
+//
+// Level 0 only inlines the always_inline functions, and marks all the others
+// optnone so that the JIT selects their instructions with FastISel.
+void run_function_passes_and_populate(
+    llvm::Module *module,
+    llvm::TargetMachine *target_machine,
+    int opt_level,
+    llvm::legacy::PassManager &module_pass_manager) {
+  if (opt_level == 0) {
+    llvm::legacy::PassManager inliner;
+    inliner.add(llvm::createAlwaysInlinerLegacyPass());
+    inliner.add(llvm::createGlobalDCEPass());
+    inliner.run(*module);
+    for (auto &func : *module) {
+      if (!func.isDeclaration()) {
+        func.removeFnAttr(llvm::Attribute::AlwaysInline);
+        func.addFnAttr(llvm::Attribute::NoInline);
+        func.addFnAttr(llvm::Attribute::OptimizeNone);
+      }
+    }
+    return;
+  }
+
+  llvm::legacy::FunctionPassManager function_pass_manager(module);
 
   module_pass_manager.add(llvm::createTargetTransformInfoWrapperPass(
       target_machine->getTargetIRAnalysis()));
@@ -337,10 +480,10 @@ void KernelCodeGenCPU::optimize_module(llvm::Module *module) {
       target_machine->getTargetIRAnalysis()));
 
   llvm::PassManagerBuilder b;
-  b.OptLevel = 3;
+  b.OptLevel = opt_level;
   b.Inliner = llvm::createFunctionInliningPass(b.OptLevel, 0, false);
-  b.LoopVectorize = true;
-  b.SLPVectorize = true;
+  b.LoopVectorize = opt_level >= 2;
+  b.SLPVectorize = opt_level >= 2;
 
   target_machine->adjustPassManager(b);
 
@@ -368,6 +511,76 @@ void KernelCodeGenCPU::optimize_module(llvm::Module *module) {
   module_pass_manager.add(llvm::createIndVarSimplifyPass());
   module_pass_manager.add(llvm::createSeparateConstOffsetFromGEPPass(false));
   module_pass_manager.add(llvm::createEarlyCSEPass(true));
+}
+
+}  // namespace
+
+void KernelCodeGenCPU::emit_object_code(LLVMCompiledKernel &data) {
+  TI_AUTO_PROF
+  TI_ASSERT(data.module);
+  // Emit exactly what the JIT session would, i.e. use its target machine
+  auto jtmb = llvm::orc::JITTargetMachineBuilder::detectHost();
+  if (!jtmb) {
+    TI_ERROR("LLVM TargetMachineBuilder has failed.");
+  }
+  auto target_machine = jtmb->createTargetMachine();
+  if (!target_machine) {
+    TI_ERROR("Could not allocate target machine: {}",
+             llvm::toString(target_machine.takeError()));
+  }
+  data.module->setDataLayout((*target_machine)->createDataLayout());
+
+  llvm::SmallVector<char, 0> buffer;
+  llvm::raw_svector_ostream ostream(buffer);
+  llvm::legacy::PassManager pass_manager;
+  TI_ERROR_IF((*target_machine)
+                  ->addPassesToEmitFile(pass_manager, ostream, nullptr,
+                                        llvm::CGFT_ObjectFile),
+              "The target machine can't emit object files");
+  {
+    TI_PROFILER("llvm_emit_object_code");
+    pass_manager.run(*data.module);
+  }
+  data.object_code.assign(buffer.begin(), buffer.end());
+  data.module = nullptr;
+}
+
+bool KernelCodeGenCPU::optimize_tasks_separately() const {
+  return get_compile_config().llvm_per_task_opt;
+}
+
+void KernelCodeGenCPU::optimize_task_module(llvm::Module *module) {
+  TI_AUTO_PROF
+  auto target_machine = create_host_target_machine(get_compile_config());
+  module->setDataLayout(target_machine->createDataLayout());
+
+  llvm::legacy::PassManager module_pass_manager;
+  run_function_passes_and_populate(module, target_machine.get(),
+                                   get_opt_level(get_compile_config()),
+                                   module_pass_manager);
+  {
+    TI_PROFILER("llvm_module_pass");
+    module_pass_manager.run(*module);
+  }
+}
+
+void KernelCodeGenCPU::optimize_module(llvm::Module *module) {
+  TI_AUTO_PROF
+  const auto &compile_config = get_compile_config();
+  auto target_machine = create_host_target_machine(compile_config);
+  module->setDataLayout(target_machine->createDataLayout());
+
+  llvm::legacy::PassManager module_pass_manager;
+  if (optimize_tasks_separately()) {
+    // The tasks have been optimized with their own copies of the runtime
+    // functions. Linking them only leaves dead and duplicated globals behind.
+    module_pass_manager.add(llvm::createGlobalDCEPass());
+    module_pass_manager.add(llvm::createConstantMergePass());
+  } else {
+    run_function_passes_and_populate(module, target_machine.get(),
+                                     get_opt_level(compile_config),
+                                     module_pass_manager);
+  }
 
   llvm::SmallString<8> outstr;
   llvm::raw_svector_ostream ostream(outstr);
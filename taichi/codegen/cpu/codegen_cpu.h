@@ -25,7 +25,13 @@ class KernelCodeGenCPU : public KernelCodeGen {
       std::unique_ptr<llvm::Module> &&module = nullptr,
       OffloadedStmt *stmt = nullptr) override;
 
+  void emit_object_code(LLVMCompiledKernel &data) override;
+
  protected:
+  bool optimize_tasks_separately() const override;
+
+  void optimize_task_module(llvm::Module *module) override;
+
   void optimize_module(llvm::Module *module) override;
 #endif  // TI_WITH_LLVM
 };
@@ -228,6 +228,9 @@ std::unique_ptr<RuntimeObject> TaskCodeGenLLVM::emit_struct_meta_object(
   } else if (snode->type == SNodeType::pointer) {
     meta = std::make_unique<RuntimeObject>("PointerMeta", this, builder.get());
     emit_struct_meta_base("Pointer", meta->ptr, snode);
+  } else if (snode->type == SNodeType::hash) {
+    meta = std::make_unique<RuntimeObject>("HashMeta", this, builder.get());
+    emit_struct_meta_base("Hash", meta->ptr, snode);
   } else if (snode->type == SNodeType::root) {
     meta = std::make_unique<RuntimeObject>("RootMeta", this, builder.get());
     emit_struct_meta_base("Root", meta->ptr, snode);
@@ -259,7 +262,8 @@ void TaskCodeGenLLVM::emit_struct_meta_base(const std::string &name,
         StructCompilerLLVM::get_llvm_body_type(module.get(), snode);
     auto element_ty = body_type->getArrayElementType();
     element_size = tlctx->get_type_size(element_ty);
-  } else if (snode->type == SNodeType::pointer) {
+  } else if (snode->type == SNodeType::pointer ||
+             snode->type == SNodeType::hash) {
     auto element_ty = StructCompilerLLVM::get_llvm_node_type(
         module.get(), snode->ch[0].get());
     element_size = tlctx->get_type_size(element_ty);
@@ -1062,7 +1066,8 @@ void TaskCodeGenLLVM::visit(ContinueStmt *stmt) {
     }
     return false;
   };
-  if (stmt_in_off_range_for()) {
+  if (stmt_in_off_range_for() && current_loop_reentry == nullptr) {
+    // The body function runs a single index, see create_offload_range_for
     builder->CreateRetVoid();
   } else {
     TI_ASSERT(current_loop_reentry != nullptr);
@@ -1115,6 +1120,9 @@ void TaskCodeGenLLVM::emit_list_gen(OffloadedStmt *listgen) {
     // Since there's only one container to expand, we need a special kernel for
     // more parallelism.
     call("element_listgen_root", get_runtime(), meta_parent, meta_child);
+  } else if (snode_parent->type == SNodeType::hash) {
+    // Containers of a hash node are enumerated by table slot.
+    call("element_listgen_hash", get_runtime(), meta_parent, meta_child);
   } else {
     call("element_listgen_nonroot", get_runtime(), meta_parent, meta_child);
   }
@@ -1122,7 +1130,12 @@ void TaskCodeGenLLVM::emit_list_gen(OffloadedStmt *listgen) {
 
 void TaskCodeGenLLVM::emit_gc(OffloadedStmt *stmt) {
   auto snode = stmt->snode->id;
-  call("node_gc", get_runtime(), tlctx->get_constant(snode));
+  if (compile_config.incremental_gc) {
+    call("node_gc_incremental", get_runtime(), tlctx->get_constant(snode),
+         tlctx->get_constant(compile_config.incremental_gc_budget));
+  } else {
+    call("node_gc", get_runtime(), tlctx->get_constant(snode));
+  }
 }
 
 void TaskCodeGenLLVM::emit_gc_rc() {
@@ -1773,6 +1786,7 @@ void TaskCodeGenLLVM::visit(SNodeLookupStmt *stmt) {
         builder->CreateGEP(parent_ty, parent, llvm_val[stmt->input_index]);
   } else if (snode->type == SNodeType::dense ||
              snode->type == SNodeType::pointer ||
+             snode->type == SNodeType::hash ||
              snode->type == SNodeType::dynamic ||
              snode->type == SNodeType::bitmasked) {
     if (stmt->activate) {
@@ -2046,6 +2060,16 @@ void TaskCodeGenLLVM::create_offload_struct_for(OffloadedStmt *stmt) {
     }
   }
 
+  // On CPU, the TLS lives with the threads rather than the blocks, so the TLS
+  // xlogues are separate functions that the runtime calls once per thread.
+  const bool tls_per_thread = arch_is_cpu(current_arch());
+  llvm::Value *tls_prologue = nullptr;
+  llvm::Value *tls_epilogue = nullptr;
+  if (tls_per_thread) {
+    tls_prologue = create_xlogue(stmt->tls_prologue);
+    tls_epilogue = create_xlogue(stmt->tls_epilogue);
+  }
+
   {
     // Create the loop body function
     auto guard = get_function_creation_guard({
@@ -2114,7 +2138,7 @@ void TaskCodeGenLLVM::create_offload_struct_for(OffloadedStmt *stmt) {
     call(refine, parent_coordinates, block_corner_coordinates,
          tlctx->get_constant(0));
 
-    if (stmt->tls_prologue) {
+    if (stmt->tls_prologue && !tls_per_thread) {
       stmt->tls_prologue->accept(this);
     }
 
@@ -2162,8 +2186,14 @@ void TaskCodeGenLLVM::create_offload_struct_for(OffloadedStmt *stmt) {
     // initialize the coordinates
     auto new_coordinates = create_entry_block_alloca(physical_coordinate_ty);
 
-    call(refine, parent_coordinates, new_coordinates,
-         builder->CreateLoad(loop_index_ty, loop_index));
+    llvm::Value *cell_index = builder->CreateLoad(loop_index_ty, loop_index);
+    if (leaf_block->type == SNodeType::hash) {
+      // A hash container is iterated by table slot; recover the cell index
+      // stored in the slot.
+      cell_index = call(leaf_block, element.get("element"), "get_slot_key",
+                        {cell_index});
+    }
+    call(refine, parent_coordinates, new_coordinates, cell_index);
 
     // For a bit-vectorized loop over a quant array, one more refine step is
     // needed to make final coordinates non-consecutive, since each thread will
@@ -2192,6 +2222,13 @@ void TaskCodeGenLLVM::create_offload_struct_for(OffloadedStmt *stmt) {
       is_active =
           builder->CreateTrunc(is_active, llvm::Type::getInt1Ty(*llvm_context));
       exec_cond = builder->CreateAnd(exec_cond, is_active);
+    } else if (leaf_block->type == SNodeType::hash) {
+      auto is_active =
+          call(leaf_block, element.get("element"), "is_slot_active",
+               {builder->CreateLoad(loop_index_ty, loop_index)});
+      is_active =
+          builder->CreateTrunc(is_active, llvm::Type::getInt1Ty(*llvm_context));
+      exec_cond = builder->CreateAnd(exec_cond, is_active);
     }
 
     builder->CreateCondBr(exec_cond, struct_for_body_bb, body_tail_bb);
@@ -2221,34 +2258,48 @@ void TaskCodeGenLLVM::create_offload_struct_for(OffloadedStmt *stmt) {
       call("block_barrier");  // "__syncthreads()"
     }
 
-    if (stmt->tls_epilogue) {
+    if (stmt->tls_epilogue && !tls_per_thread) {
       stmt->tls_epilogue->accept(this);
     }
   }
 
   int list_element_size = std::min(leaf_block->max_num_elements(),
                                    (int64)taichi_listgen_max_element_size);
+  if (leaf_block->type == SNodeType::hash) {
+    // The hash table may hold more slots than max_num_elements.
+    list_element_size = taichi_listgen_max_element_size;
+  }
   int num_splits = std::max(1, list_element_size / stmt->block_dim +
                                    (list_element_size % stmt->block_dim != 0));
 
-  auto struct_for_func = get_runtime_function("parallel_struct_for");
-
-  if (arch_is_gpu(current_arch())) {
-    struct_for_func = llvm::cast<llvm::Function>(
-        module
-            ->getOrInsertFunction(
-                tlctx->get_struct_for_func_name(stmt->tls_size),
-                struct_for_func->getFunctionType(),
-                struct_for_func->getAttributes())
-            .getCallee());
-    struct_for_tls_sizes.insert(stmt->tls_size);
-  }
-  // Loop over nodes in the element list, in parallel
-  call(struct_for_func, get_context(), tlctx->get_constant(leaf_block->id),
-       tlctx->get_constant(list_element_size), tlctx->get_constant(num_splits),
-       body, tlctx->get_constant(stmt->tls_size),
-       tlctx->get_constant(stmt->num_cpu_threads));
-  // TODO: why do we need num_cpu_threads on GPUs?
+  if (tls_per_thread) {
+    call("cpu_parallel_struct_for", get_context(),
+         tlctx->get_constant(leaf_block->id),
+         tlctx->get_constant(list_element_size),
+         tlctx->get_constant(num_splits), body, tls_prologue, tls_epilogue,
+         tlctx->get_constant(stmt->tls_size),
+         tlctx->get_constant(stmt->num_cpu_threads));
+  } else {
+    auto struct_for_func = get_runtime_function("parallel_struct_for");
+
+    if (arch_is_gpu(current_arch())) {
+      struct_for_func = llvm::cast<llvm::Function>(
+          module
+              ->getOrInsertFunction(
+                  tlctx->get_struct_for_func_name(stmt->tls_size),
+                  struct_for_func->getFunctionType(),
+                  struct_for_func->getAttributes())
+              .getCallee());
+      struct_for_tls_sizes.insert(stmt->tls_size);
+    }
+    // Loop over nodes in the element list, in parallel
+    call(struct_for_func, get_context(), tlctx->get_constant(leaf_block->id),
+         tlctx->get_constant(list_element_size),
+         tlctx->get_constant(num_splits), body,
+         tlctx->get_constant(stmt->tls_size),
+         tlctx->get_constant(stmt->num_cpu_threads));
+    // TODO: why do we need num_cpu_threads on GPUs?
+  }
 
   current_coordinates = nullptr;
   parent_coordinates = nullptr;
@@ -2520,6 +2571,24 @@ void TaskCodeGenLLVM::visit(MatrixInitStmt *stmt) {
   llvm_val[stmt] = vec;
 }
 
+void TaskCodeGenLLVM::visit(VectorPackStmt *stmt) {
+  // Always an LLVM vector, regardless of how TensorTypes are lowered
+  auto tensor_type = stmt->ret_type->as<TensorType>();
+  auto type = llvm::VectorType::get(
+      tlctx->get_data_type(tensor_type->get_element_type()),
+      tensor_type->get_num_elements(), /*scalable=*/false);
+  llvm::Value *vec = llvm::UndefValue::get(type);
+  for (int i = 0; i < stmt->values.size(); ++i) {
+    vec = builder->CreateInsertElement(vec, llvm_val[stmt->values[i]], i);
+  }
+  llvm_val[stmt] = vec;
+}
+
+void TaskCodeGenLLVM::visit(VectorExtractStmt *stmt) {
+  llvm_val[stmt] =
+      builder->CreateExtractElement(llvm_val[stmt->vector], stmt->lane);
+}
+
 void TaskCodeGenLLVM::eliminate_unused_functions() {
   TaichiLLVMContext::eliminate_unused_functions(
       module.get(), [&](std::string func_name) {
@@ -2842,7 +2911,10 @@ LLVMCompiledTask LLVMCompiledTask::clone() const {
 }
 
 LLVMCompiledKernel LLVMCompiledKernel::clone() const {
-  return {tasks, llvm::CloneModule(*module)};
+  LLVMCompiledKernel cloned{tasks,
+                            module ? llvm::CloneModule(*module) : nullptr};
+  cloned.object_code = object_code;
+  return cloned;
 }
 
 }  // namespace taichi::lang
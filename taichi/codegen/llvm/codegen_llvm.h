@@ -389,6 +389,10 @@ class TaskCodeGenLLVM : public IRVisitor, public LLVMModuleBuilder {
 
   void visit(MatrixInitStmt *stmt) override;
 
+  void visit(VectorPackStmt *stmt) override;
+
+  void visit(VectorExtractStmt *stmt) override;
+
   llvm::Value *create_xlogue(std::unique_ptr<Block> &block);
 
   llvm::Value *create_mesh_xlogue(std::unique_ptr<Block> &block);
@@ -37,6 +37,10 @@ CompiledKernelData::Err CompiledKernelData::load_impl(
   } catch (const liong::json::JsonException &) {
     return Err::kParseMetadataFailed;
   }
+  if (data_.is_object_code) {
+    data_.compiled_data.object_code = file.src_code();
+    return Err::kNoError;
+  }
   llvm::SMDiagnostic err;
   auto ret = llvm::parseAssemblyString(file.src_code(), err, llvm_ctx_);
   if (!ret) {  // File not found or Parse failed
@@ -56,6 +60,10 @@ CompiledKernelData::Err CompiledKernelData::dump_impl(
   } catch (const liong::json::JsonException &) {
     return Err::kSerMetadataFailed;
   }
+  if (data_.is_object_code) {
+    file.set_src_code(data_.compiled_data.object_code);
+    return Err::kNoError;
+  }
   std::string str;
   llvm::raw_string_ostream oss(str);
   data_.compiled_data.module->print(oss, /*AAW=*/nullptr);
@@ -23,13 +23,17 @@ class CompiledKernelData : public lang::CompiledKernelData {
     const StructType *args_type = nullptr;
     size_t args_size{0};
 
+    // Whether |compiled_data| holds object code instead of a module
+    bool is_object_code{false};
+
     TI_IO_DEF(args,
               rets,
               compiled_data,
               ret_type,
               ret_size,
               args_type,
-              args_size);
+              args_size,
+              is_object_code);
 
     InternalData() = default;
 
@@ -40,7 +44,8 @@ class CompiledKernelData : public lang::CompiledKernelData {
           ret_type(o.ret_type),
           ret_size(o.ret_size),
           args_type(o.args_type),
-          args_size(o.args_size) {
+          args_size(o.args_size),
+          is_object_code(o.is_object_code) {
     }
 
     InternalData(InternalData &&o) = default;
@@ -36,6 +36,11 @@ KernelCompiler::CKDPtr KernelCompiler::compile(
   auto codegen = KernelCodeGen::create(compile_config, &kernel_def, &chi_ir,
                                        *config_.tlctx);
   data.compiled_data = codegen->compile_kernel_to_module();
+  if (arch_is_cpu(compile_config.arch) &&
+      compile_config.offline_cache_object_code) {
+    codegen->emit_object_code(data.compiled_data);
+    data.is_object_code = true;
+  }
   data.args = kernel_def.parameter_list;
   data.rets = kernel_def.rets;
   data.args_type = kernel_def.args_type;
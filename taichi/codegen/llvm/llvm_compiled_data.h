@@ -45,6 +45,9 @@ struct LLVMCompiledTask {
 struct LLVMCompiledKernel {
   std::vector<OffloadedTask> tasks;
   std::unique_ptr<llvm::Module> module{nullptr};
+  // Host object code of the kernel, emitted by
+  // KernelCodeGen::emit_object_code(). |module| is null when it is set.
+  std::string object_code;
   LLVMCompiledKernel() = default;
   LLVMCompiledKernel(LLVMCompiledKernel &&) = default;
   LLVMCompiledKernel &operator=(LLVMCompiledKernel &&) = default;
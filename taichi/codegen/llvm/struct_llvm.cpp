@@ -112,6 +112,21 @@ void StructCompilerLLVM::generate_types(SNode &snode) {
         llvm::StructType::get(*ctx, {llvm::PointerType::getInt32Ty(*ctx),
                                      llvm::PointerType::getInt32Ty(*ctx)});
     body_type = llvm::PointerType::getInt8PtrTy(*ctx);
+  } else if (type == SNodeType::hash) {
+    // The runtime keeps one table per hash SNode and keys it by the 32-bit
+    // linearized cell index.
+    TI_ERROR_IF(snode.parent == nullptr ||
+                    snode.parent->type != SNodeType::root,
+                "Hash SNode must be a direct child of the root.");
+    TI_ERROR_IF(snode.num_cells_per_container >
+                    std::numeric_limits<int32>::max(),
+                "Hash SNode with {} cells exceeds the 32-bit key range.",
+                snode.num_cells_per_container);
+    // mutex, number of used slots, and the hash table
+    aux_type =
+        llvm::StructType::get(*ctx, {llvm::PointerType::getInt32Ty(*ctx),
+                                     llvm::PointerType::getInt32Ty(*ctx)});
+    body_type = llvm::PointerType::getInt8PtrTy(*ctx);
   } else {
     TI_P(snode.type_name());
     TI_NOT_IMPLEMENTED;
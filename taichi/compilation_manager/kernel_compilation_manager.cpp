@@ -1,5 +1,8 @@
 #include "taichi/compilation_manager/kernel_compilation_manager.h"
 
+#include <sstream>
+#include <streambuf>
+
 #include "taichi/analysis/offline_cache_util.h"
 #include "taichi/codegen/compiled_kernel_data.h"
 #include "taichi/util/offline_cache.h"
@@ -50,10 +53,29 @@ struct CacheCleanerUtils<CacheData> {
 
 }  // namespace offline_cache
 
+namespace {
+
+// Reads memory owned by someone else, so that a record of the packed cache
+// is deserialized in place.
+class ViewStreamBuf : public std::streambuf {
+ public:
+  explicit ViewStreamBuf(std::string_view data) {
+    auto *begin = const_cast<char *>(data.data());
+    setg(begin, begin, begin + data.size());
+  }
+};
+
+}  // namespace
+
 KernelCompilationManager::KernelCompilationManager(Config config)
     : config_(std::move(config)) {
   TI_DEBUG("Create KernelCompilationManager with offline_cache_file_path = {}",
            config_.offline_cache_path);
+  if (config_.packed) {
+    packed_cache_ =
+        std::make_unique<PackedKernelCache>(config_.offline_cache_path);
+    return;
+  }
   auto filepath = join_path(config_.offline_cache_path, kMetadataFilename);
   auto lock_path = join_path(config_.offline_cache_path, kMetadataLockName);
   if (path_exists(filepath)) {
@@ -86,6 +108,28 @@ void KernelCompilationManager::dump() {
     return;
   }
 
+  if (packed_cache_) {
+    std::vector<PackedKernelCache::Entry> entries;
+    for (auto &[kernel_key, kernel] : caching_kernels_) {
+      if (kernel.cache_mode != CacheData::MemAndDiskCache) {
+        continue;
+      }
+      std::ostringstream oss(std::ios::out | std::ios::binary);
+      auto err = kernel.compiled_kernel_data->dump(oss);
+      if (err == CompiledKernelData::Err::kNoError) {
+        entries.push_back({kernel_key, oss.str()});
+      } else {
+        TI_DEBUG("Dump cached CompiledKernelData(kernel_key={}) failed: {}",
+                 kernel_key, CompiledKernelData::get_err_msg(err));
+      }
+    }
+    caching_kernels_.clear();
+    // Warns by itself if the lock can't be taken
+    packed_cache_->commit(entries, used_packed_keys_);
+    used_packed_keys_.clear();
+    return;
+  }
+
   taichi::create_directories(config_.offline_cache_path);
   auto filepath = join_path(config_.offline_cache_path, kMetadataFilename);
   auto lock_path = join_path(config_.offline_cache_path, kMetadataLockName);
@@ -150,6 +194,11 @@ void KernelCompilationManager::clean_offline_cache(
     offline_cache::CleanCachePolicy policy,
     int max_bytes,
     double cleaning_factor) const {
+  if (config_.packed) {
+    PackedKernelCache(config_.offline_cache_path)
+        .clean(policy, max_bytes, cleaning_factor);
+    return;
+  }
   using CacheCleaner = offline_cache::CacheCleaner<CacheData>;
   offline_cache::CacheCleanerConfig config;
   config.path = config_.offline_cache_path;
@@ -181,14 +230,23 @@ std::unique_ptr<CompiledKernelData> KernelCompilationManager::compile_kernel(
 std::string KernelCompilationManager::make_kernel_key(
     const CompileConfig &compile_config,
     const DeviceCapabilityConfig &caps,
-    const Kernel &kernel_def) const {
+    const Kernel &kernel_def) {
   auto kernel_key = kernel_def.get_cached_kernel_key();
   if (kernel_key.empty()) {
     if (!kernel_def.ir_is_ast()) {
       kernel_key = kernel_def.get_name();
     } else {  // The kernel key is generated from AST
-      kernel_key = get_hashed_offline_cache_key(compile_config, caps,
-                                                (Kernel *)&kernel_def);
+      auto fingerprint =
+          get_kernel_fingerprint(compile_config, caps, (Kernel *)&kernel_def);
+      auto &key = fingerprint_to_key_[fingerprint];
+      if (!key.empty()) {
+        ++stats_.fingerprint_hits;
+      } else {
+        ++stats_.fingerprint_misses;
+        key = get_hashed_offline_cache_key(compile_config, caps,
+                                           (Kernel *)&kernel_def);
+      }
+      kernel_key = key;
     }
 
     kernel_def.set_kernel_key_for_cache(kernel_key);
@@ -207,9 +265,40 @@ const CompiledKernelData *KernelCompilationManager::try_load_cached_kernel(
     if (iter != kernels.end()) {
       TI_DEBUG("Create kernel '{}' from in-memory cache (key='{}')",
                kernel_def.get_name(), kernel_key);
+      ++stats_.memory_hits;
       return iter->second.compiled_kernel_data.get();
     }
   }
+  // Find in the packed disk-cache
+  if (cache_mode == CacheData::MemAndDiskCache && packed_cache_) {
+    std::string_view data;
+    if (!packed_cache_->find(kernel_key, &data)) {
+      return nullptr;
+    }
+    ViewStreamBuf buf(data);
+    std::istream is(&buf);
+    CompiledKernelData::Err err;
+    auto loaded = CompiledKernelData::load(is, &err);
+    if (err != CompiledKernelData::Err::kNoError) {
+      TI_DEBUG("Load packed CompiledKernelData(kernel_key={}) failed: {}",
+               kernel_key, CompiledKernelData::get_err_msg(err));
+      return nullptr;
+    }
+    TI_DEBUG("Create kernel '{}' from packed cache (key='{}')",
+             kernel_def.get_name(), kernel_key);
+    TI_ASSERT(loaded->arch() == arch);
+    // Keep it in memory only: the packed cache already holds it
+    KernelCacheData k;
+    k.kernel_key = kernel_key;
+    k.created_at = k.last_used_at = std::time(nullptr);
+    k.compiled_kernel_data = std::move(loaded);
+    k.size = data.size();
+    k.cache_mode = CacheData::MemCache;
+    used_packed_keys_.push_back(kernel_key);
+    ++stats_.disk_hits;
+    return (caching_kernels_[kernel_key] = std::move(k))
+        .compiled_kernel_data.get();
+  }
   // Find in disk-cache (cached_data_)
   if (cache_mode == CacheData::MemAndDiskCache) {
     auto &kernels = cached_data_.kernels;
@@ -223,6 +312,7 @@ const CompiledKernelData *KernelCompilationManager::try_load_cached_kernel(
         k.last_used_at = std::time(nullptr);
         k.compiled_kernel_data = std::move(loaded);
         updated_data_.push_back(&k);
+        ++stats_.disk_hits;
         return k.compiled_kernel_data.get();
       }
     }
@@ -240,6 +330,7 @@ const CompiledKernelData &KernelCompilationManager::compile_and_cache_kernel(
               "Cache kernel '{}' (key='{}')", kernel_def.get_name(),
               kernel_key);
   TI_ASSERT(caching_kernels_.find(kernel_key) == caching_kernels_.end());
+  ++stats_.misses;
   KernelCacheData k;
   k.kernel_key = kernel_key;
   k.created_at = k.last_used_at = std::time(nullptr);
@@ -8,6 +8,7 @@
 #include "taichi/util/offline_cache.h"
 #include "taichi/codegen/kernel_compiler.h"
 #include "taichi/codegen/compiled_kernel_data.h"
+#include "taichi/compilation_manager/packed_kernel_cache.h"
 
 namespace taichi::lang {
 
@@ -54,6 +55,20 @@ class KernelCompilationManager final {
   struct Config {
     std::string offline_cache_path;
     std::unique_ptr<KernelCompiler> kernel_compiler;
+    // Use a PackedKernelCache in |offline_cache_path|
+    bool packed{false};
+  };
+
+  // Kernels are first looked up by their cheap fingerprint, which maps to the
+  // full kernel key of a kernel seen before. The full key is only computed
+  // when the fingerprint is new. The kernel is then looked up by key in
+  // memory, then on disk, and finally compiled.
+  struct CacheStats {
+    std::size_t fingerprint_hits{0};
+    std::size_t fingerprint_misses{0};
+    std::size_t memory_hits{0};
+    std::size_t disk_hits{0};
+    std::size_t misses{0};
   };
 
   explicit KernelCompilationManager(Config init_params);
@@ -66,6 +81,10 @@ class KernelCompilationManager final {
   // Dump the cached data in memory to disk
   void dump();
 
+  const CacheStats &get_cache_stats() const {
+    return stats_;
+  }
+
   // Run offline cache cleaning
   void clean_offline_cache(offline_cache::CleanCachePolicy policy,
                            int max_bytes,
@@ -81,7 +100,7 @@ class KernelCompilationManager final {
 
   std::string make_kernel_key(const CompileConfig &compile_config,
                               const DeviceCapabilityConfig &caps,
-                              const Kernel &kernel_def) const;
+                              const Kernel &kernel_def);
 
   const CompiledKernelData *try_load_cached_kernel(
       const Kernel &kernel_def,
@@ -106,6 +125,11 @@ class KernelCompilationManager final {
   CachingKernels caching_kernels_;
   CacheData cached_data_;
   std::vector<KernelCacheData *> updated_data_;
+  std::unordered_map<std::string, std::string> fingerprint_to_key_;
+  std::unique_ptr<PackedKernelCache> packed_cache_;
+  // Keys of the kernels loaded from |packed_cache_|
+  std::vector<std::string> used_packed_keys_;
+  CacheStats stats_;
 };
 
 }  // namespace taichi::lang
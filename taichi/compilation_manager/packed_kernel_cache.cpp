@@ -0,0 +1,507 @@
+#include "taichi/compilation_manager/packed_kernel_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+#include "taichi/common/core.h"
+#include "taichi/common/version.h"
+#include "taichi/util/io.h"
+#include "taichi/util/lock.h"
+
+#if !defined(TI_PLATFORM_WINDOWS)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace taichi::lang {
+
+namespace {
+
+constexpr char kDataMagic[8] = {'T', 'I', 'P', 'A', 'C', 'K', '0', '1'};
+constexpr char kIndexMagic[8] = {'T', 'I', 'I', 'N', 'D', 'X', '0', '1'};
+constexpr std::uint32_t kRecordMagic = 0x4b524954;  // "TIRK"
+constexpr std::uint64_t kInitialIndexCapacity = 64;
+
+struct DataHeader {
+  char magic[8];
+  std::uint16_t version[3];
+  std::uint16_t padding;
+  // Identifies the data file an index refers to, since compaction replaces
+  // the data file and its index one after the other.
+  std::uint64_t generation;
+};
+
+// Followed by the key, the data and a padding to 8 bytes
+struct RecordHeader {
+  std::uint32_t magic;
+  std::uint32_t key_size;
+  std::uint64_t data_size;
+};
+
+// Followed by |capacity| IndexSlots
+struct IndexHeader {
+  char magic[8];
+  std::uint16_t version[3];
+  std::uint16_t padding;
+  std::uint64_t generation;
+  std::uint64_t capacity;
+  std::uint64_t num_kernels;
+  std::uint64_t live_bytes;
+};
+
+std::uint64_t hash_key(const std::string &key) {
+  // FNV-1a
+  std::uint64_t h = 14695981039346656037ull;
+  for (char c : key) {
+    h = (h ^ (std::uint64_t)(unsigned char)c) * 1099511628211ull;
+  }
+  return h;
+}
+
+std::uint64_t record_size(std::uint64_t key_size, std::uint64_t data_size) {
+  return (sizeof(RecordHeader) + key_size + data_size + 7) / 8 * 8;
+}
+
+bool is_current_version(const std::uint16_t version[3]) {
+  return version[0] == TI_VERSION_MAJOR && version[1] == TI_VERSION_MINOR &&
+         version[2] == TI_VERSION_PATCH;
+}
+
+template <typename Header>
+void init_header(Header *header, const char (&magic)[8]) {
+  std::memset(header, 0, sizeof(Header));
+  std::memcpy(header->magic, magic, sizeof(magic));
+  header->version[0] = TI_VERSION_MAJOR;
+  header->version[1] = TI_VERSION_MINOR;
+  header->version[2] = TI_VERSION_PATCH;
+}
+
+template <typename Header>
+bool is_valid_header(const Header &header, const char (&magic)[8]) {
+  return std::memcmp(header.magic, magic, sizeof(magic)) == 0 &&
+         is_current_version(header.version);
+}
+
+std::uint64_t new_generation() {
+  std::random_device rd;
+  return ((std::uint64_t)rd() << 32) ^ (std::uint64_t)rd() ^
+         (std::uint64_t)std::time(nullptr);
+}
+
+// Returns the record at |offset| of the mapped |data|, if it is complete and
+// belongs to |key|.
+const RecordHeader *find_record(const MappedFile &data,
+                                std::uint64_t offset,
+                                const std::string &key) {
+  if (offset + sizeof(RecordHeader) > data.size()) {
+    return nullptr;
+  }
+  const auto *record = (const RecordHeader *)(data.data() + offset);
+  if (record->magic != kRecordMagic || record->key_size != key.size() ||
+      offset + record_size(record->key_size, record->data_size) > data.size() ||
+      std::memcmp(record + 1, key.data(), key.size()) != 0) {
+    return nullptr;
+  }
+  return record;
+}
+
+void replace_file(const std::string &tmp_path, const std::string &path) {
+  std::error_code ec;
+  std::filesystem::rename(tmp_path, path, ec);
+  TI_ERROR_IF(ec, "Failed to replace {}: {}", path, ec.message());
+}
+
+}  // namespace
+
+struct PackedKernelCache::IndexSlot {
+  std::uint64_t key_hash;
+  // Offset of the record in the data file, 0 for an empty slot
+  std::uint64_t offset;
+  std::int64_t created_at;
+  std::int64_t last_used_at;
+};
+
+struct PackedKernelCache::Index {
+  IndexHeader header;
+  std::vector<IndexSlot> slots;
+
+  void insert(const IndexSlot &slot) {
+    if ((header.num_kernels + 1) * 2 > slots.size()) {
+      std::vector<IndexSlot> old_slots(
+          std::max<std::size_t>(slots.size() * 2, kInitialIndexCapacity));
+      std::swap(slots, old_slots);
+      header.capacity = slots.size();
+      for (const auto &s : old_slots) {
+        if (s.offset != 0) {
+          place(s);
+        }
+      }
+    }
+    place(slot);
+    header.num_kernels++;
+  }
+
+  // |data| must be the mapping of the data file the index refers to
+  IndexSlot *find(const MappedFile &data, const std::string &key) {
+    const auto mask = slots.size() - 1;
+    const auto h = hash_key(key);
+    for (auto i = h & mask; slots[i].offset != 0; i = (i + 1) & mask) {
+      if (slots[i].key_hash == h && find_record(data, slots[i].offset, key)) {
+        return &slots[i];
+      }
+    }
+    return nullptr;
+  }
+
+  void place(const IndexSlot &slot) {
+    const auto mask = slots.size() - 1;
+    auto i = slot.key_hash & mask;
+    while (slots[i].offset != 0) {
+      i = (i + 1) & mask;
+    }
+    slots[i] = slot;
+  }
+};
+
+MappedFile::~MappedFile() {
+  unmap();
+}
+
+bool MappedFile::map(const std::string &path) {
+  unmap();
+#if defined(TI_PLATFORM_WINDOWS)
+  std::ifstream ifs(path, std::ios::in | std::ios::binary);
+  if (!ifs.is_open()) {
+    return false;
+  }
+  buffer_.assign(std::istreambuf_iterator<char>(ifs),
+                 std::istreambuf_iterator<char>());
+  data_ = buffer_.data();
+  size_ = buffer_.size();
+  return true;
+#else
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return false;
+  }
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+    ::close(fd);
+    return false;
+  }
+  void *ptr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (ptr == MAP_FAILED) {
+    return false;
+  }
+  data_ = (const char *)ptr;
+  size_ = st.st_size;
+  return true;
+#endif
+}
+
+void MappedFile::unmap() {
+#if defined(TI_PLATFORM_WINDOWS)
+  buffer_.clear();
+  buffer_.shrink_to_fit();
+#else
+  if (data_) {
+    ::munmap((void *)data_, size_);
+  }
+#endif
+  data_ = nullptr;
+  size_ = 0;
+}
+
+PackedKernelCache::PackedKernelCache(std::string path)
+    : path_(std::move(path)) {
+  remap();
+}
+
+std::string PackedKernelCache::data_path() const {
+  return join_path(path_, kDataFilename);
+}
+
+std::string PackedKernelCache::index_path() const {
+  return join_path(path_, kIndexFilename);
+}
+
+bool PackedKernelCache::remap() {
+  data_file_.unmap();
+  index_file_.unmap();
+  if (!index_file_.map(index_path()) || !data_file_.map(data_path())) {
+    index_file_.unmap();
+    data_file_.unmap();
+    return false;
+  }
+  const auto *index_header = (const IndexHeader *)index_file_.data();
+  const auto *data_header = (const DataHeader *)data_file_.data();
+  const bool valid =
+      index_file_.size() >= sizeof(IndexHeader) &&
+      data_file_.size() >= sizeof(DataHeader) &&
+      is_valid_header(*index_header, kIndexMagic) &&
+      is_valid_header(*data_header, kDataMagic) &&
+      index_header->generation == data_header->generation &&
+      index_file_.size() ==
+          sizeof(IndexHeader) + index_header->capacity * sizeof(IndexSlot);
+  if (!valid) {
+    index_file_.unmap();
+    data_file_.unmap();
+  }
+  return valid;
+}
+
+const char *PackedKernelCache::lookup(const std::string &kernel_key,
+                                      std::size_t *size) const {
+  if (!index_file_.data()) {
+    return nullptr;
+  }
+  const auto *header = (const IndexHeader *)index_file_.data();
+  const auto *slots = (const IndexSlot *)(header + 1);
+  const auto capacity = header->capacity;
+  const auto h = hash_key(kernel_key);
+  for (std::uint64_t i = h & (capacity - 1), num_probes = 0;
+       num_probes < capacity; i = (i + 1) & (capacity - 1), num_probes++) {
+    const auto &slot = slots[i];
+    if (slot.offset == 0) {
+      return nullptr;
+    }
+    const RecordHeader *record = nullptr;
+    if (slot.key_hash != h ||
+        !(record = find_record(data_file_, slot.offset, kernel_key))) {
+      continue;
+    }
+    *size = record->data_size;
+    return (const char *)(record + 1) + record->key_size;
+  }
+  return nullptr;
+}
+
+bool PackedKernelCache::find(const std::string &kernel_key,
+                             std::string_view *data) {
+  std::size_t size = 0;
+  const char *ptr = lookup(kernel_key, &size);
+  // Another process may have added the kernel since the files were mapped
+  if (!ptr && remap()) {
+    ptr = lookup(kernel_key, &size);
+  }
+  if (!ptr) {
+    return false;
+  }
+  *data = std::string_view(ptr, size);
+  return true;
+}
+
+bool PackedKernelCache::read_index(Index *index) const {
+  std::ifstream index_ifs(index_path(), std::ios::in | std::ios::binary);
+  std::ifstream data_ifs(data_path(), std::ios::in | std::ios::binary);
+  if (!index_ifs.is_open() || !data_ifs.is_open()) {
+    return false;
+  }
+  DataHeader data_header;
+  if (!index_ifs.read((char *)&index->header, sizeof(IndexHeader)) ||
+      !data_ifs.read((char *)&data_header, sizeof(DataHeader)) ||
+      !is_valid_header(index->header, kIndexMagic) ||
+      !is_valid_header(data_header, kDataMagic) ||
+      index->header.generation != data_header.generation) {
+    return false;
+  }
+  index->slots.resize(index->header.capacity);
+  return !!index_ifs.read((char *)index->slots.data(),
+                          index->slots.size() * sizeof(IndexSlot));
+}
+
+void PackedKernelCache::write_index(const Index &index) const {
+  auto tmp_path = index_path() + ".tmp";
+  {
+    std::ofstream ofs(tmp_path, std::ios::out | std::ios::binary);
+    TI_ERROR_IF(!ofs.is_open(), "Failed to open {}", tmp_path);
+    ofs.write((const char *)&index.header, sizeof(IndexHeader));
+    ofs.write((const char *)index.slots.data(),
+              index.slots.size() * sizeof(IndexSlot));
+    TI_ERROR_IF(!ofs, "Failed to write {}", tmp_path);
+  }
+  replace_file(tmp_path, index_path());
+}
+
+void PackedKernelCache::reset_files(Index *index) const {
+  DataHeader data_header;
+  init_header(&data_header, kDataMagic);
+  data_header.generation = new_generation();
+  auto tmp_path = data_path() + ".tmp";
+  {
+    std::ofstream ofs(tmp_path, std::ios::out | std::ios::binary);
+    TI_ERROR_IF(!ofs.is_open(), "Failed to open {}", tmp_path);
+    ofs.write((const char *)&data_header, sizeof(DataHeader));
+  }
+  replace_file(tmp_path, data_path());
+
+  init_header(&index->header, kIndexMagic);
+  index->header.generation = data_header.generation;
+  index->header.capacity = kInitialIndexCapacity;
+  index->slots.assign(kInitialIndexCapacity, IndexSlot{});
+}
+
+bool PackedKernelCache::commit(
+    const std::vector<Entry> &entries,
+    const std::vector<std::string> &used_kernel_keys) {
+  if (entries.empty() && used_kernel_keys.empty()) {
+    return true;
+  }
+  create_directories(path_);
+  auto lock_path = join_path(path_, kLockName);
+  if (!lock_with_file(lock_path)) {
+    TI_WARN("Lock {} failed. Please run 'ti cache clean -p {}' and try again.",
+            lock_path, path_);
+    return false;
+  }
+  {
+    auto _ = make_unlocker(lock_path);
+    Index index;
+    if (!read_index(&index)) {
+      reset_files(&index);
+    }
+    // The files only change under the lock, so the mapping of the data file
+    // is up to date from here on, except for the records appended below.
+    remap();
+
+    const std::int64_t now = std::time(nullptr);
+    for (const auto &key : used_kernel_keys) {
+      if (auto *slot = index.find(data_file_, key)) {
+        slot->last_used_at = now;
+      }
+    }
+
+    std::uint64_t end = std::filesystem::file_size(data_path());
+    std::ofstream ofs(data_path(),
+                      std::ios::out | std::ios::binary | std::ios::app);
+    TI_ERROR_IF(!ofs.is_open(), "Failed to open {}", data_path());
+    for (const auto &entry : entries) {
+      if (index.find(data_file_, entry.kernel_key)) {
+        continue;
+      }
+      RecordHeader record;
+      record.magic = kRecordMagic;
+      record.key_size = entry.kernel_key.size();
+      record.data_size = entry.data.size();
+      const auto size = record_size(record.key_size, record.data_size);
+      const char padding[8] = {};
+      ofs.write((const char *)&record, sizeof(record));
+      ofs.write(entry.kernel_key.data(), entry.kernel_key.size());
+      ofs.write(entry.data.data(), entry.data.size());
+      ofs.write(padding, size - sizeof(record) - record.key_size -
+                             record.data_size);
+      index.insert({hash_key(entry.kernel_key), end, now, now});
+      index.header.live_bytes += size;
+      end += size;
+    }
+    ofs.close();
+    TI_ERROR_IF(!ofs, "Failed to write {}", data_path());
+    write_index(index);
+  }
+  remap();
+  return true;
+}
+
+void PackedKernelCache::clean(offline_cache::CleanCachePolicy policy,
+                              std::size_t max_bytes,
+                              double cleaning_factor) {
+  if (policy == offline_cache::Never || !path_exists(path_)) {
+    return;
+  }
+  auto lock_path = join_path(path_, kLockName);
+  if (!lock_with_file(lock_path)) {
+    TI_WARN("Lock {} failed. You can run 'ti cache clean -p {}' and try again.",
+            lock_path, path_);
+    return;
+  }
+  {
+    auto _ = make_unlocker(lock_path);
+    Index index;
+    if (!read_index(&index) || !remap()) {
+      // Corrupted, or written by another version of Taichi
+      if (policy & offline_cache::CleanOldVersion) {
+        data_file_.unmap();
+        index_file_.unmap();
+        taichi::remove(index_path());
+        taichi::remove(data_path());
+      }
+      return;
+    }
+    const auto num_to_remove =
+        static_cast<std::size_t>(cleaning_factor * index.header.num_kernels);
+    if (index.header.live_bytes < max_bytes || num_to_remove == 0 ||
+        !(policy &
+          (offline_cache::CleanOldUsed | offline_cache::CleanOldCreated))) {
+      return;
+    }
+
+    std::vector<IndexSlot> kept;
+    for (const auto &slot : index.slots) {
+      if (slot.offset != 0) {
+        kept.push_back(slot);
+      }
+    }
+    const bool lru = policy & offline_cache::CleanOldUsed;
+    std::sort(kept.begin(), kept.end(),
+              [lru](const IndexSlot &a, const IndexSlot &b) {
+                return lru ? a.last_used_at < b.last_used_at
+                           : a.created_at < b.created_at;
+              });
+    kept.erase(kept.begin(), kept.begin() + std::min(num_to_remove,
+                                                     kept.size()));
+
+    // Compact the data file, which also drops the records of processes that
+    // failed before indexing them. reset_files() replaces the data file, so
+    // the records are copied from the mapping of the old one.
+    Index new_index;
+    reset_files(&new_index);
+    std::uint64_t end = std::filesystem::file_size(data_path());
+    std::ofstream ofs(data_path(),
+                      std::ios::out | std::ios::binary | std::ios::app);
+    TI_ERROR_IF(!ofs.is_open(), "Failed to open {}", data_path());
+    for (const auto &slot : kept) {
+      if (slot.offset + sizeof(RecordHeader) > data_file_.size()) {
+        continue;
+      }
+      const auto *record =
+          (const RecordHeader *)(data_file_.data() + slot.offset);
+      const auto size = record_size(record->key_size, record->data_size);
+      if (record->magic != kRecordMagic ||
+          slot.offset + size > data_file_.size()) {
+        continue;
+      }
+      ofs.write((const char *)record, size);
+      new_index.insert({slot.key_hash, end, slot.created_at,
+                        slot.last_used_at});
+      new_index.header.live_bytes += size;
+      end += size;
+    }
+    ofs.close();
+    TI_ERROR_IF(!ofs, "Failed to write {}", data_path());
+    write_index(new_index);
+  }
+  remap();
+}
+
+std::size_t PackedKernelCache::size_bytes() {
+  if (!index_file_.data() && !remap()) {
+    return 0;
+  }
+  return ((const IndexHeader *)index_file_.data())->live_bytes;
+}
+
+std::size_t PackedKernelCache::num_kernels() {
+  if (!index_file_.data() && !remap()) {
+    return 0;
+  }
+  return ((const IndexHeader *)index_file_.data())->num_kernels;
+}
+
+}  // namespace taichi::lang
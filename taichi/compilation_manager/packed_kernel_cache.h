@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "taichi/util/offline_cache.h"
+
+namespace taichi::lang {
+
+// A read-only view of a whole file. Memory-mapped where supported, read into
+// a buffer otherwise.
+class MappedFile {
+ public:
+  MappedFile() = default;
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  ~MappedFile();
+
+  bool map(const std::string &path);
+  void unmap();
+
+  const char *data() const {
+    return data_;
+  }
+
+  std::size_t size() const {
+    return size_;
+  }
+
+ private:
+  const char *data_{nullptr};
+  std::size_t size_{0};
+  std::vector<char> buffer_;
+};
+
+// An offline cache of serialized kernels packed into two files:
+// * kDataFilename holds records, each made of a kernel key and the serialized
+//   CompiledKernelData. Records are only ever appended.
+// * kIndexFilename is an open-addressing hash table from kernel keys to
+//   record offsets. It is memory-mapped, so that a lookup neither parses nor
+//   reads the entries of other kernels.
+//
+// Writers of all the processes sharing the directory are serialized by a lock
+// file. Readers take no lock: a writer never modifies a file in place, but
+// writes a new index (or a new compacted data file) and renames it over the
+// old one. A record found through a possibly stale index is only trusted after
+// its key has been compared.
+class PackedKernelCache {
+ public:
+  static constexpr const char *kDataFilename =
+      offline_cache::kPackedCacheDataFilename;
+  static constexpr const char *kIndexFilename =
+      offline_cache::kPackedCacheIndexFilename;
+  static constexpr char kLockName[] = "ticache.pack.lock";
+
+  struct Entry {
+    std::string kernel_key;
+    std::string data;
+  };
+
+  explicit PackedKernelCache(std::string path);
+
+  // Finds the serialized data of |kernel_key|. |data| stays valid until the
+  // next call to a non-const method.
+  bool find(const std::string &kernel_key, std::string_view *data);
+
+  // Appends the |entries| not in the cache yet, and sets the time of last use
+  // of |used_kernel_keys| to now. Returns false if the lock can't be taken.
+  bool commit(const std::vector<Entry> &entries,
+              const std::vector<std::string> &used_kernel_keys);
+
+  // Once the live records take more than |max_bytes|, drops
+  // |cleaning_factor| of the kernels according to |policy| and compacts the
+  // data file. Also drops the cache of other Taichi versions if the |policy|
+  // says so.
+  void clean(offline_cache::CleanCachePolicy policy,
+             std::size_t max_bytes,
+             double cleaning_factor);
+
+  // The number of bytes taken by the live records
+  std::size_t size_bytes();
+
+  std::size_t num_kernels();
+
+ private:
+  struct IndexSlot;
+  struct Index;
+
+  std::string data_path() const;
+  std::string index_path() const;
+
+  // (Re)maps both files. Returns false if there is no valid cache.
+  bool remap();
+  const char *lookup(const std::string &kernel_key, std::size_t *size) const;
+
+  // These must be called while holding the lock
+  bool read_index(Index *index) const;
+  void write_index(const Index &index) const;
+  void reset_files(Index *index) const;
+
+  std::string path_;
+  MappedFile data_file_;
+  MappedFile index_file_;
+};
+
+}  // namespace taichi::lang
@@ -27,6 +27,17 @@ constexpr std::size_t taichi_result_buffer_runtime_query_id = 31;
 
 constexpr int taichi_listgen_max_element_size = 1024;
 
+// Number of offloaded range-for tasks whose chunk sizes are tracked by the
+// adaptive CPU scheduler. Beyond that, the least recently launched tasks are
+// evicted.
+constexpr int taichi_max_num_range_for_chunk_states = 1024;
+
+// Number of per-thread allocation caches of each LLVM NodeManager. CPU threads
+// with larger ids allocate through the shared free list.
+constexpr int taichi_max_num_node_allocator_caches = 256;
+// Number of recycled node indices buffered by each cache before being flushed
+constexpr int taichi_node_allocator_magazine_size = 32;
+
 // use for auto mesh_local to determine shared-mem size per block (in bytes)
 // TODO: get this at runtime
 constexpr std::size_t default_shared_mem_size = 65536;
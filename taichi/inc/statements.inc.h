@@ -40,6 +40,8 @@ PER_STATEMENT(AssertStmt)
 PER_STATEMENT(ExternalFuncCallStmt)
 PER_STATEMENT(ExternalTensorShapeAlongAxisStmt)
 PER_STATEMENT(MatrixInitStmt)
+PER_STATEMENT(VectorPackStmt)
+PER_STATEMENT(VectorExtractStmt)
 
 // Locals with reverse-mode autodiff
 PER_STATEMENT(AdStackAllocaStmt)
@@ -1,5 +1,6 @@
 #include "taichi/ir/control_flow_graph.h"
 
+#include <functional>
 #include <queue>
 #include <unordered_set>
 
@@ -9,6 +10,24 @@
 
 namespace taichi::lang {
 
+int StmtNumbering::insert(Stmt *stmt) {
+  auto [it, inserted] = ids_.emplace(stmt, (int)stmts_.size());
+  if (inserted) {
+    stmts_.push_back(stmt);
+  }
+  return it->second;
+}
+
+int StmtNumbering::find(Stmt *stmt) const {
+  auto it = ids_.find(stmt);
+  return it == ids_.end() ? -1 : it->second;
+}
+
+void StmtNumbering::clear() {
+  ids_.clear();
+  stmts_.clear();
+}
+
 CFGNode::CFGNode(Block *block,
                  int begin_location,
                  int end_location,
@@ -110,12 +129,29 @@ bool CFGNode::may_contain_variable(const std::unordered_set<Stmt *> &var_set,
   }
 }
 
+bool CFGNode::may_contain_variable(const bit::Bitset &var_set,
+                                   const StmtNumbering &numbering,
+                                   Stmt *var) {
+  if (numbering.contains(var_set, var))
+    return true;
+  if (var->is<AllocaStmt>() || var->is<AdStackAllocaStmt>())
+    return false;
+  for (int id = var_set.find_first_one(); id != -1;
+       id = var_set.lower_bound(id + 1)) {
+    if (irpass::analysis::maybe_same_address(var, numbering.get(id)))
+      return true;
+  }
+  return false;
+}
+
 bool CFGNode::reach_kill_variable(Stmt *var) const {
   // Does this node (definitely) kill a definition of var?
   return contain_variable(reach_kill, var);
 }
 
-Stmt *CFGNode::get_store_forwarding_data(Stmt *var, int position) const {
+Stmt *CFGNode::get_store_forwarding_data(Stmt *var,
+                                         int position,
+                                         const ControlFlowGraph &graph) const {
   // Return the stored data if all definitions in the UD-chain of |var| at
   // this position store the same data.
   int last_def_position = -1;
@@ -202,11 +238,28 @@ Stmt *CFGNode::get_store_forwarding_data(Stmt *var, int position) const {
     }
     return true;  // continue the following loops
   };
-  for (auto stmt : reach_in) {
+  auto visit_reaching_definition = [&](int id) {
+    auto stmt = graph.definitions.get(id);
     // var == stmt is for the case that a global ptr is never stored.
     // In this case, stmt is from nodes[start_node]->reach_gen.
     if (var == stmt || may_contain_address(stmt, var)) {
-      if (!update_result(stmt))
+      return update_result(stmt);
+    }
+    return true;
+  };
+  if (var->is<AllocaStmt>()) {
+    // Only the definitions indexed under the alloca may store to it.
+    auto it = graph.alloca_definitions.find(var);
+    if (it != graph.alloca_definitions.end()) {
+      for (auto id : it->second) {
+        if (reach_in.test(id) && !visit_reaching_definition(id))
+          return nullptr;
+      }
+    }
+  } else {
+    for (int id = reach_in.find_first_one(); id != -1;
+         id = reach_in.lower_bound(id + 1)) {
+      if (!visit_reaching_definition(id))
         return nullptr;
     }
   }
@@ -254,17 +307,18 @@ void CFGNode::reaching_definition_analysis(bool after_lower_access) {
 }
 
 bool CFGNode::store_to_load_forwarding(bool after_lower_access,
-                                       bool autodiff_enabled) {
+                                       bool autodiff_enabled,
+                                       const ControlFlowGraph &graph) {
   bool modified = false;
   for (int i = begin_location; i < end_location; i++) {
     // Store-to-load forwarding
     auto stmt = block->statements[i].get();
     Stmt *result = nullptr;
     if (auto local_load = stmt->cast<LocalLoadStmt>()) {
-      result = get_store_forwarding_data(local_load->src, i);
+      result = get_store_forwarding_data(local_load->src, i, graph);
     } else if (auto global_load = stmt->cast<GlobalLoadStmt>()) {
       if (!after_lower_access && !autodiff_enabled) {
-        result = get_store_forwarding_data(global_load->src, i);
+        result = get_store_forwarding_data(global_load->src, i, graph);
       }
     }
     if (result) {
@@ -284,7 +338,7 @@ bool CFGNode::store_to_load_forwarding(bool after_lower_access,
 
     // Identical store elimination
     if (auto local_store = stmt->cast<LocalStoreStmt>()) {
-      result = get_store_forwarding_data(local_store->dest, i);
+      result = get_store_forwarding_data(local_store->dest, i, graph);
       if (result && result->is<AllocaStmt>() && !autodiff_enabled) {
         // special case of alloca (initialized to 0)
         if (auto stored_data = local_store->val->cast<ConstStmt>()) {
@@ -304,7 +358,7 @@ bool CFGNode::store_to_load_forwarding(bool after_lower_access,
       }
     } else if (auto global_store = stmt->cast<GlobalStoreStmt>()) {
       if (!after_lower_access) {
-        result = get_store_forwarding_data(global_store->dest, i);
+        result = get_store_forwarding_data(global_store->dest, i, graph);
         if (irpass::analysis::same_value(result, global_store->val)) {
           erase(i);  // This causes end_location--
           i--;       // to cancel i++ in the for loop
@@ -316,7 +370,8 @@ bool CFGNode::store_to_load_forwarding(bool after_lower_access,
   return modified;
 }
 
-void CFGNode::gather_loaded_snodes(std::unordered_set<SNode *> &snodes) const {
+void CFGNode::gather_loaded_snodes(std::unordered_set<SNode *> &snodes,
+                                   const ControlFlowGraph &graph) const {
   // Gather the SNodes which this CFGNode loads.
   // Requires reaching definition analysis.
   std::unordered_set<Stmt *> killed_in_this_node;
@@ -331,7 +386,7 @@ void CFGNode::gather_loaded_snodes(std::unordered_set<SNode *> &snodes) const {
         if (snodes.count(snode) > 0) {
           continue;
         }
-        if (reach_in.find(global_ptr) != reach_in.end() &&
+        if (graph.definitions.contains(reach_in, global_ptr) &&
             !contain_variable(killed_in_this_node, global_ptr)) {
           // The UD-chain contains the value before this offloaded task.
           snodes.insert(snode);
@@ -383,7 +438,8 @@ void CFGNode::live_variable_analysis(bool after_lower_access) {
   }
 }
 
-bool CFGNode::dead_store_elimination(bool after_lower_access) {
+bool CFGNode::dead_store_elimination(bool after_lower_access,
+                                     const ControlFlowGraph &graph) {
   bool modified = false;
   std::unordered_set<Stmt *> live_in_this_node;
   std::unordered_set<Stmt *> killed_in_this_node;
@@ -418,7 +474,7 @@ bool CFGNode::dead_store_elimination(bool after_lower_access) {
             !stmt->is<ExternalFuncCallStmt>() &&
             !may_contain_variable(live_in_this_node, store_ptr) &&
             (contain_variable(killed_in_this_node, store_ptr) ||
-             !may_contain_variable(live_out, store_ptr))) {
+             !may_contain_variable(live_out, graph.variables, store_ptr))) {
           // Neither used in other nodes nor used in this node.
           if (!stmt->is<AtomicOpStmt>()) {
             // Eliminate the dead store.
@@ -570,29 +626,182 @@ void ControlFlowGraph::print_graph_structure() const {
       }
       node_info += fmt::format("; next={{{}}}", fmt::join(indices, ", "));
     }
-    if (!nodes[i]->reach_in.empty()) {
+    if (nodes[i]->reach_in.any()) {
       std::vector<std::string> indices;
-      for (auto stmt : nodes[i]->reach_in) {
+      definitions.for_each(nodes[i]->reach_in, [&](Stmt *stmt) {
         indices.push_back(stmt->name());
-      }
+      });
       node_info += fmt::format("; reach_in={{{}}}", fmt::join(indices, ", "));
     }
-    if (!nodes[i]->reach_out.empty()) {
+    if (nodes[i]->reach_out.any()) {
       std::vector<std::string> indices;
-      for (auto stmt : nodes[i]->reach_out) {
+      definitions.for_each(nodes[i]->reach_out, [&](Stmt *stmt) {
         indices.push_back(stmt->name());
-      }
+      });
       node_info += fmt::format("; reach_out={{{}}}", fmt::join(indices, ", "));
     }
     std::cout << node_info << std::endl;
   }
 }
 
+void ControlFlowGraph::solve_dataflow(bool forward,
+                                      const std::vector<bit::Bitset> &gen,
+                                      const std::vector<bit::Bitset> &kill,
+                                      std::vector<bit::Bitset> &in,
+                                      std::vector<bit::Bitset> &out) const {
+  const int num_nodes = size();
+  std::unordered_map<CFGNode *, int> node_ids;
+  for (int i = 0; i < num_nodes; i++) {
+    node_ids[nodes[i].get()] = i;
+  }
+  auto sources = [&](int i) -> const std::vector<CFGNode *> & {
+    return forward ? nodes[i]->prev : nodes[i]->next;
+  };
+  auto targets = [&](int i) -> const std::vector<CFGNode *> & {
+    return forward ? nodes[i]->next : nodes[i]->prev;
+  };
+
+  // Rank the nodes in reverse post-order, so that a node is mostly visited
+  // after its sources and most nodes converge after a single visit. The nodes
+  // not reachable from the entry are ranked last.
+  std::vector<int> rank(num_nodes, -1);
+  std::vector<int> post_order;
+  post_order.reserve(num_nodes);
+  {
+    std::vector<bool> visited(num_nodes, false);
+    // (node, the index of the next target to visit)
+    std::vector<std::pair<int, int>> stack;
+    const int entry = forward ? start_node : final_node;
+    stack.emplace_back(entry, 0);
+    visited[entry] = true;
+    while (!stack.empty()) {
+      auto &[now, next_target] = stack.back();
+      if (next_target < (int)targets(now).size()) {
+        int target = node_ids[targets(now)[next_target++]];
+        if (!visited[target]) {
+          visited[target] = true;
+          stack.emplace_back(target, 0);
+        }
+      } else {
+        post_order.push_back(now);
+        stack.pop_back();
+      }
+    }
+  }
+  int num_ranked = 0;
+  for (auto it = post_order.rbegin(); it != post_order.rend(); ++it) {
+    rank[*it] = num_ranked++;
+  }
+  std::vector<int> node_of_rank(post_order.rbegin(), post_order.rend());
+  for (int i = 0; i < num_nodes; i++) {
+    if (rank[i] == -1) {
+      rank[i] = num_ranked++;
+      node_of_rank.push_back(i);
+    }
+  }
+
+  const int num_bits = num_nodes == 0 ? 0 : gen[0].size();
+  in.assign(num_nodes, bit::Bitset(num_bits));
+  out = gen;
+  std::priority_queue<int, std::vector<int>, std::greater<int>> to_visit;
+  std::vector<bool> in_worklist(num_nodes, true);
+  for (int r = 0; r < num_nodes; r++) {
+    to_visit.push(r);
+  }
+
+  // The worklist algorithm.
+  bit::Bitset new_out;
+  while (!to_visit.empty()) {
+    int now = node_of_rank[to_visit.top()];
+    to_visit.pop();
+    in_worklist[now] = false;
+
+    in[now].reset();
+    for (auto source : sources(now)) {
+      in[now] |= out[node_ids[source]];
+    }
+    new_out = in[now];
+    new_out -= kill[now];
+    new_out |= gen[now];
+    if (new_out != out[now]) {
+      std::swap(out[now], new_out);
+      for (auto target : targets(now)) {
+        int target_id = node_ids[target];
+        if (!in_worklist[target_id]) {
+          to_visit.push(rank[target_id]);
+          in_worklist[target_id] = true;
+        }
+      }
+    }
+  }
+}
+
+std::vector<bit::Bitset> ControlFlowGraph::compute_kill_sets(
+    const std::vector<std::vector<Stmt *>> &element_variables,
+    std::unordered_set<Stmt *> CFGNode::*node_kill) const {
+  const int num_nodes = size();
+  const int num_elements = element_variables.size();
+  auto is_local = [](Stmt *var) {
+    return var->is<AllocaStmt>() || var->is<AdStackAllocaStmt>();
+  };
+  // Index the elements by their variables, so that a node only looks at the
+  // elements whose variables it kills.
+  std::unordered_map<Stmt *, std::vector<int>> variable_elements;
+  std::vector<Stmt *> nonlocal_variables;
+  for (int i = 0; i < num_elements; i++) {
+    for (auto var : element_variables[i]) {
+      auto &elements = variable_elements[var];
+      if (elements.empty() && !is_local(var)) {
+        nonlocal_variables.push_back(var);
+      }
+      elements.push_back(i);
+    }
+  }
+
+  std::vector<bit::Bitset> kill(num_nodes, bit::Bitset(num_elements));
+  std::vector<Stmt *> killed_variables;
+  for (int i = 0; i < num_nodes; i++) {
+    const auto &kill_set = nodes[i].get()->*node_kill;
+    if (kill_set.empty()) {
+      continue;
+    }
+    // The variables which CFGNode::contain_variable(kill_set, var) holds for.
+    killed_variables.clear();
+    bool kills_nonlocal = false;
+    for (auto var : kill_set) {
+      if (variable_elements.find(var) != variable_elements.end()) {
+        killed_variables.push_back(var);
+      }
+      kills_nonlocal |= !is_local(var);
+    }
+    // A non-local variable may also be definitely the same as another one.
+    // It is never definitely the same as a local variable.
+    if (kills_nonlocal) {
+      for (auto var : nonlocal_variables) {
+        if (kill_set.find(var) == kill_set.end() &&
+            CFGNode::contain_variable(kill_set, var)) {
+          killed_variables.push_back(var);
+        }
+      }
+    }
+    for (auto var : killed_variables) {
+      for (auto element : variable_elements[var]) {
+        const auto &vars = element_variables[element];
+        if (vars.size() == 1 ||
+            std::all_of(vars.begin(), vars.end(), [&](Stmt *v) {
+              return CFGNode::contain_variable(kill_set, v);
+            })) {
+          kill[i][element] = true;
+        }
+      }
+    }
+  }
+  return kill;
+}
+
 void ControlFlowGraph::reaching_definition_analysis(bool after_lower_access) {
   TI_AUTO_PROF;
   const int num_nodes = size();
-  std::queue<CFGNode *> to_visit;
-  std::unordered_map<CFGNode *, bool> in_queue;
   TI_ASSERT(nodes[start_node]->empty());
   nodes[start_node]->reach_gen.clear();
   nodes[start_node]->reach_kill.clear();
@@ -616,53 +825,49 @@ void ControlFlowGraph::reaching_definition_analysis(bool after_lower_access) {
     if (i != start_node) {
       nodes[i]->reaching_definition_analysis(after_lower_access);
     }
-    nodes[i]->reach_in.clear();
-    nodes[i]->reach_out = nodes[i]->reach_gen;
-    to_visit.push(nodes[i].get());
-    in_queue[nodes[i].get()] = true;
   }
 
-  // The worklist algorithm.
-  while (!to_visit.empty()) {
-    auto now = to_visit.front();
-    to_visit.pop();
-    in_queue[now] = false;
-
-    now->reach_in.clear();
-    for (auto prev_node : now->prev) {
-      now->reach_in.insert(prev_node->reach_out.begin(),
-                           prev_node->reach_out.end());
-    }
-    auto old_out = std::move(now->reach_out);
-    now->reach_out = now->reach_gen;
-    for (auto stmt : now->reach_in) {
-      auto store_ptrs = irpass::analysis::get_store_destination(stmt);
-      bool killed;
-      if (store_ptrs.empty()) {  // the case of a global pointer
-        killed = now->reach_kill_variable(stmt);
-      } else {
-        killed = true;
-        for (auto store_ptr : store_ptrs) {
-          if (!now->reach_kill_variable(store_ptr)) {
-            killed = false;
-            break;
-          }
-        }
-      }
-      if (!killed) {
-        now->reach_out.insert(stmt);
-      }
+  definitions.clear();
+  alloca_definitions.clear();
+  for (auto &node : nodes) {
+    for (auto stmt : node->reach_gen) {
+      definitions.insert(stmt);
     }
-    if (now->reach_out != old_out) {
-      // changed
-      for (auto next_node : now->next) {
-        if (!in_queue[next_node]) {
-          to_visit.push(next_node);
-          in_queue[next_node] = true;
-        }
+  }
+  const int num_definitions = definitions.size();
+  // The variables a definition stores to. A global pointer from the start
+  // node is a definition of itself.
+  std::vector<std::vector<Stmt *>> definition_variables(num_definitions);
+  for (int i = 0; i < num_definitions; i++) {
+    auto stmt = definitions.get(i);
+    auto store_ptrs = irpass::analysis::get_store_destination(stmt);
+    definition_variables[i].assign(store_ptrs.begin(), store_ptrs.end());
+    if (definition_variables[i].empty()) {
+      definition_variables[i].push_back(stmt);
+    }
+    for (auto var : definition_variables[i]) {
+      if (var->is<AllocaStmt>()) {
+        alloca_definitions[var].push_back(i);
+      } else if (auto ptr = var->cast<MatrixPtrStmt>();
+                 ptr && ptr->origin->is<AllocaStmt>()) {
+        alloca_definitions[ptr->origin].push_back(i);
       }
     }
   }
+
+  std::vector<bit::Bitset> gen(num_nodes, bit::Bitset(num_definitions));
+  for (int i = 0; i < num_nodes; i++) {
+    for (auto stmt : nodes[i]->reach_gen) {
+      gen[i][definitions.find(stmt)] = true;
+    }
+  }
+  auto kill = compute_kill_sets(definition_variables, &CFGNode::reach_kill);
+  std::vector<bit::Bitset> in, out;
+  solve_dataflow(/*forward=*/true, gen, kill, in, out);
+  for (int i = 0; i < num_nodes; i++) {
+    nodes[i]->reach_in = std::move(in[i]);
+    nodes[i]->reach_out = std::move(out[i]);
+  }
 }
 
 void ControlFlowGraph::live_variable_analysis(
@@ -670,8 +875,6 @@ void ControlFlowGraph::live_variable_analysis(
     const std::optional<LiveVarAnalysisConfig> &config_opt) {
   TI_AUTO_PROF;
   const int num_nodes = size();
-  std::queue<CFGNode *> to_visit;
-  std::unordered_map<CFGNode *, bool> in_queue;
   TI_ASSERT(nodes[final_node]->empty());
   nodes[final_node]->live_gen.clear();
   nodes[final_node]->live_kill.clear();
@@ -704,45 +907,38 @@ void ControlFlowGraph::live_variable_analysis(
       }
     }
   }
-  for (int i = num_nodes - 1; i >= 0; i--) {
-    // push into the queue in reversed order to make it slightly faster
+  for (int i = 0; i < num_nodes; i++) {
     if (i != final_node) {
       nodes[i]->live_variable_analysis(after_lower_access);
     }
-    nodes[i]->live_out.clear();
-    nodes[i]->live_in = nodes[i]->live_gen;
-    to_visit.push(nodes[i].get());
-    in_queue[nodes[i].get()] = true;
   }
 
-  // The worklist algorithm.
-  while (!to_visit.empty()) {
-    auto now = to_visit.front();
-    to_visit.pop();
-    in_queue[now] = false;
-
-    now->live_out.clear();
-    for (auto next_node : now->next) {
-      now->live_out.insert(next_node->live_in.begin(),
-                           next_node->live_in.end());
-    }
-    auto old_in = std::move(now->live_in);
-    now->live_in = now->live_gen;
-    for (auto stmt : now->live_out) {
-      if (!CFGNode::contain_variable(now->live_kill, stmt)) {
-        now->live_in.insert(stmt);
-      }
+  variables.clear();
+  for (auto &node : nodes) {
+    for (auto stmt : node->live_gen) {
+      variables.insert(stmt);
     }
-    if (now->live_in != old_in) {
-      // changed
-      for (auto prev_node : now->prev) {
-        if (!in_queue[prev_node]) {
-          to_visit.push(prev_node);
-          in_queue[prev_node] = true;
-        }
-      }
+  }
+  const int num_variables = variables.size();
+  std::vector<std::vector<Stmt *>> variable_variables(num_variables);
+  for (int i = 0; i < num_variables; i++) {
+    variable_variables[i].push_back(variables.get(i));
+  }
+
+  std::vector<bit::Bitset> gen(num_nodes, bit::Bitset(num_variables));
+  for (int i = 0; i < num_nodes; i++) {
+    for (auto stmt : nodes[i]->live_gen) {
+      gen[i][variables.find(stmt)] = true;
     }
   }
+  auto kill = compute_kill_sets(variable_variables, &CFGNode::live_kill);
+  std::vector<bit::Bitset> in, out;
+  solve_dataflow(/*forward=*/false, gen, kill, in, out);
+  for (int i = 0; i < num_nodes; i++) {
+    // The dataflow runs backward, so its "out" is the live-in of a node.
+    nodes[i]->live_out = std::move(in[i]);
+    nodes[i]->live_in = std::move(out[i]);
+  }
 }
 
 void ControlFlowGraph::simplify_graph() {
@@ -818,7 +1014,7 @@ bool ControlFlowGraph::store_to_load_forwarding(bool after_lower_access,
   bool modified = false;
   for (int i = 0; i < num_nodes; i++) {
     if (nodes[i]->store_to_load_forwarding(after_lower_access,
-                                           autodiff_enabled))
+                                           autodiff_enabled, *this))
       modified = true;
   }
   return modified;
@@ -832,7 +1028,7 @@ bool ControlFlowGraph::dead_store_elimination(
   const int num_nodes = size();
   bool modified = false;
   for (int i = 0; i < num_nodes; i++) {
-    if (nodes[i]->dead_store_elimination(after_lower_access))
+    if (nodes[i]->dead_store_elimination(after_lower_access, *this))
       modified = true;
   }
   return modified;
@@ -852,15 +1048,15 @@ std::unordered_set<SNode *> ControlFlowGraph::gather_loaded_snodes() {
   // output_value_state = merge(input_value_state, written_part)
   //
   // Therefore we include the nodes[final_node]->reach_in in snodes.
-  for (auto &stmt : nodes[final_node]->reach_in) {
+  definitions.for_each(nodes[final_node]->reach_in, [&](Stmt *stmt) {
     if (auto global_ptr = stmt->cast<GlobalPtrStmt>()) {
       snodes.insert(global_ptr->snode);
     }
-  }
+  });
 
   for (int i = 0; i < num_nodes; i++) {
     if (i != final_node) {
-      nodes[i]->gather_loaded_snodes(snodes);
+      nodes[i]->gather_loaded_snodes(snodes, *this);
     }
   }
   return snodes;
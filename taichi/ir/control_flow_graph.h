@@ -4,9 +4,50 @@
 #include <unordered_set>
 
 #include "taichi/ir/ir.h"
+#include "taichi/util/bit.h"
 
 namespace taichi::lang {
 
+class ControlFlowGraph;
+
+/**
+ * Numbers the statements a dataflow analysis is about, so that sets of them
+ * can be stored as dense bitsets.
+ */
+class StmtNumbering {
+ public:
+  // Returns the number of |stmt|, numbering it if it isn't yet.
+  int insert(Stmt *stmt);
+  // Returns -1 if |stmt| isn't numbered.
+  int find(Stmt *stmt) const;
+  void clear();
+
+  Stmt *get(int id) const {
+    return stmts_[id];
+  }
+
+  int size() const {
+    return (int)stmts_.size();
+  }
+
+  bool contains(const bit::Bitset &set, Stmt *stmt) const {
+    auto id = find(stmt);
+    return id != -1 && set.test(id);
+  }
+
+  template <typename Func>
+  void for_each(const bit::Bitset &set, const Func &func) const {
+    for (int id = set.find_first_one(); id != -1;
+         id = set.lower_bound(id + 1)) {
+      func(stmts_[id]);
+    }
+  }
+
+ private:
+  std::unordered_map<Stmt *, int> ids_;
+  std::vector<Stmt *> stmts_;
+};
+
 /**
  * A basic block in control-flow graph.
  * A CFGNode contains a reference to a part of the CHI IR, or more precisely,
@@ -37,11 +78,17 @@ class CFGNode {
 
   // Reaching definition analysis
   // https://en.wikipedia.org/wiki/Reaching_definition
-  std::unordered_set<Stmt *> reach_gen, reach_kill, reach_in, reach_out;
+  // |reach_kill| holds the variables this node defines, the other sets hold
+  // definitions. |reach_in| and |reach_out| are numbered by
+  // ControlFlowGraph::definitions.
+  std::unordered_set<Stmt *> reach_gen, reach_kill;
+  bit::Bitset reach_in, reach_out;
 
   // Live variable analysis
   // https://en.wikipedia.org/wiki/Live_variable_analysis
-  std::unordered_set<Stmt *> live_gen, live_kill, live_in, live_out;
+  // |live_in| and |live_out| are numbered by ControlFlowGraph::variables.
+  std::unordered_set<Stmt *> live_gen, live_kill;
+  bit::Bitset live_in, live_out;
 
   CFGNode(Block *block,
           int begin_location,
@@ -70,15 +117,24 @@ class CFGNode {
                                Stmt *var);
   static bool may_contain_variable(const std::unordered_set<Stmt *> &var_set,
                                    Stmt *var);
+  static bool may_contain_variable(const bit::Bitset &var_set,
+                                   const StmtNumbering &numbering,
+                                   Stmt *var);
   bool reach_kill_variable(Stmt *var) const;
-  Stmt *get_store_forwarding_data(Stmt *var, int position) const;
+  Stmt *get_store_forwarding_data(Stmt *var,
+                                  int position,
+                                  const ControlFlowGraph &graph) const;
 
   // Analyses and optimizations inside a CFGNode.
   void reaching_definition_analysis(bool after_lower_access);
-  bool store_to_load_forwarding(bool after_lower_access, bool autodiff_enabled);
-  void gather_loaded_snodes(std::unordered_set<SNode *> &snodes) const;
+  bool store_to_load_forwarding(bool after_lower_access,
+                                bool autodiff_enabled,
+                                const ControlFlowGraph &graph);
+  void gather_loaded_snodes(std::unordered_set<SNode *> &snodes,
+                            const ControlFlowGraph &graph) const;
   void live_variable_analysis(bool after_lower_access);
-  bool dead_store_elimination(bool after_lower_access);
+  bool dead_store_elimination(bool after_lower_access,
+                              const ControlFlowGraph &graph);
 };
 
 class ControlFlowGraph {
@@ -86,6 +142,29 @@ class ControlFlowGraph {
   // Erase an empty node.
   void erase(int node_id);
 
+  /**
+   * Solve a bitset dataflow problem using the worklist algorithm. The nodes
+   * are visited in reverse post-order from the start node, or from the final
+   * node on the reversed graph if |forward| is false. For each node,
+   *   in = the union of |out| of the predecessors (successors if backward),
+   *   out = gen | (in - kill).
+   * All the vectors are indexed by node.
+   */
+  void solve_dataflow(bool forward,
+                      const std::vector<bit::Bitset> &gen,
+                      const std::vector<bit::Bitset> &kill,
+                      std::vector<bit::Bitset> &in,
+                      std::vector<bit::Bitset> &out) const;
+
+  /**
+   * For each node, compute the set of the elements whose variables
+   * |node_kill| definitely contains. |element_variables[i]| holds the
+   * variables of element i, which is killed only if they all are.
+   */
+  std::vector<bit::Bitset> compute_kill_sets(
+      const std::vector<std::vector<Stmt *>> &element_variables,
+      std::unordered_set<Stmt *> CFGNode::*node_kill) const;
+
  public:
   struct LiveVarAnalysisConfig {
     // This is mostly useful for SFG task-level dead store elimination. SFG may
@@ -97,6 +176,14 @@ class ControlFlowGraph {
   const int start_node = 0;
   int final_node{0};
 
+  // The definitions of the last reaching definition analysis, and for each
+  // alloca, the numbers of the definitions which may store to it.
+  StmtNumbering definitions;
+  std::unordered_map<Stmt *, std::vector<int>> alloca_definitions;
+
+  // The variables of the last live variable analysis
+  StmtNumbering variables;
+
   template <typename... Args>
   CFGNode *push_back(Args &&...args) {
     nodes.emplace_back(std::make_unique<CFGNode>(std::forward<Args>(args)...));
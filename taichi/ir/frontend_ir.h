@@ -1082,6 +1082,7 @@ class FrontendContext {
  public:
   explicit FrontendContext(Arch arch) {
     root_node_ = std::make_unique<Block>();
+    root_node_->arena = IRArena::create();
     current_builder_ = std::make_unique<ASTBuilder>(root_node_.get(), arch);
   }
 
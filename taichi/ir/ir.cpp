@@ -403,6 +403,11 @@ std::unique_ptr<Block> Block::clone() const {
   return new_block;
 }
 
+IRArena *get_ir_arena(IRNode *root) {
+  auto block = dynamic_cast<Block *>(root);
+  return block ? block->arena.get() : nullptr;
+}
+
 DelayedIRModifier::~DelayedIRModifier() {
   // TODO: destructors should not be interrupted
   TI_ASSERT(to_insert_before_.empty());
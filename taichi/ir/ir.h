@@ -11,6 +11,7 @@
 #include "taichi/common/core.h"
 #include "taichi/common/exceptions.h"
 #include "taichi/common/one_or_more.h"
+#include "taichi/ir/ir_arena.h"
 #include "taichi/ir/snode.h"
 #include "taichi/ir/mesh.h"
 #include "taichi/ir/type_factory.h"
@@ -106,9 +107,12 @@ class Identifier {
 #ifdef TI_WITH_LLVM
 using stmt_vector = llvm::SmallVector<pStmt, 8>;
 using stmt_ref_vector = llvm::SmallVector<Stmt *, 2>;
+// Most statements have at most 4 operands
+using stmt_operand_vector = llvm::SmallVector<Stmt **, 4>;
 #else
 using stmt_vector = std::vector<pStmt>;
 using stmt_ref_vector = std::vector<Stmt *>;
+using stmt_operand_vector = std::vector<Stmt **>;
 #endif
 
 class VecStatement {
@@ -388,7 +392,7 @@ class StmtFieldManager {
 
 class Stmt : public IRNode {
  protected:
-  std::vector<Stmt **> operands;
+  stmt_operand_vector operands;
 
  public:
   StmtFieldManager field_manager;
@@ -472,6 +476,15 @@ class Stmt : public IRNode {
     return !has_global_side_effect();
   }
 
+  // Statements are allocated from the current IRArena, if any.
+  static void *operator new(std::size_t size) {
+    return IRArena::allocate(size);
+  }
+
+  static void operator delete(void *ptr) {
+    IRArena::deallocate(ptr);
+  }
+
   template <typename T, typename... Args>
   static std::unique_ptr<T> make_typed(Args &&...args) {
     return std::make_unique<T>(std::forward<Args>(args)...);
@@ -510,6 +523,10 @@ class Block : public IRNode {
   // variables, and AllocaStmt for other variables.
   std::map<Identifier, Stmt *> local_var_to_stmt;
 
+  // Only set on root blocks. The statements of the root are allocated from
+  // this arena when it is made current, see get_ir_arena().
+  IRArenaPtr arena;
+
   Block() {
     parent_stmt = nullptr;
   }
@@ -573,6 +590,10 @@ class Block : public IRNode {
   TI_DEFINE_ACCEPT
 };
 
+// Returns the arena of |root| if it is a root block owning one, nullptr
+// otherwise.
+IRArena *get_ir_arena(IRNode *root);
+
 class DelayedIRModifier {
  private:
   std::vector<std::pair<Stmt *, VecStatement>> to_insert_before_;
@@ -0,0 +1,134 @@
+#include "taichi/ir/ir_arena.h"
+
+#include <algorithm>
+#include <new>
+
+namespace taichi::lang {
+
+namespace {
+
+// Precedes every statement, so that it can be freed without knowing where it
+// was allocated from.
+struct alignas(alignof(std::max_align_t)) AllocationHeader {
+  IRArena *arena;
+  // Including the header
+  std::size_t size;
+};
+
+constexpr std::size_t kAlignment = alignof(std::max_align_t);
+
+thread_local IRArena *current_arena = nullptr;
+
+std::atomic<std::size_t> num_allocations{0};
+std::atomic<std::size_t> num_reused{0};
+std::atomic<std::size_t> num_heap_allocations{0};
+
+std::size_t align_up(std::size_t size) {
+  return (size + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+}  // namespace
+
+void IRArenaDeleter::operator()(IRArena *arena) const {
+  arena->release();
+}
+
+IRArenaPtr IRArena::create() {
+  return IRArenaPtr(new IRArena());
+}
+
+IRArena *IRArena::current() {
+  return current_arena;
+}
+
+IRArena::Scope::Scope(IRArena *arena) : prev_(current_arena) {
+  current_arena = arena;
+}
+
+IRArena::Scope::~Scope() {
+  current_arena = prev_;
+}
+
+void *IRArena::allocate(std::size_t size) {
+  auto total_size = sizeof(AllocationHeader) + align_up(size);
+  auto arena = current_arena;
+  void *memory;
+  if (arena) {
+    memory = arena->allocate_here(total_size);
+  } else {
+    memory = ::operator new(total_size);
+    num_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+  }
+  num_allocations.fetch_add(1, std::memory_order_relaxed);
+  auto header = new (memory) AllocationHeader{arena, total_size};
+  return header + 1;
+}
+
+void IRArena::deallocate(void *ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+  auto header = static_cast<AllocationHeader *>(ptr) - 1;
+  auto arena = header->arena;
+  if (arena == nullptr) {
+    ::operator delete(header);
+    return;
+  }
+  // Only the thread allocating from the arena may touch its free lists
+  if (arena == current_arena) {
+    arena->recycle(header, header->size);
+  }
+  arena->release();
+}
+
+IRArena::Stats IRArena::get_stats() {
+  Stats stats;
+  stats.num_allocations = num_allocations.load(std::memory_order_relaxed);
+  stats.num_reused = num_reused.load(std::memory_order_relaxed);
+  stats.num_heap_allocations =
+      num_heap_allocations.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void *IRArena::allocate_here(std::size_t size) {
+  ref_count_.fetch_add(1, std::memory_order_relaxed);
+  if (size <= kMaxRecycledSize) {
+    auto &free_list = free_lists_[size / kSizeClassGranularity];
+    if (free_list != nullptr) {
+      auto result = free_list;
+      free_list = *static_cast<void **>(result);
+      num_reused.fetch_add(1, std::memory_order_relaxed);
+      return result;
+    }
+  }
+  if (head_ == nullptr || size > std::size_t(end_ - head_)) {
+    // Statements larger than a chunk get a chunk of their own
+    auto chunk_size = std::max(next_chunk_size_, size);
+    chunks_.emplace_back(new char[chunk_size]);
+    num_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    head_ = chunks_.back().get();
+    end_ = head_ + chunk_size;
+    next_chunk_size_ = std::min(next_chunk_size_ * 2, kMaxChunkSize);
+  }
+  auto result = head_;
+  head_ += size;
+  allocated_bytes_ += size;
+  return result;
+}
+
+void IRArena::recycle(void *memory, std::size_t size) {
+  if (size > kMaxRecycledSize) {
+    return;
+  }
+  auto &free_list = free_lists_[size / kSizeClassGranularity];
+  *static_cast<void **>(memory) = free_list;
+  free_list = memory;
+}
+
+void IRArena::release() {
+  if (ref_count_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    delete this;
+  }
+}
+
+}  // namespace taichi::lang
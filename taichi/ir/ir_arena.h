@@ -0,0 +1,105 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace taichi::lang {
+
+class IRArena;
+
+struct IRArenaDeleter {
+  void operator()(IRArena *arena) const;
+};
+
+using IRArenaPtr = std::unique_ptr<IRArena, IRArenaDeleter>;
+
+/**
+ * A bump allocator for IR statements.
+ *
+ * Statements are allocated from the arena made current on this thread by
+ * IRArena::Scope, and from the heap if there is none. The memory of the arena
+ * is freed at once when its creator and all its statements are gone. So a
+ * statement may safely outlive the IR tree it was built in, e.g. when it is
+ * moved into another tree.
+ *
+ * A statement freed while its arena is current goes onto a free list of its
+ * size class and is reused by the next statement of that size, so passes
+ * which keep replacing statements don't grow the arena. Statements larger
+ * than kMaxRecycledSize, or freed on another thread, stay in the arena until
+ * it is freed; the memory of an arena is thus bounded by the peak size of its
+ * IR plus the statements freed outside of its scopes.
+ *
+ * An arena is only allocated from by the thread which made it current.
+ */
+class IRArena {
+ public:
+  static IRArenaPtr create();
+
+  IRArena(const IRArena &) = delete;
+  IRArena &operator=(const IRArena &) = delete;
+
+  static void *allocate(std::size_t size);
+  static void deallocate(void *ptr);
+
+  static IRArena *current();
+
+  class Scope {
+   public:
+    // A null |arena| makes the statements allocated from the heap.
+    explicit Scope(IRArena *arena);
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+    ~Scope();
+
+   private:
+    IRArena *prev_;
+  };
+
+  // The number of bytes carved from the chunks of the arena so far
+  std::size_t allocated_bytes() const {
+    return allocated_bytes_;
+  }
+
+  // Process-wide allocation counters, e.g. for the compile time benchmark
+  struct Stats {
+    // Statements allocated, from arenas or from the heap
+    std::size_t num_allocations{0};
+    // Statements which reused the memory of a freed statement
+    std::size_t num_reused{0};
+    // Calls to the heap allocator, for statements or for arena chunks
+    std::size_t num_heap_allocations{0};
+  };
+  static Stats get_stats();
+
+ private:
+  friend struct IRArenaDeleter;
+
+  IRArena() = default;
+  ~IRArena() = default;
+
+  void *allocate_here(std::size_t size);
+  void recycle(void *memory, std::size_t size);
+  void release();
+
+  static constexpr std::size_t kInitialChunkSize = 16 << 10;
+  static constexpr std::size_t kMaxChunkSize = 1 << 20;
+  static constexpr std::size_t kSizeClassGranularity =
+      alignof(std::max_align_t);
+  static constexpr std::size_t kMaxRecycledSize = 1 << 10;
+
+  // The creator and every live allocation hold a reference
+  std::atomic<std::size_t> ref_count_{1};
+  std::vector<std::unique_ptr<char[]>> chunks_;
+  char *head_{nullptr};
+  char *end_{nullptr};
+  std::size_t next_chunk_size_{kInitialChunkSize};
+  std::size_t allocated_bytes_{0};
+  // Freed allocations of each size, linked through their first word
+  std::array<void *, kMaxRecycledSize / kSizeClassGranularity + 1>
+      free_lists_{};
+};
+
+}  // namespace taichi::lang
@@ -1,7 +1,85 @@
 #include "taichi/ir/pass.h"
 
+#include "taichi/system/timer.h"
+
 namespace taichi::lang {
 
 const PassID Pass::id = "undefined";
 
+void AnalysisManager::invalidate(const PreservedAnalyses &preserved) {
+  for (auto it = result_.begin(); it != result_.end();) {
+    if (preserved.preserves(it->first)) {
+      ++it;
+    } else {
+      it = result_.erase(it);
+    }
+  }
+}
+
+void PassManager::add_pass(const PassID &name,
+                           PassFunc func,
+                           PreservedAnalyses preserved,
+                           bool run_once) {
+  PassEntry entry;
+  entry.name = name;
+  entry.func = std::move(func);
+  entry.preserved = std::move(preserved);
+  entry.run_once = run_once;
+  passes_.push_back(std::move(entry));
+}
+
+bool PassManager::run_until_fixpoint(IRNode *root) {
+  int num_modifications = 0;
+  while (true) {
+    num_iterations_++;
+    bool modified = false;
+    for (auto &pass : passes_) {
+      if ((pass.run_once && pass.num_runs > 0) ||
+          pass.clean_at == num_modifications) {
+        pass.num_skips++;
+        continue;
+      }
+      auto start_time = Time::get_time();
+      bool pass_modified = pass.func(root, amgr_);
+      pass.seconds += Time::get_time() - start_time;
+      pass.num_runs++;
+      if (pass_modified) {
+        num_modifications++;
+        modified = true;
+        amgr_->invalidate(pass.preserved);
+        pass.clean_at = -1;
+      } else {
+        pass.clean_at = num_modifications;
+      }
+    }
+    if (!modified) {
+      break;
+    }
+  }
+  return num_modifications > 0;
+}
+
+std::string PassManager::timing_summary() const {
+  // Passes added more than once are summed up
+  std::vector<const PassEntry *> totals;
+  std::unordered_map<PassID, PassEntry> by_name;
+  for (auto &pass : passes_) {
+    auto [it, inserted] = by_name.try_emplace(pass.name, pass);
+    if (inserted) {
+      totals.push_back(&it->second);
+    } else {
+      it->second.num_runs += pass.num_runs;
+      it->second.num_skips += pass.num_skips;
+      it->second.seconds += pass.seconds;
+    }
+  }
+  std::string result = fmt::format("{} iterations", num_iterations_);
+  for (auto pass : totals) {
+    result += fmt::format(", {} {:.2f} ms ({} runs, {} skipped)", pass->name,
+                          pass->seconds * 1000, pass->num_runs,
+                          pass->num_skips);
+  }
+  return result;
+}
+
 }  // namespace taichi::lang
@@ -3,7 +3,9 @@
 #include "taichi/ir/ir.h"
 #include "taichi/program/compile_config.h"
 
+#include <functional>
 #include <unordered_map>
+#include <unordered_set>
 #include <typeindex>
 #include <utility>
 
@@ -62,12 +64,46 @@ class Pass {
   virtual ~Pass() = default;
 };
 
+// The analyses whose results are still valid after a pass modified the IR.
+class PreservedAnalyses {
+ public:
+  static PreservedAnalyses all() {
+    PreservedAnalyses result;
+    result.all_ = true;
+    return result;
+  }
+
+  static PreservedAnalyses none() {
+    return PreservedAnalyses();
+  }
+
+  template <typename PassT>
+  PreservedAnalyses &preserve() {
+    ids_.insert(PassT::id);
+    return *this;
+  }
+
+  bool preserves(const PassID &id) const {
+    return all_ || ids_.count(id) > 0;
+  }
+
+ private:
+  bool all_{false};
+  std::unordered_set<PassID> ids_;
+};
+
+// Caches the results of analyses, each for the IR node it was run on, until
+// they are invalidated by a pass modifying the IR.
 class AnalysisManager {
  public:
   template <typename PassT>
-  typename PassT::Result *get_pass_result() {
-    auto result = result_.find(PassT::id);
-    if (result == result_.end()) {
+  typename PassT::Result *get_pass_result(const IRNode *root = nullptr) {
+    auto results = result_.find(PassT::id);
+    if (results == result_.end()) {
+      return nullptr;
+    }
+    auto result = results->second.find(root);
+    if (result == results->second.end()) {
       return nullptr;
     }
     using ResultModelT = AnalysisResultModel<typename PassT::Result>;
@@ -75,13 +111,73 @@ class AnalysisManager {
   }
 
   template <typename PassT>
-  void put_pass_result(typename PassT::Result &&result) {
+  void put_pass_result(typename PassT::Result &&result,
+                       const IRNode *root = nullptr) {
     using ResultModelT = AnalysisResultModel<typename PassT::Result>;
-    result_[PassT::id] = std::make_unique<ResultModelT>(std::move(result));
+    result_[PassT::id][root] =
+        std::make_unique<ResultModelT>(std::move(result));
+  }
+
+  // Runs the analysis PassT on |root| unless its result is cached.
+  template <typename PassT>
+  typename PassT::Result *get_or_run(IRNode *root) {
+    if (auto result = get_pass_result<PassT>(root)) {
+      return result;
+    }
+    put_pass_result<PassT>(PassT::run(root), root);
+    return get_pass_result<PassT>(root);
+  }
+
+  void invalidate(const PreservedAnalyses &preserved);
+
+ private:
+  std::unordered_map<
+      PassID,
+      std::unordered_map<const IRNode *,
+                         std::unique_ptr<AnalysisResultConcept>>>
+      result_;
+};
+
+// Runs a sequence of transform passes until none of them modifies the IR.
+class PassManager {
+ public:
+  // Returns whether the IR is modified.
+  using PassFunc = std::function<bool(IRNode *root, AnalysisManager *amgr)>;
+
+  explicit PassManager(AnalysisManager *amgr) : amgr_(amgr) {
   }
 
+  // |preserved| are the analyses still valid after |func| modified the IR. A
+  // pass which does not modify the IR preserves all of them.
+  void add_pass(const PassID &name,
+                PassFunc func,
+                PreservedAnalyses preserved = PreservedAnalyses::none(),
+                bool run_once = false);
+
+  // A pass is skipped when the IR is not modified since it last ran without
+  // modifying it. Returns whether the IR is modified.
+  bool run_until_fixpoint(IRNode *root);
+
+  // The number of runs and the time of each pass, e.g. for logging.
+  std::string timing_summary() const;
+
  private:
-  std::unordered_map<PassID, std::unique_ptr<AnalysisResultConcept>> result_;
+  struct PassEntry {
+    PassID name;
+    PassFunc func;
+    PreservedAnalyses preserved;
+    bool run_once;
+    // The number of modifications of the IR when the pass last ran without
+    // modifying it, or -1
+    int clean_at{-1};
+    int num_runs{0};
+    int num_skips{0};
+    double seconds{0};
+  };
+
+  AnalysisManager *amgr_;
+  std::vector<PassEntry> passes_;
+  int num_iterations_{0};
 };
 
 }  // namespace taichi::lang
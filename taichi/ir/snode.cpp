@@ -183,6 +183,16 @@ void SNode::write_float(const std::vector<int> &i, float64 val) {
   snode_rw_accessors_bank_->get(this).write_float(i, val);
 }
 
+void SNode::read_batch(intptr_t indices, intptr_t values, int n) {
+  snode_rw_accessors_bank_->get(this).read_batch((const int32 *)indices,
+                                                 (void *)values, n);
+}
+
+void SNode::write_batch(intptr_t indices, intptr_t values, int n) {
+  snode_rw_accessors_bank_->get(this).write_batch((const int32 *)indices,
+                                                  (const void *)values, n);
+}
+
 Expr SNode::get_expr() const {
   return Expr(snode_to_fields_->at(this));
 }
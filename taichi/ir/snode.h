@@ -318,6 +318,12 @@ class SNode {
   void write_uint(const std::vector<int> &i, uint64 val);
   void write_float(const std::vector<int> &i, float64 val);
 
+  // Reads/writes the elements at |n| indices at once. |indices| points to a
+  // row-major n x num_active_indices int32 array, and |values| to n elements
+  // of this SNode's data type.
+  void read_batch(intptr_t indices, intptr_t values, int n);
+  void write_batch(intptr_t indices, intptr_t values, int n);
+
   Expr get_expr() const;
 
   uint64 fetch_reader_result();  // TODO: refactor
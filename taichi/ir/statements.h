@@ -1990,4 +1990,45 @@ class MatrixInitStmt : public Stmt {
   TI_DEFINE_ACCEPT_AND_CLONE
 };
 
+/**
+ * Packs scalars into the lanes of a SIMD vector. Created by
+ * irpass::slp_vectorize. Unlike MatrixInitStmt, its value is always a vector
+ * in codegen, whether matrices are scalarized or not.
+ */
+class VectorPackStmt : public Stmt {
+ public:
+  std::vector<Stmt *> values;
+
+  explicit VectorPackStmt(const std::vector<Stmt *> &values) : values(values) {
+    TI_STMT_REG_FIELDS;
+  }
+
+  bool has_global_side_effect() const override {
+    return false;
+  }
+
+  TI_STMT_DEF_FIELDS(ret_type, values);
+  TI_DEFINE_ACCEPT_AND_CLONE
+};
+
+/**
+ * Reads a lane of a SIMD vector produced by irpass::slp_vectorize.
+ */
+class VectorExtractStmt : public Stmt {
+ public:
+  Stmt *vector;
+  int lane;
+
+  VectorExtractStmt(Stmt *vector, int lane) : vector(vector), lane(lane) {
+    TI_STMT_REG_FIELDS;
+  }
+
+  bool has_global_side_effect() const override {
+    return false;
+  }
+
+  TI_STMT_DEF_FIELDS(ret_type, vector, lane);
+  TI_DEFINE_ACCEPT_AND_CLONE
+};
+
 }  // namespace taichi::lang
@@ -50,7 +50,8 @@ bool extract_constant(IRNode *root, const CompileConfig &config);
 bool unreachable_code_elimination(IRNode *root);
 bool loop_invariant_code_motion(IRNode *root, const CompileConfig &config);
 bool cache_loop_invariant_global_vars(IRNode *root,
-                                      const CompileConfig &config);
+                                      const CompileConfig &config,
+                                      AnalysisManager *amgr = nullptr);
 void full_simplify(IRNode *root,
                    const CompileConfig &config,
                    const FullSimplifyPass::Args &args);
@@ -62,7 +63,7 @@ bool inlining(IRNode *root,
               const CompileConfig &config,
               const InliningPass::Args &args);
 void bit_loop_vectorize(IRNode *root);
-void slp_vectorize(IRNode *root);
+void slp_vectorize(IRNode *root, const CompileConfig &config);
 void replace_all_usages_with(IRNode *root, Stmt *old_stmt, Stmt *new_stmt);
 bool check_out_of_bound(IRNode *root,
                         const CompileConfig &config,
@@ -134,7 +135,9 @@ bool replace_statements(IRNode *root,
                         std::function<Stmt *(Stmt *)> finder);
 void demote_dense_struct_fors(IRNode *root);
 void demote_no_access_mesh_fors(IRNode *root);
-bool demote_atomics(IRNode *root, const CompileConfig &config);
+bool demote_atomics(IRNode *root,
+                    const CompileConfig &config,
+                    AnalysisManager *amgr = nullptr);
 void reverse_segments(IRNode *root);  // for autograd
 void detect_read_only(IRNode *root);
 void optimize_bit_struct_stores(IRNode *root,
@@ -27,6 +27,18 @@ class JITSession {
   virtual JITModule *add_module(std::unique_ptr<llvm::Module> M,
                                 int max_reg = 0) = 0;
 
+  // Adds relocatable object code for the target, e.g. the output of
+  // KernelCodeGen::emit_object_code().
+  virtual JITModule *add_object(const std::string &object_code) {
+    TI_NOT_IMPLEMENTED
+  }
+
+  // Adds a module whose exported symbols resolve the undefined symbols of the
+  // modules added afterwards.
+  virtual void add_shared_module(std::unique_ptr<llvm::Module> M) {
+    TI_NOT_IMPLEMENTED
+  }
+
   // virtual void remove_module(JITModule *module) = 0;
 
   virtual void *lookup(const std::string Name) {
@@ -41,6 +41,12 @@ struct CompileConfig {
   bool real_matrix_scalarize;
   bool half2_vectorization;
   bool make_cpu_multithreading_loop;
+  // Tune the block size of CPU range-fors across launches from their measured
+  // per-block cost, instead of using a fixed block_dim.
+  bool cpu_adaptive_chunking{false};
+  // Pack isomorphic scalar arithmetic into SIMD vectors of simd_width lanes
+  // on CPUs, see irpass::slp_vectorize.
+  bool cpu_slp_vectorization{false};
   DataType default_fp;
   DataType default_ip;
   DataType default_up;
@@ -57,7 +63,28 @@ struct CompileConfig {
   int saturating_grid_dim;
   int max_block_dim;
   int cpu_max_num_threads;
+  // Use the work-stealing scheduler instead of the default ThreadPool for
+  // CPU parallel-for loops.
+  bool cpu_work_stealing{false};
+  // Pin the i-th CPU worker thread to the i-th CPU the process may run on.
+  bool cpu_pin_threads{false};
+  // Run CPU kernel launches on a dispatcher thread so that the launching
+  // thread does not block. Launches with return values or external arrays,
+  // and every host access to fields or ndarrays, wait for pending launches.
+  bool cpu_async_launch{false};
+  // Back SNode tree roots and ndarrays on CPU with transparent huge pages.
+  bool cpu_huge_pages{false};
+  // NUMA placement of SNode tree roots and ndarrays on CPU: "default",
+  // "interleave" (pages round-robin over all nodes) or "first_touch" (each
+  // CPU worker thread touches one contiguous slice of the pages, which lands
+  // on its node, as a range-for split over the threads would).
+  std::string cpu_numa_policy{"default"};
   int random_seed;
+  // Reclaim at most max(incremental_gc_budget, 1/8 of the backlog) deactivated
+  // sparse nodes per gc task and zero-fill them on re-allocation, instead of
+  // reclaiming and zero-filling all of them at once.
+  bool incremental_gc{false};
+  int incremental_gc_budget{16384};
 
   // LLVM backend options:
   bool print_struct_llvm_ir;
@@ -65,6 +92,22 @@ struct CompileConfig {
   bool print_kernel_llvm_ir_optimized;
   bool print_kernel_asm;
   bool print_kernel_amdgcn;
+  // Link the runtime into each offloaded task and optimize it on the
+  // compilation workers, leaving only a light cleanup of the linked kernel
+  // module to the compiling thread. Only the CPU backend supports this.
+  bool llvm_per_task_opt{false};
+  // Compile the runtime once into the JIT and let CPU kernels call into it,
+  // instead of linking a copy of the runtime functions they use into each
+  // kernel. Trades the inlining of runtime functions for compile time.
+  bool llvm_shared_runtime{false};
+  // Log the time spent in each phase of compiling an LLVM kernel.
+  bool print_compile_time_breakdown{false};
+  // Compile CPU kernels without optimization for their first launches, and
+  // recompile those launched tiered_jit_threshold times at
+  // external_optimization_level on a background thread. The CPU backend only
+  // honors external_optimization_level when this is set.
+  bool tiered_jit{false};
+  int tiered_jit_threshold{16};
 
   // CUDA/AMDGPU backend options:
   float64 device_memory_GB;
@@ -99,6 +142,12 @@ struct CompileConfig {
   int offline_cache_max_size_of_files{100 * 1024 *
                                       1024};   // bytes, default: 100MB
   double offline_cache_cleaning_factor{0.25};  // [0.f, 1.f]
+  // Pack the offline cache into one append-only data file and a
+  // memory-mapped index, instead of one file per kernel and a metadata file.
+  bool offline_cache_packed{false};
+  // Cache the host object code of CPU kernels instead of their LLVM IR, so
+  // that loading a cached kernel skips the LLVM backend.
+  bool offline_cache_object_code{false};
 
   int num_compile_threads{4};
   std::string vk_api_version;
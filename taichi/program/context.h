@@ -23,7 +23,7 @@ struct RuntimeContext {
   uint64_t args[taichi_max_num_args_total];
   uint64_t grad_args[taichi_max_num_args_total];
   int32_t extra_args[taichi_max_num_args_extra][taichi_max_num_indices];
-  int32_t cpu_thread_id;
+  int32_t cpu_thread_id{0};
 
   // We move the pointer of result buffer from LLVMRuntime to RuntimeContext
   // because each real function need a place to store its result, but
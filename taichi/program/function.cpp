@@ -16,7 +16,11 @@ void Function::set_function_body(const std::function<void()> &func) {
   ir = context->get_root();
   ir_type_ = IRType::AST;
 
-  func();
+  {
+    // Build the IR in the arena of its root
+    IRArena::Scope arena_scope(get_ir_arena(ir.get()));
+    func();
+  }
   finalize_params();
   finalize_rets();
 
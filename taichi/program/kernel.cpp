@@ -52,8 +52,44 @@ Kernel::Kernel(Program &program,
   }
 }
 
+Kernel::~Kernel() {
+  wait_for_tiered_compilation();
+}
+
 void Kernel::compile(const CompileConfig &compile_config) {
-  compiled_ = program->compile(compile_config, *this);
+  wait_for_tiered_compilation();
+  num_launches_ = 0;
+  optimized_compiled_ = {};
+  // Accessors are launched once per element access from Python, where the
+  // launch overhead dominates their run time.
+  compiled_without_opt_ = compile_config.tiered_jit && !is_accessor &&
+                          arch_is_cpu(compile_config.arch) &&
+                          compile_config.external_optimization_level > 0;
+  if (compiled_without_opt_) {
+    auto unoptimized_config = compile_config;
+    unoptimized_config.external_optimization_level = 0;
+    compiled_ = program->compile(unoptimized_config, *this);
+  } else {
+    compiled_ = program->compile(compile_config, *this);
+  }
+}
+
+void Kernel::update_tiered_compilation(const CompileConfig &compile_config) {
+  if (optimized_compiled_.valid()) {
+    if (optimized_compiled_.wait_for(std::chrono::seconds(0)) ==
+        std::future_status::ready) {
+      compiled_ = optimized_compiled_.get();
+      compiled_without_opt_ = false;
+    }
+  } else if (++num_launches_ >= compile_config.tiered_jit_threshold) {
+    optimized_compiled_ = program->compile_async(compile_config, *this);
+  }
+}
+
+void Kernel::wait_for_tiered_compilation() {
+  if (optimized_compiled_.valid()) {
+    optimized_compiled_.wait();
+  }
 }
 
 void Kernel::operator()(const CompileConfig &compile_config,
@@ -61,6 +97,9 @@ void Kernel::operator()(const CompileConfig &compile_config,
   if (!compiled_) {
     compile(compile_config);
   }
+  if (compiled_without_opt_) {
+    update_tiered_compilation(compile_config);
+  }
 
   compiled_(ctx_builder);
 
@@ -179,6 +218,8 @@ void Kernel::init(Program &program,
     name = primal_name + "_reverse_grad";
   }
 
+  // Build the IR in the arena of its root
+  IRArena::Scope arena_scope(get_ir_arena(ir.get()));
   func();
 }
 }  // namespace taichi::lang
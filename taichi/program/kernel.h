@@ -1,5 +1,7 @@
 #pragma once
 
+#include <future>
+
 #include "taichi/util/lang_util.h"
 #include "taichi/ir/snode.h"
 #include "taichi/ir/ir.h"
@@ -36,6 +38,10 @@ class TI_DLL_EXPORT Kernel : public Callable {
          const std::string &name = "",
          AutodiffMode autodiff_mode = AutodiffMode::kNone);
 
+  // Waits for the optimized version of the kernel still being compiled in the
+  // background, if any, which reads the kernel.
+  ~Kernel() override;
+
   bool ir_is_ast() const {
     return ir_is_ast_;
   }
@@ -85,10 +91,22 @@ class TI_DLL_EXPORT Kernel : public Callable {
             const std::string &name = "",
             AutodiffMode autodiff_mode = AutodiffMode::kNone);
 
+  // Counts the launches of an unoptimized |compiled_|, and replaces it with
+  // the optimized version once that has been compiled in the background.
+  void update_tiered_compilation(const CompileConfig &compile_config);
+  // Blocks until the background compile started by
+  // update_tiered_compilation(), if any, is done with this kernel.
+  void wait_for_tiered_compilation();
+
   // True if |ir| is a frontend AST. False if it's already offloaded to CHI IR.
   bool ir_is_ast_{false};
   // The closure that, if invoked, launches the backend kernel (shader)
   FunctionType compiled_{nullptr};
+  // Tiered JIT (see CompileConfig::tiered_jit): whether |compiled_| was
+  // compiled without optimization, and the state of its optimized version.
+  bool compiled_without_opt_{false};
+  int num_launches_{0};
+  std::future<FunctionType> optimized_compiled_;
   // A flag to record whether |ir| has been fully lowered.
   // lower initial AST all the way down to a bunch of
   // OffloadedStmt for async execution TODO(Lin): Check this comment
@@ -32,10 +32,12 @@ void LaunchContextBuilder::set_arg_float(int arg_id, float64 d) {
                  "Assigning scalar value to external (numpy) array argument is "
                  "not allowed.");
 
-  ActionRecorder::get_instance().record(
-      "set_kernel_arg_float64",
-      {ActionArg("kernel_name", kernel_->name), ActionArg("arg_id", arg_id),
-       ActionArg("val", d)});
+  if (ActionRecorder::get_instance().is_recording()) {
+    ActionRecorder::get_instance().record(
+        "set_kernel_arg_float64",
+        {ActionArg("kernel_name", kernel_->name), ActionArg("arg_id", arg_id),
+         ActionArg("val", d)});
+  }
 
   auto dt = kernel_->parameter_list[arg_id].get_dtype();
   if (dt->is_primitive(PrimitiveTypeID::f32)) {
@@ -76,10 +78,12 @@ void LaunchContextBuilder::set_arg_int(int arg_id, int64 d) {
                  "Assigning scalar value to external (numpy) array argument is "
                  "not allowed.");
 
-  ActionRecorder::get_instance().record(
-      "set_kernel_arg_integer",
-      {ActionArg("kernel_name", kernel_->name), ActionArg("arg_id", arg_id),
-       ActionArg("val", d)});
+  if (ActionRecorder::get_instance().is_recording()) {
+    ActionRecorder::get_instance().record(
+        "set_kernel_arg_integer",
+        {ActionArg("kernel_name", kernel_->name), ActionArg("arg_id", arg_id),
+         ActionArg("val", d)});
+  }
 
   auto dt = kernel_->parameter_list[arg_id].get_dtype();
   if (dt->is_primitive(PrimitiveTypeID::i32)) {
@@ -140,7 +144,7 @@ template <typename T>
 T LaunchContextBuilder::get_arg(int i) {
   if (arg_buffer_size > 0) {
     // Currently arg_buffer_size is always zero on non-LLVM-based backends
-    return get_struct_arg<T>({i});
+    return *(T *)(ctx_->arg_buffer + args_type->elements()[i].offset);
   }
   return taichi_union_cast_with_different_sizes<T>(ctx_->args[i]);
 }
@@ -158,7 +162,10 @@ T LaunchContextBuilder::get_grad_arg(int i) {
 
 template <typename T>
 void LaunchContextBuilder::set_arg(int i, T v) {
-  set_struct_arg({i}, v);
+  if (arg_buffer_size > 0) {
+    // Same as set_struct_arg({i}, v), without building an index vector
+    *(T *)(ctx_->arg_buffer + args_type->elements()[i].offset) = v;
+  }
   ctx_->args[i] = taichi_union_cast_with_different_sizes<uint64>(v);
   set_array_device_allocation_type(i, DevAllocType::kNone);
 }
@@ -207,7 +214,7 @@ void LaunchContextBuilder::set_arg_external_array_with_shape(
 
   TI_ASSERT_INFO(shape.size() <= taichi_max_num_indices,
                  "External array cannot have > {max_num_indices} indices");
-  array_ptrs[{arg_id}] = (void *)ptr;
+  array_ptrs[arg_id] = (void *)ptr;
   set_array_runtime_size(arg_id, size);
   set_array_device_allocation_type(arg_id, DevAllocType::kNone);
   for (uint64 i = 0; i < shape.size(); ++i) {
@@ -248,7 +255,7 @@ RuntimeContext &LaunchContextBuilder::get_context() {
 
 void LaunchContextBuilder::set_arg_texture_impl(int arg_id,
                                                 intptr_t alloc_ptr) {
-  array_ptrs[{arg_id}] = (void *)alloc_ptr;
+  array_ptrs[arg_id] = (void *)alloc_ptr;
   set_array_device_allocation_type(arg_id, DevAllocType::kTexture);
 }
 
@@ -256,7 +263,7 @@ void LaunchContextBuilder::set_arg_rw_texture_impl(
     int arg_id,
     intptr_t alloc_ptr,
     const std::array<int, 3> &shape) {
-  array_ptrs[{arg_id}] = (void *)alloc_ptr;
+  array_ptrs[arg_id] = (void *)alloc_ptr;
   set_array_device_allocation_type(arg_id, DevAllocType::kRWTexture);
   TI_ASSERT(shape.size() <= taichi_max_num_indices);
   for (int i = 0; i < shape.size(); i++) {
@@ -273,7 +280,7 @@ void LaunchContextBuilder::set_arg_ndarray_impl(int arg_id,
   has_grad[arg_id] = grad;
 
   // Set array ptr
-  array_ptrs[{arg_id}] = (void *)devalloc_ptr;
+  array_ptrs[arg_id] = (void *)devalloc_ptr;
 
   // Set grad_args[arg_id] value
   if (grad) {
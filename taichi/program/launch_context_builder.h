@@ -115,9 +115,9 @@ class LaunchContextBuilder {
   DevAllocType device_allocation_type[taichi_max_num_args_total]{
       DevAllocType::kNone};
 
-  std::
-      unordered_map<std::vector<int>, void *, hashing::Hasher<std::vector<int>>>
-          array_ptrs;
+  // `array_ptrs` holds the pointer passed for the i-th arg if it is an array
+  // or a texture, and nullptr otherwise.
+  void *array_ptrs[taichi_max_num_args_total]{nullptr};
 };
 
 }  // namespace taichi::lang
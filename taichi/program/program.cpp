@@ -195,6 +195,12 @@ FunctionType Program::compile(const CompileConfig &compile_config,
   return ret;
 }
 
+std::future<FunctionType> Program::compile_async(
+    const CompileConfig &compile_config,
+    Kernel &kernel) {
+  return program_impl_->compile_async(compile_config, &kernel);
+}
+
 void Program::materialize_runtime() {
   program_impl_->materialize_runtime(profiler.get(), &result_buffer);
 }
@@ -300,6 +306,46 @@ Kernel &Program::get_snode_writer(SNode *snode) {
   return ker;
 }
 
+Kernel &Program::get_snode_batch_accessor(SNode *snode, bool is_writer) {
+  TI_ASSERT(snode->type == SNodeType::place);
+  auto kernel_name = fmt::format(
+      "snode_{}_{}", is_writer ? "scatterer" : "gatherer", snode->id);
+  auto &ker = kernel([snode, is_writer, this](Kernel *kernel) {
+    ASTBuilder &builder = kernel->context->builder();
+    auto indices = Expr::make<ExternalTensorExpression>(
+        PrimitiveType::i32, /*dim=*/2, /*arg_id=*/0, /*element_dim=*/0);
+    auto values = Expr::make<ExternalTensorExpression>(
+        snode->dt, /*dim=*/1, /*arg_id=*/1, /*element_dim=*/0);
+    auto n = Expr::make<ArgLoadExpression>(2, PrimitiveType::i32);
+    n->type_check(&this->compile_config());
+    builder.insert_for(Expr(0), n, [&](Expr i) {
+      ExprGroup field_indices;
+      for (int k = 0; k < snode->num_active_indices; k++) {
+        auto index = builder.expr_subscript(indices, ExprGroup(i, Expr(k)));
+        index->type_check(&this->compile_config());
+        field_indices.push_back(index);
+      }
+      auto value = builder.expr_subscript(values, ExprGroup(i));
+      value->type_check(&this->compile_config());
+      auto element = builder.expr_subscript(Expr(snode_to_fields_.at(snode)),
+                                            field_indices);
+      element->type_check(&this->compile_config());
+      if (is_writer) {
+        builder.insert_assignment(element, value, element->tb);
+      } else {
+        builder.insert_assignment(value, element, value->tb);
+      }
+    });
+  });
+  ker.name = kernel_name;
+  ker.is_accessor = true;
+  ker.insert_arr_param(PrimitiveType::i32, /*total_dim=*/2, {});
+  ker.insert_arr_param(snode->dt, /*total_dim=*/1, {});
+  ker.insert_scalar_param(PrimitiveType::i32);
+  ker.finalize_params();
+  return ker;
+}
+
 uint64 Program::fetch_result_uint64(int i) {
   return program_impl_->fetch_result_uint64(i, result_buffer);
 }
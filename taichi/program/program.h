@@ -131,12 +131,21 @@ class TI_DLL_EXPORT Program {
   // offloading them to each backend. We should probably separate the logic?
   FunctionType compile(const CompileConfig &compile_config, Kernel &kernel);
 
+  // Same as compile(), but runs on a background thread. Used by tiered JIT.
+  std::future<FunctionType> compile_async(const CompileConfig &compile_config,
+                                          Kernel &kernel);
+
   void check_runtime_error();
 
   Kernel &get_snode_reader(SNode *snode);
 
   Kernel &get_snode_writer(SNode *snode);
 
+  // An accessor kernel copying the elements at a batch of indices to
+  // (gatherer) or from (scatterer, |is_writer|) an external array in a single
+  // launch.
+  Kernel &get_snode_batch_accessor(SNode *snode, bool is_writer);
+
   uint64 fetch_result_uint64(int i);
 
   template <typename T>
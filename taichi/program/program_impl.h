@@ -1,5 +1,7 @@
 #pragma once
 
+#include <future>
+
 #include "taichi/aot/module_builder.h"
 #include "taichi/ir/statements.h"
 #include "taichi/system/memory_pool.h"
@@ -40,6 +42,17 @@ class ProgramImpl {
   virtual FunctionType compile(const CompileConfig &compile_config,
                                Kernel *kernel) = 0;
 
+  /**
+   * Codegen to specific backend on a background thread. The task reads
+   * |kernel| until the returned future is ready, so the kernel waits for it
+   * before it is recompiled or destroyed.
+   */
+  virtual std::future<FunctionType> compile_async(
+      const CompileConfig &compile_config,
+      Kernel *kernel) {
+    TI_NOT_IMPLEMENTED;
+  }
+
   /**
    * Allocate runtime buffer, e.g result_buffer or backend specific runtime
    * buffer, e.g. preallocated_device_buffer on CUDA.
@@ -2,6 +2,9 @@
 
 #include "taichi/program/program.h"
 
+#include <algorithm>
+#include <array>
+
 namespace taichi::lang {
 
 namespace {
@@ -25,11 +28,12 @@ SNodeRwAccessorsBank::Accessors SNodeRwAccessorsBank::get(SNode *snode) {
   return Accessors(snode, kernels, program_);
 }
 
-SNodeRwAccessorsBank::Accessors::Accessors(const SNode *snode,
-                                           const RwKernels &kernels,
+SNodeRwAccessorsBank::Accessors::Accessors(SNode *snode,
+                                           RwKernels &kernels,
                                            Program *prog)
     : snode_(snode),
       prog_(prog),
+      kernels_(&kernels),
       reader_(kernels.reader),
       writer_(kernels.writer) {
   TI_ASSERT(reader_ != nullptr);
@@ -103,4 +107,170 @@ uint64 SNodeRwAccessorsBank::Accessors::read_uint(const std::vector<int> &I) {
   return ret;
 }
 
+void SNodeRwAccessorsBank::Accessors::read_batch(const int32 *indices,
+                                                 void *values,
+                                                 int n) {
+  if (n <= 0) {
+    return;
+  }
+  check_batch_indices(indices, n);
+  prog_->synchronize();
+  auto element_size = data_type_size(snode_->dt);
+  auto ptrs = get_dense_element_ptrs(indices, n);
+  if (!ptrs.empty()) {
+    for (int i = 0; i < n; i++) {
+      std::memcpy((uint8 *)values + i * element_size, ptrs[i], element_size);
+    }
+    return;
+  }
+  if (kernels_->gatherer == nullptr) {
+    kernels_->gatherer =
+        &prog_->get_snode_batch_accessor(snode_, /*is_writer=*/false);
+  }
+  launch_batch_kernel(kernels_->gatherer, indices, values, n);
+  prog_->synchronize();
+}
+
+void SNodeRwAccessorsBank::Accessors::write_batch(const int32 *indices,
+                                                  const void *values,
+                                                  int n) {
+  if (n <= 0) {
+    return;
+  }
+  check_batch_indices(indices, n);
+  prog_->synchronize();
+  auto element_size = data_type_size(snode_->dt);
+  auto ptrs = get_dense_element_ptrs(indices, n);
+  if (!ptrs.empty()) {
+    for (int i = 0; i < n; i++) {
+      std::memcpy(ptrs[i], (const uint8 *)values + i * element_size,
+                  element_size);
+    }
+    return;
+  }
+  if (kernels_->scatterer == nullptr) {
+    kernels_->scatterer =
+        &prog_->get_snode_batch_accessor(snode_, /*is_writer=*/true);
+  }
+  launch_batch_kernel(kernels_->scatterer, indices, values, n);
+}
+
+void SNodeRwAccessorsBank::Accessors::check_batch_indices(const int32 *indices,
+                                                          int n) {
+  const int num_indices = snode_->num_active_indices;
+  for (int i = 0; i < n; i++) {
+    const int32 *I = indices + i * num_indices;
+    bool in_bound = true;
+    for (int k = 0; k < num_indices; k++) {
+      int offset = snode_->index_offsets.empty() ? 0 : snode_->index_offsets[k];
+      in_bound &= I[k] >= offset &&
+                  I[k] < offset + snode_->shape_along_axis(k);
+    }
+    if (in_bound) {
+      continue;
+    }
+    // Same as the message of the bound checks of the scalar accessors
+    std::vector<int> shape, offsets, index;
+    for (int k = 0; k < num_indices; k++) {
+      shape.push_back(snode_->shape_along_axis(k));
+      offsets.push_back(snode_->index_offsets.empty()
+                            ? 0
+                            : snode_->index_offsets[k]);
+      index.push_back(I[k]);
+    }
+    throw TaichiAssertionError(fmt::format(
+        "Accessing field ({}) of size ({}) {}with indices ({})",
+        snode_->get_node_type_name_hinted(), fmt::join(shape, ", "),
+        snode_->index_offsets.empty()
+            ? ""
+            : fmt::format("offset ({}) ", fmt::join(offsets, ", ")),
+        fmt::join(index, ", ")));
+  }
+}
+
+void SNodeRwAccessorsBank::Accessors::launch_batch_kernel(
+    Kernel *kernel,
+    const int32 *indices,
+    const void *values,
+    int n) {
+  const int num_indices = snode_->num_active_indices;
+  auto launch_ctx = kernel->make_launch_context();
+  launch_ctx.set_arg_external_array_with_shape(
+      0, (uintptr_t)indices, sizeof(int32) * n * num_indices,
+      {n, num_indices});
+  launch_ctx.set_arg_external_array_with_shape(
+      1, (uintptr_t)values, data_type_size(snode_->dt) * n, {n});
+  launch_ctx.set_arg_int(2, n);
+  (*kernel)(prog_->compile_config(), launch_ctx);
+}
+
+std::vector<uint8 *> SNodeRwAccessorsBank::Accessors::get_dense_element_ptrs(
+    const int32 *indices,
+    int n) {
+  if (!arch_is_cpu(prog_->compile_config().arch)) {
+    return {};
+  }
+  // From root to leaf
+  std::vector<const SNode *> path;
+  for (const SNode *s = snode_; s != nullptr; s = s->parent) {
+    if (s != snode_ && s->type != SNodeType::dense &&
+        s->type != SNodeType::root) {
+      return {};
+    }
+    path.push_back(s);
+  }
+  std::reverse(path.begin(), path.end());
+
+  auto root = prog_->get_snode_tree_device_ptr(snode_->get_snode_tree_id());
+  uint8 *root_ptr = nullptr;
+  if (root.device->map_range(root, snode_->cell_size_bytes,
+                             (void **)&root_ptr) != RhiResult::success) {
+    return {};
+  }
+
+  // Same as ScalarPointerLowerer, evaluated on the host
+  std::array<int, taichi_max_num_indices> leaf_total_shape;
+  leaf_total_shape.fill(1);
+  for (const auto *s : path) {
+    for (int j = 0; j < taichi_max_num_indices; j++) {
+      leaf_total_shape[j] *= s->extractors[j].shape;
+    }
+  }
+  const int num_indices = snode_->num_active_indices;
+  std::vector<uint8 *> ptrs(n);
+  for (int i = 0; i < n; i++) {
+    int I[taichi_max_num_indices];
+    for (int k = 0; k < num_indices; k++) {
+      I[k] = indices[i * num_indices + k];
+      if (!snode_->index_offsets.empty()) {
+        I[k] -= snode_->index_offsets[k];
+      }
+    }
+    auto total_shape = leaf_total_shape;
+    std::array<bool, taichi_max_num_indices> is_first_extraction;
+    is_first_extraction.fill(true);
+    uint8 *ptr = root_ptr;
+    for (int level = 0; level + 1 < (int)path.size(); level++) {
+      const auto *s = path[level];
+      int64 linearized = 0;
+      for (int k_ = 0; k_ < num_indices; k_++) {
+        int k = snode_->physical_index_position[k_];
+        if (!s->extractors[k].active) {
+          continue;
+        }
+        const int prev = total_shape[k];
+        total_shape[k] /= s->extractors[k].shape;
+        const int next = total_shape[k];
+        int extracted = is_first_extraction[k] ? I[k_] : I[k_] % prev;
+        is_first_extraction[k] = false;
+        linearized = linearized * s->extractors[k].shape + extracted / next;
+      }
+      ptr += linearized * s->cell_size_bytes +
+             path[level + 1]->offset_bytes_in_parent_cell;
+    }
+    ptrs[i] = ptr;
+  }
+  return ptrs;
+}
+
 }  // namespace taichi::lang
@@ -20,14 +20,15 @@ class SNodeRwAccessorsBank {
   struct RwKernels {
     Kernel *reader{nullptr};
     Kernel *writer{nullptr};
+    // Created on first use of the batched accessors
+    Kernel *gatherer{nullptr};
+    Kernel *scatterer{nullptr};
   };
 
  public:
   class Accessors {
    public:
-    explicit Accessors(const SNode *snode,
-                       const RwKernels &kernels,
-                       Program *prog);
+    explicit Accessors(SNode *snode, RwKernels &kernels, Program *prog);
 
     // for float and double
     void write_float(const std::vector<int> &I, float64 val);
@@ -39,9 +40,30 @@ class SNodeRwAccessorsBank {
     int64 read_int(const std::vector<int> &I);
     uint64 read_uint(const std::vector<int> &I);
 
+    // Copies the elements at |n| indices to/from |values|. Fields whose
+    // ancestors are all dense are accessed in place on CPU, otherwise a single
+    // gather/scatter kernel is launched.
+    void read_batch(const int32 *indices, void *values, int n);
+    void write_batch(const int32 *indices, const void *values, int n);
+
    private:
-    const SNode *snode_;
+    // Raises the error of an out-of-bound access if any of the indices is
+    // outside the field, like the bound checks of the scalar accessors.
+    void check_batch_indices(const int32 *indices, int n);
+
+    // Returns the address of every element on CPU if it does not depend on
+    // the activation state of the SNode tree, i.e. all the ancestors are
+    // dense, or an empty vector otherwise.
+    std::vector<uint8 *> get_dense_element_ptrs(const int32 *indices, int n);
+
+    void launch_batch_kernel(Kernel *kernel,
+                             const int32 *indices,
+                             const void *values,
+                             int n);
+
+    SNode *snode_;
     Program *prog_;
+    RwKernels *kernels_;
     Kernel *reader_;
     Kernel *writer_;
   };
@@ -137,6 +137,8 @@ void export_lang(py::module &m) {
       .def(py::init<>())
       .def_readwrite("arch", &CompileConfig::arch)
       .def_readwrite("opt_level", &CompileConfig::opt_level)
+      .def_readwrite("external_optimization_level",
+                     &CompileConfig::external_optimization_level)
       .def_readwrite("print_ir", &CompileConfig::print_ir)
       .def_readwrite("print_preprocessed_ir",
                      &CompileConfig::print_preprocessed_ir)
@@ -152,6 +154,14 @@ void export_lang(py::module &m) {
       .def_readwrite("print_kernel_llvm_ir_optimized",
                      &CompileConfig::print_kernel_llvm_ir_optimized)
       .def_readwrite("print_kernel_asm", &CompileConfig::print_kernel_asm)
+      .def_readwrite("llvm_per_task_opt", &CompileConfig::llvm_per_task_opt)
+      .def_readwrite("llvm_shared_runtime",
+                     &CompileConfig::llvm_shared_runtime)
+      .def_readwrite("print_compile_time_breakdown",
+                     &CompileConfig::print_compile_time_breakdown)
+      .def_readwrite("tiered_jit", &CompileConfig::tiered_jit)
+      .def_readwrite("tiered_jit_threshold",
+                     &CompileConfig::tiered_jit_threshold)
       .def_readwrite("print_kernel_amdgcn", &CompileConfig::print_kernel_amdgcn)
       .def_readwrite("simplify_before_lower_access",
                      &CompileConfig::simplify_before_lower_access)
@@ -172,6 +182,14 @@ void export_lang(py::module &m) {
       .def_readwrite("saturating_grid_dim", &CompileConfig::saturating_grid_dim)
       .def_readwrite("max_block_dim", &CompileConfig::max_block_dim)
       .def_readwrite("cpu_max_num_threads", &CompileConfig::cpu_max_num_threads)
+      .def_readwrite("cpu_work_stealing", &CompileConfig::cpu_work_stealing)
+      .def_readwrite("cpu_pin_threads", &CompileConfig::cpu_pin_threads)
+      .def_readwrite("cpu_async_launch", &CompileConfig::cpu_async_launch)
+      .def_readwrite("cpu_huge_pages", &CompileConfig::cpu_huge_pages)
+      .def_readwrite("cpu_numa_policy", &CompileConfig::cpu_numa_policy)
+      .def_readwrite("incremental_gc", &CompileConfig::incremental_gc)
+      .def_readwrite("incremental_gc_budget",
+                     &CompileConfig::incremental_gc_budget)
       .def_readwrite("random_seed", &CompileConfig::random_seed)
       .def_readwrite("verbose_kernel_launches",
                      &CompileConfig::verbose_kernel_launches)
@@ -201,6 +219,10 @@ void export_lang(py::module &m) {
       .def_readwrite("half2_vectorization", &CompileConfig::half2_vectorization)
       .def_readwrite("make_cpu_multithreading_loop",
                      &CompileConfig::make_cpu_multithreading_loop)
+      .def_readwrite("cpu_adaptive_chunking",
+                     &CompileConfig::cpu_adaptive_chunking)
+      .def_readwrite("cpu_slp_vectorization",
+                     &CompileConfig::cpu_slp_vectorization)
       .def_readwrite("cc_compile_cmd", &CompileConfig::cc_compile_cmd)
       .def_readwrite("cc_link_cmd", &CompileConfig::cc_link_cmd)
       .def_readwrite("quant_opt_store_fusion",
@@ -234,6 +256,10 @@ void export_lang(py::module &m) {
                      &CompileConfig::offline_cache_max_size_of_files)
       .def_readwrite("offline_cache_cleaning_factor",
                      &CompileConfig::offline_cache_cleaning_factor)
+      .def_readwrite("offline_cache_packed",
+                     &CompileConfig::offline_cache_packed)
+      .def_readwrite("offline_cache_object_code",
+                     &CompileConfig::offline_cache_object_code)
       .def_readwrite("num_compile_threads", &CompileConfig::num_compile_threads)
       .def_readwrite("vk_api_version", &CompileConfig::vk_api_version)
       .def_readwrite("cuda_stack_limit", &CompileConfig::cuda_stack_limit);
@@ -246,6 +272,15 @@ void export_lang(py::module &m) {
       [&]() -> CompileConfig & { return default_compile_config; },
       py::return_value_policy::reference);
 
+  m.def("get_ir_allocation_stats", []() {
+    auto stats = IRArena::get_stats();
+    py::dict ret;
+    ret["num_allocations"] = stats.num_allocations;
+    ret["num_reused"] = stats.num_reused;
+    ret["num_heap_allocations"] = stats.num_heap_allocations;
+    return ret;
+  });
+
   py::class_<Program::KernelProfilerQueryResult>(m, "KernelProfilerQueryResult")
       .def_readwrite("counter", &Program::KernelProfilerQueryResult::counter)
       .def_readwrite("min", &Program::KernelProfilerQueryResult::min)
@@ -368,6 +403,30 @@ void export_lang(py::module &m) {
              Timelines::get_instance().save(fn);
            })
       .def("print_memory_profiler_info", &Program::print_memory_profiler_info)
+      .def("get_memory_pool_stats",
+           [](Program *program) {
+             auto stats =
+                 MemoryPool::get_instance(program->compile_config().arch)
+                     .get_stats();
+             py::dict ret;
+             ret["reserved_bytes"] = stats.reserved_bytes;
+             ret["committed_bytes"] = stats.committed_bytes;
+             ret["in_use_bytes"] = stats.in_use_bytes;
+             return ret;
+           })
+      .def("get_kernel_cache_stats",
+           [](Program *program) {
+             const auto &stats = program->get_program_impl()
+                                     ->get_kernel_compilation_manager()
+                                     .get_cache_stats();
+             py::dict ret;
+             ret["fingerprint_hits"] = stats.fingerprint_hits;
+             ret["fingerprint_misses"] = stats.fingerprint_misses;
+             ret["memory_hits"] = stats.memory_hits;
+             ret["disk_hits"] = stats.disk_hits;
+             ret["misses"] = stats.misses;
+             return ret;
+           })
       .def("finalize", &Program::finalize)
       .def("get_total_compilation_time", &Program::get_total_compilation_time)
       .def("get_snode_num_dynamically_allocated",
@@ -510,6 +569,8 @@ void export_lang(py::module &m) {
       .def("write_int", &SNode::write_int)
       .def("write_uint", &SNode::write_uint)
       .def("write_float", &SNode::write_float)
+      .def("read_batch", &SNode::read_batch)
+      .def("write_batch", &SNode::write_batch)
       .def("get_shape_along_axis", &SNode::shape_along_axis)
       .def("get_physical_index_position",
            [](SNode *snode) {
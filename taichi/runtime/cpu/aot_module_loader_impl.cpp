@@ -39,8 +39,11 @@ class AotModuleImpl : public LlvmAotModule {
 namespace cpu {
 
 std::unique_ptr<aot::Module> make_aot_module(std::any mod_params) {
-  auto mod = std::make_unique<AotModuleImpl>(
-      std::any_cast<const AotModuleParams &>(mod_params));
+  const auto &params = std::any_cast<const AotModuleParams &>(mod_params);
+  auto mod = std::make_unique<AotModuleImpl>(params);
+  if (params.num_prefetch_threads > 0) {
+    mod->prefetch_kernels(params.num_prefetch_threads);
+  }
   return mod;
 }
 
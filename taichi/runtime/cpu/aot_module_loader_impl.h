@@ -11,6 +11,9 @@ namespace cpu {
 struct TI_DLL_EXPORT AotModuleParams {
   std::string module_path;
   LlvmRuntimeExecutor *executor_{nullptr};
+  // If positive, all the kernels are loaded when the module is made, on this
+  // many threads. Otherwise each kernel is loaded on its first get_kernel().
+  int num_prefetch_threads{0};
 };
 
 TI_DLL_EXPORT std::unique_ptr<aot::Module> make_aot_module(std::any mod_params);
@@ -29,6 +29,7 @@
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/Support/DynamicLibrary.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Target/TargetMachine.h"
@@ -103,6 +104,8 @@ class JITSessionCPU : public JITSession {
   MangleAndInterner mangle_;
   std::mutex mut_;
   std::vector<llvm::orc::JITDylib *> all_libs_;
+  // Added by add_shared_module(), linked against by the later modules
+  llvm::orc::JITDylib *shared_lib_{nullptr};
   int module_counter_;
   SectionMemoryManager *memory_manager_;
 
@@ -119,7 +122,9 @@ class JITSessionCPU : public JITSession {
 #else
         object_layer_(es_,
                       [&]() {
+                        // Called when a lookup emits an object
                         auto smgr = std::make_unique<SectionMemoryManager>();
+                        std::lock_guard<std::mutex> _(mut_);
                         memory_manager_ = smgr.get();
                         return smgr;
                       }),
@@ -153,31 +158,50 @@ class JITSessionCPU : public JITSession {
     TI_ASSERT(max_reg == 0);  // No need to specify max_reg on CPUs
     TI_ASSERT(M);
     std::lock_guard<std::mutex> _(mut_);
-    auto dylib_expect = es_.createJITDylib(fmt::format("{}", module_counter_));
-    TI_ASSERT(dylib_expect);
-    auto &dylib = dylib_expect.get();
-    dylib.addGenerator(
-        cantFail(llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
-            dl_.getGlobalPrefix())));
+    auto &dylib = create_dylib();
     auto *thread_safe_context =
         this->tlctx_->get_this_thread_thread_safe_context();
     cantFail(compile_layer_.add(
         dylib,
         llvm::orc::ThreadSafeModule(std::move(M), *thread_safe_context)));
-    all_libs_.push_back(&dylib);
-    auto new_module = std::make_unique<JITModuleCPU>(this, &dylib);
-    auto new_module_raw_ptr = new_module.get();
-    modules.push_back(std::move(new_module));
-    module_counter_++;
-    return new_module_raw_ptr;
+    return create_jit_module(dylib);
   }
 
-  void *lookup(const std::string Name) override {
+  void add_shared_module(std::unique_ptr<llvm::Module> M) override {
+    TI_ASSERT(M);
     std::lock_guard<std::mutex> _(mut_);
+    TI_ASSERT(shared_lib_ == nullptr);
+    auto &dylib = create_dylib();
+    auto *thread_safe_context =
+        this->tlctx_->get_this_thread_thread_safe_context();
+    cantFail(compile_layer_.add(
+        dylib,
+        llvm::orc::ThreadSafeModule(std::move(M), *thread_safe_context)));
+    shared_lib_ = &dylib;
+  }
+
+  JITModule *add_object(const std::string &object_code) override {
+    std::lock_guard<std::mutex> _(mut_);
+    auto &dylib = create_dylib();
+    // Goes straight to the linking layer, skipping the IR compile layer
+    cantFail(object_layer_.add(
+        dylib, llvm::MemoryBuffer::getMemBufferCopy(object_code)));
+    return create_jit_module(dylib);
+  }
+
+  // The lookups compile the IR of the symbols they find, so they must not hold
+  // |mut_|. The ExecutionSession is thread-safe, and compiles the modules of
+  // concurrent lookups in parallel.
+  void *lookup(const std::string Name) override {
+    std::vector<llvm::orc::JITDylib *> libs;
+    {
+      std::lock_guard<std::mutex> _(mut_);
+      libs = all_libs_;
+    }
 #ifdef __APPLE__
-    auto symbol = es_.lookup(all_libs_, mangle_(Name));
+    auto symbol = es_.lookup(libs, mangle_(Name));
 #else
-    auto symbol = es_.lookup(all_libs_, es_.intern(Name));
+    auto symbol = es_.lookup(libs, es_.intern(Name));
 #endif
     if (!symbol)
       TI_ERROR("Function \"{}\" not found", Name);
@@ -185,7 +209,6 @@ class JITSessionCPU : public JITSession {
   }
 
   void *lookup_in_module(JITDylib *lib, const std::string Name) {
-    std::lock_guard<std::mutex> _(mut_);
 #ifdef __APPLE__
     auto symbol = es_.lookup({lib}, mangle_(Name));
 #else
@@ -195,6 +218,30 @@ class JITSessionCPU : public JITSession {
       TI_ERROR("Function \"{}\" not found", Name);
     return (void *)(symbol->getAddress());
   }
+
+ private:
+  // These must be called with |mut_| held
+  JITDylib &create_dylib() {
+    auto dylib_expect = es_.createJITDylib(fmt::format("{}", module_counter_));
+    TI_ASSERT(dylib_expect);
+    auto &dylib = dylib_expect.get();
+    if (shared_lib_) {
+      dylib.addToLinkOrder(*shared_lib_);
+    }
+    dylib.addGenerator(
+        cantFail(llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+            dl_.getGlobalPrefix())));
+    return dylib;
+  }
+
+  JITModule *create_jit_module(JITDylib &dylib) {
+    all_libs_.push_back(&dylib);
+    auto new_module = std::make_unique<JITModuleCPU>(this, &dylib);
+    auto new_module_raw_ptr = new_module.get();
+    modules.push_back(std::move(new_module));
+    module_counter_++;
+    return new_module_raw_ptr;
+  }
 };
 
 void *JITModuleCPU::lookup_function(const std::string &name) {
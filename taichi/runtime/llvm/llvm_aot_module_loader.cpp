@@ -1,6 +1,8 @@
 #include "taichi/runtime/llvm/llvm_aot_module_loader.h"
 #include "taichi/runtime/llvm/aot_graph_data.h"
 
+#include "taichi/program/parallel_executor.h"
+
 namespace taichi::lang {
 
 LlvmOfflineCache::KernelCacheData LlvmAotModule::load_kernel_from_cache(
@@ -16,11 +18,41 @@ LlvmOfflineCache::KernelCacheData LlvmAotModule::load_kernel_from_cache(
 
 std::unique_ptr<aot::Kernel> LlvmAotModule::make_new_kernel(
     const std::string &name) {
+  if (auto iter = prefetched_kernels_.find(name);
+      iter != prefetched_kernels_.end()) {
+    auto kernel = std::move(iter->second);
+    prefetched_kernels_.erase(iter);
+    return kernel;
+  }
   auto kernel_cache = load_kernel_from_cache(name);
   auto fn = convert_module_to_function(name, kernel_cache.clone());
   return std::make_unique<llvm_aot::KernelImpl>(fn, std::move(kernel_cache));
 }
 
+void LlvmAotModule::prefetch_kernels(int num_threads) {
+  TI_ASSERT(cache_reader_ != nullptr);
+  auto names = cache_reader_->get_kernel_names();
+  std::vector<std::unique_ptr<aot::Kernel>> kernels(names.size());
+  {
+    // Each worker parses its kernels into its own LLVM context
+    ParallelExecutor workers("aot_prefetch", num_threads);
+    for (std::size_t i = 0; i < names.size(); i++) {
+      if (prefetched_kernels_.count(names[i])) {
+        continue;
+      }
+      workers.enqueue([this, &names, &kernels, i]() {
+        kernels[i] = make_new_kernel(names[i]);
+      });
+    }
+    workers.flush();
+  }
+  for (std::size_t i = 0; i < names.size(); i++) {
+    if (kernels[i]) {
+      prefetched_kernels_[names[i]] = std::move(kernels[i]);
+    }
+  }
+}
+
 std::unique_ptr<aot::Field> LlvmAotModule::make_new_field(
     const std::string &name) {
   // Check if "name" represents snode_tree_id.
@@ -41,6 +73,11 @@ std::unique_ptr<aot::Field> LlvmAotModule::make_new_field(
 
 std::unique_ptr<aot::CompiledGraph> LlvmAotModule::get_graph(
     const std::string &name) {
+  if (!graphs_loaded_) {
+    read_from_binary_file(graphs_,
+                          fmt::format("{}/graphs.tcb", module_path_));
+    graphs_loaded_ = true;
+  }
   auto it = graphs_.find(name);
   if (it == graphs_.end()) {
     TI_DEBUG("Cannot find graph {}", name);
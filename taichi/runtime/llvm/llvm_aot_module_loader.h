@@ -18,11 +18,9 @@ class LlvmAotModule : public aot::Module {
   explicit LlvmAotModule(const std::string &module_path,
                          LlvmRuntimeExecutor *executor)
       : executor_(executor),
+        module_path_(module_path),
         cache_reader_(LlvmOfflineCacheFileReader::make(module_path)) {
     TI_ASSERT(executor_ != nullptr);
-
-    const std::string graph_path = fmt::format("{}/graphs.tcb", module_path);
-    read_from_binary_file(graphs_, graph_path);
   }
 
   Arch arch() const override {
@@ -56,6 +54,10 @@ class LlvmAotModule : public aot::Module {
   std::unique_ptr<aot::CompiledGraph> get_graph(
       const std::string &name) override;
 
+  // Kernels are loaded on their first get_kernel() by default. This loads all
+  // of them up front instead, on |num_threads| threads.
+  void prefetch_kernels(int num_threads);
+
  protected:
   virtual FunctionType convert_module_to_function(
       const std::string &name,
@@ -75,8 +77,15 @@ class LlvmAotModule : public aot::Module {
   std::unique_ptr<aot::Field> make_new_field(const std::string &name) override;
 
   LlvmRuntimeExecutor *const executor_{nullptr};
+  const std::string module_path_;
   std::unique_ptr<LlvmOfflineCacheFileReader> cache_reader_{nullptr};
 
+  // Loaded by prefetch_kernels(), handed out by make_new_kernel()
+  std::unordered_map<std::string, std::unique_ptr<aot::Kernel>>
+      prefetched_kernels_;
+  // graphs.tcb is only read by the first get_graph()
+  bool graphs_loaded_{false};
+
   // To prevent repeated SNodeTree initialization
   std::unordered_set<int> initialized_snode_tree_ids;
 };
@@ -348,6 +348,25 @@ std::unique_ptr<llvm::Module> TaichiLLVMContext::clone_runtime_module() {
   return cloned;
 }
 
+bool TaichiLLVMContext::use_shared_runtime() const {
+  return arch_is_cpu(arch_) && config_.llvm_shared_runtime;
+}
+
+void TaichiLLVMContext::add_shared_runtime_module() {
+  TI_AUTO_PROF
+  TI_ASSERT(use_shared_runtime());
+  auto module = clone_runtime_module();
+  // Kernels may call any runtime function, so none of them can be internal
+  // or left out
+  for (auto &func : *module) {
+    if (!func.isDeclaration()) {
+      func.setLinkage(llvm::GlobalValue::ExternalLinkage);
+      func.setVisibility(llvm::GlobalValue::DefaultVisibility);
+    }
+  }
+  jit->add_shared_module(std::move(module));
+}
+
 std::unique_ptr<llvm::Module> TaichiLLVMContext::module_from_file(
     const std::string &file) {
   auto ctx = get_this_thread_context();
@@ -1043,14 +1062,8 @@ LLVMCompiledKernel TaichiLLVMContext::link_compiled_tasks(
         llvm::CloneModule(*linking_context_data->struct_modules[tree_id]),
         llvm::Linker::LinkOnlyNeeded | llvm::Linker::OverrideFromSrc);
   }
-  auto runtime_module =
-      llvm::CloneModule(*linking_context_data->runtime_module);
-  for (auto tls_size : tls_sizes) {
-    add_struct_for_func(runtime_module.get(), tls_size);
-  }
-  linker.linkInModule(
-      std::move(runtime_module),
-      llvm::Linker::LinkOnlyNeeded | llvm::Linker::OverrideFromSrc);
+  link_runtime_module(linker, *linking_context_data->runtime_module,
+                      tls_sizes);
   eliminate_unused_functions(mod.get(), [&](std::string func_name) -> bool {
     return offloaded_names.count(func_name);
   });
@@ -1058,6 +1071,60 @@ LLVMCompiledKernel TaichiLLVMContext::link_compiled_tasks(
   return linked;
 }
 
+void TaichiLLVMContext::link_task_with_runtime(LLVMCompiledTask &task) {
+  TI_AUTO_PROF
+  auto *data = get_this_thread_data();
+  llvm::Linker linker(*task.module);
+  for (auto tree_id : task.used_tree_ids) {
+    linker.linkInModule(llvm::CloneModule(*data->struct_modules[tree_id]),
+                        llvm::Linker::LinkOnlyNeeded |
+                            llvm::Linker::OverrideFromSrc);
+  }
+  link_runtime_module(linker, *get_this_thread_runtime_module(),
+                      task.struct_for_tls_sizes);
+  std::unordered_set<std::string> offloaded_names;
+  for (auto &offloaded : task.tasks) {
+    offloaded_names.insert(offloaded.name);
+  }
+  eliminate_unused_functions(
+      task.module.get(), [&](const std::string &func_name) -> bool {
+        return offloaded_names.count(func_name);
+      });
+  // Nothing is left for link_compiled_tasks() to link in
+  task.used_tree_ids.clear();
+  task.struct_for_tls_sizes.clear();
+}
+
+void TaichiLLVMContext::link_runtime_module(
+    llvm::Linker &linker,
+    const llvm::Module &runtime_module,
+    const std::unordered_set<int> &tls_sizes) {
+  const bool shared = use_shared_runtime();
+  if (shared && tls_sizes.empty()) {
+    // The declarations of the runtime functions resolve to the shared runtime
+    return;
+  }
+  auto cloned = llvm::CloneModule(runtime_module);
+  std::unordered_set<std::string> struct_for_names;
+  for (auto tls_size : tls_sizes) {
+    add_struct_for_func(cloned.get(), tls_size);
+    struct_for_names.insert(get_struct_for_func_name(tls_size));
+  }
+  if (shared) {
+    // Only the specialized struct-for functions are missing from the shared
+    // runtime. What they call is left to it as well.
+    for (auto &func : *cloned) {
+      if (!func.isDeclaration() &&
+          !struct_for_names.count(func.getName().str())) {
+        func.deleteBody();
+      }
+    }
+  }
+  linker.linkInModule(
+      std::move(cloned),
+      llvm::Linker::LinkOnlyNeeded | llvm::Linker::OverrideFromSrc);
+}
+
 void TaichiLLVMContext::add_struct_for_func(llvm::Module *module,
                                             int tls_size) {
   // Note that on CUDA local array allocation must have a compile-time
@@ -66,6 +66,14 @@ class TaichiLLVMContext {
    */
   std::unique_ptr<llvm::Module> clone_runtime_module();
 
+  // Whether kernels call the runtime functions of the module added to the JIT
+  // by add_shared_runtime_module() instead of linking them in.
+  bool use_shared_runtime() const;
+
+  // Adds a copy of the runtime module with all of its functions exported to
+  // the JIT, for use_shared_runtime().
+  void add_shared_runtime_module();
+
   std::unique_ptr<llvm::Module> module_from_file(const std::string &file);
 
   llvm::Type *get_data_type(DataType dt);
@@ -128,6 +136,11 @@ class TaichiLLVMContext {
   LLVMCompiledKernel link_compiled_tasks(
       std::vector<std::unique_ptr<LLVMCompiledTask>> data_list);
 
+  // Links the struct and runtime functions used by |task| into its module,
+  // in the context of the calling thread, so that the module can be optimized
+  // on its own. Everything but the offloaded task functions is internalized.
+  void link_task_with_runtime(LLVMCompiledTask &task);
+
  private:
   std::unique_ptr<llvm::Module> clone_module_to_context(
       llvm::Module *module,
@@ -142,6 +155,12 @@ class TaichiLLVMContext {
 
   static int num_instructions(llvm::Function *func);
 
+  // Links the functions needed from |runtime_module|, specialized for the
+  // struct-for TLS buffer sizes |tls_sizes|, into |linker|'s module.
+  void link_runtime_module(llvm::Linker &linker,
+                           const llvm::Module &runtime_module,
+                           const std::unordered_set<int> &tls_sizes);
+
   void insert_nvvm_annotation(llvm::Function *func, std::string key, int val);
 
   std::unique_ptr<llvm::Module> clone_module_to_this_thread_context(
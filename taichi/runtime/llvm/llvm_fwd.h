@@ -10,6 +10,7 @@ class DataLayout;
 class StructType;
 class JITSymbol;
 class ExitOnError;
+class Linker;
 namespace orc {
 class ThreadSafeContext;
 }
@@ -154,6 +154,16 @@ size_t LlvmOfflineCacheFileReader::get_num_snode_trees() {
   return data_.fields.size();
 }
 
+std::vector<std::string> LlvmOfflineCacheFileReader::get_kernel_names() {
+  std::lock_guard<std::mutex> _(mut_);
+  std::vector<std::string> names;
+  names.reserve(data_.kernels.size());
+  for (const auto &kv : data_.kernels) {
+    names.push_back(kv.first);
+  }
+  return names;
+}
+
 bool LlvmOfflineCacheFileReader::get_field_cache(
     LlvmOfflineCache::FieldCacheData &res,
     int snode_tree_id) {
@@ -173,24 +183,36 @@ bool LlvmOfflineCacheFileReader::get_kernel_cache(
     const std::string &key,
     llvm::LLVMContext &llvm_ctx) {
   TI_AUTO_PROF;
+  std::unique_lock<std::mutex> lock(mut_);
   auto itr = data_.kernels.find(key);
   if (itr == data_.kernels.end()) {
     TI_DEBUG("Cannot find kernel={}", key);
     return false;
   }
 
-  auto &kernel_data = itr->second;
-  auto &data = kernel_data.compiled_data;
-  if (!data.module) {
+  if (!itr->second.compiled_data.module) {
+    // Parsing is the slow part, so let other kernels be loaded meanwhile
+    lock.unlock();
     std::string filename_prefix = taichi::join_path(path_, key);
-    data.module = load_module(filename_prefix, key, llvm_ctx);
+    auto module = load_module(filename_prefix, key, llvm_ctx);
+    lock.lock();
+    itr = data_.kernels.find(key);
+    if (itr == data_.kernels.end()) {
+      return false;
+    }
+    auto &data = itr->second.compiled_data;
     if (!data.module) {
-      data_.kernels.erase(itr);
-      return false;  // Must return
+      if (!module) {
+        data_.kernels.erase(itr);
+        return false;  // Must return
+      }
+      data.module = std::move(module);
     }
   }
+  auto &kernel_data = itr->second;
   kernel_data.last_used_at = std::time(nullptr);
   res = kernel_data.clone();
+  lock.unlock();
 
   // Verify the `res: LlvmOfflineCache::KernelCacheData`
   const auto &compiled_data = res.compiled_data;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 
 #ifdef TI_WITH_LLVM
 #include "llvm/IR/Module.h"
@@ -131,6 +132,8 @@ class LlvmOfflineCacheFileReader {
 
   size_t get_num_snode_trees();
 
+  std::vector<std::string> get_kernel_names();
+
   static std::unique_ptr<LlvmOfflineCacheFileReader> make(
       const std::string &path,
       LlvmOfflineCache::Format format = LlvmOfflineCache::Format::LL);
@@ -151,6 +154,8 @@ class LlvmOfflineCacheFileReader {
   std::string path_;
   LlvmOfflineCache data_;
   LlvmOfflineCache::Format format_;
+  // Guards |data_.kernels|, so that kernels can be loaded in parallel
+  std::mutex mut_;
 };
 
 class LlvmOfflineCacheFileWriter {
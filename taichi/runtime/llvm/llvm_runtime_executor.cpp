@@ -1,5 +1,7 @@
 #include "taichi/runtime/llvm/llvm_runtime_executor.h"
 
+#include <chrono>
+
 #include "taichi/runtime/llvm/llvm_offline_cache.h"
 #include "taichi/runtime/llvm/runtime_module/mem_request.h"
 #include "taichi/rhi/cpu/cpu_device.h"
@@ -24,6 +26,34 @@ void assert_failed_host(const char *msg) {
   TI_ERROR("Assertion failure: {}", msg);
 }
 
+int64 host_get_time_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Splits a range into one contiguous slice per CPU thread, like the range-fors
+// split by make_cpu_multithreaded_range_for, whose pages are first touched by
+// the thread that takes the slice.
+struct FirstTouchContext {
+  char *begin;
+  std::size_t size;
+  int num_slices;
+};
+
+void first_touch_slice(void *context, int /*thread_id*/, int i) {
+  auto ctx = (FirstTouchContext *)context;
+  constexpr std::size_t page_size = MemoryPool::page_size;
+  auto num_pages = (ctx->size + page_size - 1) / page_size;
+  auto page_begin = num_pages * i / ctx->num_slices;
+  auto page_end = num_pages * (i + 1) / ctx->num_slices;
+  for (auto page = page_begin; page < page_end; page++) {
+    // Faults the page in without changing its contents
+    auto p = (volatile char *)(ctx->begin + page * page_size);
+    *p = *p;
+  }
+}
+
 void *taichi_allocate_aligned(MemoryPool *memory_pool,
                               std::size_t size,
                               std::size_t alignment) {
@@ -76,7 +106,20 @@ LlvmRuntimeExecutor::LlvmRuntimeExecutor(CompileConfig &config,
   }
 
   snode_tree_buffer_manager_ = std::make_unique<SNodeTreeBufferManager>(this);
-  thread_pool_ = std::make_unique<ThreadPool>(config.cpu_max_num_threads);
+  if (arch_is_cpu(config.arch) && config.cpu_work_stealing) {
+    work_stealing_thread_pool_ = std::make_unique<WorkStealingThreadPool>(
+        config.cpu_max_num_threads, config.cpu_pin_threads);
+  } else {
+    thread_pool_ = std::make_unique<ThreadPool>(config.cpu_max_num_threads,
+                                                config.cpu_pin_threads);
+  }
+  if (arch_is_cpu(config.arch) && config.cpu_async_launch) {
+    cpu_launch_queue_ = std::make_unique<SerialTaskQueue>();
+  }
+  TI_ERROR_IF(config.cpu_numa_policy != "default" &&
+                  config.cpu_numa_policy != "interleave" &&
+                  config.cpu_numa_policy != "first_touch",
+              "Unknown cpu_numa_policy \"{}\"", config.cpu_numa_policy);
   preallocated_device_buffer_ = nullptr;
 
   llvm_runtime_ = nullptr;
@@ -164,6 +207,9 @@ LlvmRuntimeExecutor::LlvmRuntimeExecutor(CompileConfig &config,
   llvm_context_ = std::make_unique<TaichiLLVMContext>(
       config_, arch_is_cpu(config.arch) ? host_arch() : config.arch);
   init_runtime_jit_module(llvm_context_->clone_runtime_module());
+  if (llvm_context_->use_shared_runtime()) {
+    llvm_context_->add_shared_runtime_module();
+  }
 }
 
 TaichiLLVMContext *LlvmRuntimeExecutor::get_llvm_context() {
@@ -175,6 +221,11 @@ JITModule *LlvmRuntimeExecutor::create_jit_module(
   return get_llvm_context()->jit->add_module(std::move(module));
 }
 
+JITModule *LlvmRuntimeExecutor::create_jit_module_from_object(
+    const std::string &object_code) {
+  return get_llvm_context()->jit->add_object(object_code);
+}
+
 JITModule *LlvmRuntimeExecutor::get_runtime_jit_module() {
   return runtime_jit_module_;
 }
@@ -202,7 +253,14 @@ void LlvmRuntimeExecutor::print_list_manager_info(void *list_manager,
       size_MB);
 }
 
+void LlvmRuntimeExecutor::wait_for_cpu_launches() {
+  if (cpu_launch_queue_) {
+    cpu_launch_queue_->wait();
+  }
+}
+
 void LlvmRuntimeExecutor::synchronize() {
+  wait_for_cpu_launches();
   if (config_.arch == Arch::cuda) {
 #if defined(TI_WITH_CUDA)
     CUDADriver::get_instance().stream_synchronize(nullptr);
@@ -357,6 +415,15 @@ void LlvmRuntimeExecutor::print_memory_profiler_info(
               "  Allocated elements={:n}; free list length={:n}; recycled list "
               "length={:n}\n",
               free_list_used, free_list_len, recycled_list_len);
+
+          auto cache_hits =
+              runtime_query<int64>("NodeManager_get_num_cache_hits",
+                                   result_buffer, node_allocator);
+          auto cache_misses =
+              runtime_query<int64>("NodeManager_get_num_cache_misses",
+                                   result_buffer, node_allocator);
+          fmt::print("  Thread cache hits={:n}; thread cache misses={:n}\n",
+                     cache_hits, cache_misses);
         }
       }
     }
@@ -385,6 +452,7 @@ DevicePtr LlvmRuntimeExecutor::get_snode_tree_device_ptr(int tree_id) {
 void LlvmRuntimeExecutor::initialize_llvm_runtime_snodes(
     const LlvmOfflineCache::FieldCacheData &field_cache_data,
     uint64 *result_buffer) {
+  wait_for_cpu_launches();
   auto *const runtime_jit = get_runtime_jit_module();
   // By the time this creator is called, "this" is already destroyed.
   // Therefore it is necessary to capture members by values.
@@ -399,6 +467,9 @@ void LlvmRuntimeExecutor::initialize_llvm_runtime_snodes(
   Ptr root_buffer = snode_tree_buffer_manager_->allocate(
       runtime_jit, llvm_runtime_, rounded_size, taichi_page_size, tree_id,
       result_buffer);
+  if (arch_is_cpu(config_.arch)) {
+    apply_cpu_memory_placement(root_buffer, rounded_size);
+  }
   if (config_.arch == Arch::cuda) {
 #if defined(TI_WITH_CUDA)
     CUDADriver::get_instance().memset(root_buffer, 0, rounded_size);
@@ -411,7 +482,11 @@ void LlvmRuntimeExecutor::initialize_llvm_runtime_snodes(
 #else
     TI_NOT_IMPLEMENTED;
 #endif
-  } else {
+  } else if (config_.cpu_numa_policy != "first_touch") {
+    // With first-touch placement the pages have already been touched by the
+    // worker threads, which a memset here would undo. They read as zero
+    // anyway, since the memory pool hands out fresh pages and releases those
+    // of destroyed trees.
     std::memset(root_buffer, 0, rounded_size);
   }
 
@@ -439,12 +514,14 @@ void LlvmRuntimeExecutor::initialize_llvm_runtime_snodes(
       const auto snode_id = snode_metas[i].id;
       std::size_t node_size;
       auto element_size = snode_metas[i].cell_size_bytes;
-      if (snode_metas[i].type == SNodeType::pointer) {
-        // pointer. Allocators are for single elements
+      if (snode_metas[i].type == SNodeType::pointer ||
+          snode_metas[i].type == SNodeType::hash) {
+        // pointer and hash. Allocators are for single elements
         node_size = element_size;
       } else {
-        // dynamic. Allocators are for the chunks
-        node_size = sizeof(void *) + element_size * snode_metas[i].chunk_size;
+        // dynamic. Allocators are for the chunks, which are indexed by a
+        // per-node chunk directory and need no header.
+        node_size = element_size * snode_metas[i].chunk_size;
       }
       TI_TRACE("Initializing allocator for snode {} (node size {})", snode_id,
                node_size);
@@ -467,22 +544,48 @@ LlvmDevice *LlvmRuntimeExecutor::llvm_device() {
 DeviceAllocation LlvmRuntimeExecutor::allocate_memory_ndarray(
     std::size_t alloc_size,
     uint64 *result_buffer) {
-  return llvm_device()->allocate_memory_runtime(
+  auto alloc = llvm_device()->allocate_memory_runtime(
       {{alloc_size, /*host_write=*/false, /*host_read=*/false,
         /*export_sharing=*/false, AllocUsage::Storage},
        config_.ndarray_use_cached_allocator,
        get_runtime_jit_module(),
        get_llvm_runtime(),
        result_buffer});
+  if (arch_is_cpu(config_.arch)) {
+    apply_cpu_memory_placement(get_ndarray_alloc_info_ptr(alloc), alloc_size);
+  }
+  return alloc;
+}
+
+void LlvmRuntimeExecutor::apply_cpu_memory_placement(void *ptr,
+                                                     std::size_t size) {
+  if (config_.cpu_huge_pages || config_.cpu_numa_policy == "interleave") {
+    MemoryPool::advise_placement(ptr, size, config_.cpu_huge_pages,
+                                 config_.cpu_numa_policy == "interleave");
+  }
+  if (config_.cpu_numa_policy == "first_touch") {
+    // The thread pool must not be running a kernel at the same time
+    wait_for_cpu_launches();
+    int num_threads = std::max(config_.cpu_max_num_threads, 1);
+    FirstTouchContext ctx{(char *)ptr, size, num_threads};
+    if (work_stealing_thread_pool_) {
+      work_stealing_thread_pool_->run(num_threads, num_threads, &ctx,
+                                      first_touch_slice);
+    } else {
+      thread_pool_->run(num_threads, num_threads, &ctx, first_touch_slice);
+    }
+  }
 }
 
 void LlvmRuntimeExecutor::deallocate_memory_ndarray(DeviceAllocation handle) {
+  wait_for_cpu_launches();
   llvm_device()->dealloc_memory(handle);
 }
 
 void LlvmRuntimeExecutor::fill_ndarray(const DeviceAllocation &alloc,
                                        std::size_t size,
                                        uint32_t data) {
+  wait_for_cpu_launches();
   auto ptr = get_ndarray_alloc_info_ptr(alloc);
   if (config_.arch == Arch::cuda) {
 #if defined(TI_WITH_CUDA)
@@ -530,6 +633,7 @@ uint64_t *LlvmRuntimeExecutor::get_ndarray_alloc_info_ptr(
 }
 
 void LlvmRuntimeExecutor::finalize() {
+  wait_for_cpu_launches();
   profiler_ = nullptr;
   if (preallocated_device_buffer_ != nullptr) {
     if (config_.arch == Arch::cuda || config_.arch == Arch::amdgpu) {
@@ -679,13 +783,24 @@ void LlvmRuntimeExecutor::materialize_runtime(KernelProfilerBase *profiler,
   }
 
   if (arch_use_host_memory(config_.arch)) {
-    runtime_jit->call<void *, void *, void *>(
-        "LLVMRuntime_initialize_thread_pool", llvm_runtime_, thread_pool_.get(),
-        (void *)ThreadPool::static_run);
+    if (work_stealing_thread_pool_) {
+      runtime_jit->call<void *, void *, void *>(
+          "LLVMRuntime_initialize_thread_pool", llvm_runtime_,
+          work_stealing_thread_pool_.get(),
+          (void *)WorkStealingThreadPool::static_run);
+    } else {
+      runtime_jit->call<void *, void *, void *>(
+          "LLVMRuntime_initialize_thread_pool", llvm_runtime_,
+          thread_pool_.get(), (void *)ThreadPool::static_run);
+    }
 
     runtime_jit->call<void *, void *>("LLVMRuntime_set_assert_failed",
                                       llvm_runtime_,
                                       (void *)assert_failed_host);
+
+    runtime_jit->call<void *, void *>("LLVMRuntime_set_host_get_time_ns",
+                                      llvm_runtime_,
+                                      (void *)host_get_time_ns);
   }
   if (arch_is_cpu(config_.arch) && (profiler != nullptr)) {
     // Profiler functions can only be called on CPU kernels
@@ -705,6 +820,7 @@ void LlvmRuntimeExecutor::materialize_runtime(KernelProfilerBase *profiler,
 }
 
 void LlvmRuntimeExecutor::destroy_snode_tree(SNodeTree *snode_tree) {
+  wait_for_cpu_launches();
   get_llvm_context()->delete_snode_tree(snode_tree->id());
   snode_tree_buffer_manager_->destroy(snode_tree);
 }
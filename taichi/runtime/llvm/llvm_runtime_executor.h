@@ -62,10 +62,23 @@ class LlvmRuntimeExecutor {
     return config_;
   }
 
+  // Returns the queue that CPU kernel launches are deferred to, or nullptr if
+  // they run synchronously on the calling thread.
+  SerialTaskQueue *get_cpu_launch_queue() {
+    return cpu_launch_queue_.get();
+  }
+
+  // Waits until the deferred CPU kernel launches have finished. Everything
+  // that touches the runtime or device memory from the host must call this
+  // first.
+  void wait_for_cpu_launches();
+
   TaichiLLVMContext *get_llvm_context();
 
   JITModule *create_jit_module(std::unique_ptr<llvm::Module> module);
 
+  JITModule *create_jit_module_from_object(const std::string &object_code);
+
   JITModule *get_runtime_jit_module();
 
   LLVMRuntime *get_llvm_runtime();
@@ -110,6 +123,7 @@ class LlvmRuntimeExecutor {
                   uint64 *result_buffer,
                   Args &&...args) {
     TI_ASSERT(arch_uses_llvm(config_.arch));
+    wait_for_cpu_launches();
 
     auto runtime = get_runtime_jit_module();
     runtime->call<void *>("runtime_" + key, llvm_runtime_,
@@ -131,6 +145,11 @@ class LlvmRuntimeExecutor {
   void init_runtime_jit_module(std::unique_ptr<llvm::Module> module);
 
  private:
+  // Applies cpu_huge_pages and cpu_numa_policy to freshly allocated memory.
+  // With first-touch placement, the worker threads touch one contiguous slice
+  // of the pages each.
+  void apply_cpu_memory_placement(void *ptr, std::size_t size);
+
   CompileConfig &config_;
 
   // TODO(zhanlue): compile - runtime split for TaichiLLVMContext
@@ -142,6 +161,10 @@ class LlvmRuntimeExecutor {
   void *llvm_runtime_{nullptr};
 
   std::unique_ptr<ThreadPool> thread_pool_{nullptr};
+  std::unique_ptr<WorkStealingThreadPool> work_stealing_thread_pool_{nullptr};
+  // Declared after the thread pools so that it is destroyed, and its pending
+  // launches are finished, before them.
+  std::unique_ptr<SerialTaskQueue> cpu_launch_queue_{nullptr};
   std::shared_ptr<Device> device_{nullptr};
 
   std::unique_ptr<SNodeTreeBufferManager> snode_tree_buffer_manager_{nullptr};
@@ -1,11 +1,37 @@
 #pragma once
 
+// The chunks of a dynamic node are indexed by a chunk directory so that
+// accessing element i takes constant time regardless of the list length.
+// Segment k of the directory holds the pointers to chunks
+// [4 * (2^k - 1), 4 * (2^(k + 1) - 1)), so that a node with c chunks uses
+// fewer than 2c + 4 chunk pointers. The directory is sized for the maximum
+// number of chunks and taken on the first activation of the node; its
+// segments are allocated when first needed. Neither is replaced while the
+// node is active, so lock-free readers never hold a stale pointer and growing
+// a list leaves no garbage behind. Chunks are always allocated as a prefix,
+// i.e. if chunk k is allocated then so are chunks 0..k-1.
+// On deactivation the node gives its directory up, segments included, in the
+// same way a rehash retires a hash table: the directory becomes reusable by
+// other nodes of the SNode after the next gc.
+struct DynamicChunkDirectory {
+  DynamicChunkDirectory *next;
+  i64 num_segments;
+  // Chunks [0, num_chunks) are allocated
+  i64 num_chunks;
+
+  Ptr **segments() {
+    return (Ptr **)(this + 1);
+  }
+};
+
 struct DynamicNode {
   i32 lock;
   i32 n;
-  Ptr ptr;
+  DynamicChunkDirectory *directory;
 };
 
+constexpr i64 taichi_dynamic_first_segment_num_chunks = 4;
+
 // Specialized Attributes and functions
 struct DynamicMeta : public StructMeta {
   int chunk_size;
@@ -13,31 +39,147 @@ struct DynamicMeta : public StructMeta {
 
 STRUCT_FIELD(DynamicMeta, chunk_size);
 
+// Returns the directory segment holding chunk `chunk_id` and stores the
+// position of the chunk in the segment to `offset`.
+i64 dynamic_chunk_segment(i64 chunk_id, i64 *offset) {
+  constexpr auto n0 = taichi_dynamic_first_segment_num_chunks;
+  i64 k = 63 - __builtin_clzll((u64)(chunk_id / n0 + 1));
+  *offset = chunk_id - n0 * ((1ll << k) - 1);
+  return k;
+}
+
+i64 dynamic_max_num_chunks(DynamicMeta *meta) {
+  return (meta->max_num_elements + meta->chunk_size - 1) / meta->chunk_size;
+}
+
+Ptr dynamic_node_get_chunk(DynamicNode *node, int chunk_id) {
+  auto directory = *(DynamicChunkDirectory *volatile *)&node->directory;
+  if (directory == nullptr) {
+    return nullptr;
+  }
+  i64 offset;
+  auto k = dynamic_chunk_segment(chunk_id, &offset);
+  if (k >= directory->num_segments) {
+    return nullptr;
+  }
+  auto segment = *(Ptr *volatile *)&directory->segments()[k];
+  if (segment == nullptr) {
+    return nullptr;
+  }
+  return *(volatile Ptr *)&segment[offset];
+}
+
+// Takes a directory reclaimed by the gc of the SNode, or allocates a new one.
+// Reclaimed directories keep their segments, whose chunk pointers are null.
+DynamicChunkDirectory *dynamic_directory_allocate(DynamicMeta *meta) {
+  auto rt = meta->context->runtime;
+  DynamicChunkDirectory *directory = nullptr;
+  locked_task(&rt->dynamic_directories_lock, [&] {
+    directory = (DynamicChunkDirectory *)
+                    rt->dynamic_free_directories[meta->snode_id];
+    if (directory != nullptr) {
+      rt->dynamic_free_directories[meta->snode_id] = (Ptr)directory->next;
+    }
+  });
+  if (directory == nullptr) {
+    i64 unused;
+    auto num_segments =
+        dynamic_chunk_segment(dynamic_max_num_chunks(meta) - 1, &unused) + 1;
+    directory = (DynamicChunkDirectory *)rt->request_allocate_aligned(
+        sizeof(DynamicChunkDirectory) + sizeof(Ptr *) * num_segments, 64);
+    directory->num_segments = num_segments;
+    for (i64 k = 0; k < num_segments; k++) {
+      directory->segments()[k] = nullptr;
+    }
+  }
+  directory->next = nullptr;
+  directory->num_chunks = 0;
+  return directory;
+}
+
+void dynamic_directory_retire(DynamicMeta *meta,
+                              DynamicChunkDirectory *directory) {
+  auto rt = meta->context->runtime;
+  locked_task(&rt->dynamic_directories_lock, [&] {
+    directory->next = (DynamicChunkDirectory *)
+                          rt->dynamic_retired_directories[meta->snode_id];
+    rt->dynamic_retired_directories[meta->snode_id] = (Ptr)directory;
+  });
+}
+
+// Makes the retired directories of an SNode reusable. Called by the gc of the
+// SNode, when no task can hold a pointer to them any more.
+void dynamic_directories_gc(LLVMRuntime *runtime, int snode_id) {
+  auto retired =
+      (DynamicChunkDirectory *)runtime->dynamic_retired_directories[snode_id];
+  while (retired != nullptr) {
+    auto next = retired->next;
+    retired->next =
+        (DynamicChunkDirectory *)runtime->dynamic_free_directories[snode_id];
+    runtime->dynamic_free_directories[snode_id] = (Ptr)retired;
+    retired = next;
+  }
+  runtime->dynamic_retired_directories[snode_id] = nullptr;
+}
+
+// Makes sure chunks 0..chunk_id are allocated and returns chunk `chunk_id`, or
+// nullptr if the chunk is past the maximum number of elements.
+Ptr dynamic_node_touch_chunk(DynamicMeta *meta,
+                             DynamicNode *node,
+                             int chunk_id) {
+  auto chunk = dynamic_node_get_chunk(node, chunk_id);
+  if (chunk != nullptr) {
+    return chunk;
+  }
+  auto rt = meta->context->runtime;
+  auto max_num_chunks = dynamic_max_num_chunks(meta);
+  if (chunk_id >= max_num_chunks) {
+    taichi_assert_runtime(rt, false, "Dynamic SNode overflow.");
+    return nullptr;
+  }
+  locked_task(
+      Ptr(&node->lock),
+      [&] {
+        auto directory = node->directory;
+        if (directory == nullptr) {
+          directory = dynamic_directory_allocate(meta);
+          atomic_exchange_u64((u64 *)&node->directory, (u64)directory);
+        }
+        auto alloc = rt->node_allocators[meta->snode_id];
+        for (i64 c = directory->num_chunks; c <= chunk_id; c++) {
+          i64 offset;
+          auto k = dynamic_chunk_segment(c, &offset);
+          auto segment = directory->segments()[k];
+          if (segment == nullptr) {
+            // The last segment only covers the chunks up to the maximum
+            auto capacity =
+                std::min(taichi_dynamic_first_segment_num_chunks << k,
+                         max_num_chunks - (c - offset));
+            segment = (Ptr *)rt->request_allocate_aligned(
+                sizeof(Ptr) * capacity, 64);
+            for (i64 j = 0; j < capacity; j++) {
+              segment[j] = nullptr;
+            }
+            atomic_exchange_u64((u64 *)&directory->segments()[k],
+                                (u64)segment);
+          }
+          atomic_exchange_u64(
+              (u64 *)&segment[offset],
+              (u64)alloc->allocate(node_allocator_thread_id(meta->context)));
+          directory->num_chunks = c + 1;
+        }
+      },
+      [&]() { return dynamic_node_get_chunk(node, chunk_id) == nullptr; });
+  return dynamic_node_get_chunk(node, chunk_id);
+}
+
 void Dynamic_activate(Ptr meta_, Ptr node_, int i) {
   auto meta = (DynamicMeta *)(meta_);
   auto node = (DynamicNode *)(node_);
   // We need to not only update node->n, but also make sure the chunk containing
   // element i is allocated.
   atomic_max_i32(&node->n, i + 1);
-  int chunk_start = 0;
-  auto p_chunk_ptr = &node->ptr;
-  auto chunk_size = meta->chunk_size;
-  while (true) {
-    if (*p_chunk_ptr == nullptr) {
-      locked_task(Ptr(&node->lock), [&] {
-        if (*p_chunk_ptr == nullptr) {
-          auto rt = meta->context->runtime;
-          auto alloc = rt->node_allocators[meta->snode_id];
-          *p_chunk_ptr = alloc->allocate();
-        }
-      });
-    }
-    if (i < chunk_start + chunk_size) {
-      return;
-    }
-    p_chunk_ptr = (Ptr *)*p_chunk_ptr;
-    chunk_start += chunk_size;
-  }
+  dynamic_node_touch_chunk(meta, node, i / meta->chunk_size);
 }
 
 void Dynamic_deactivate(Ptr meta_, Ptr node_) {
@@ -46,14 +188,21 @@ void Dynamic_deactivate(Ptr meta_, Ptr node_) {
   if (node->n > 0) {
     locked_task(Ptr(&node->lock), [&] {
       node->n = 0;
-      auto p_chunk_ptr = &node->ptr;
+      auto directory = node->directory;
+      if (directory == nullptr) {
+        return;
+      }
       auto rt = meta->context->runtime;
       auto alloc = rt->node_allocators[meta->snode_id];
-      while (*p_chunk_ptr) {
-        alloc->recycle(*p_chunk_ptr);
-        p_chunk_ptr = (Ptr *)*p_chunk_ptr;
+      auto thread_id = node_allocator_thread_id(meta->context);
+      for (i64 c = 0; c < directory->num_chunks; c++) {
+        i64 offset;
+        auto segment = directory->segments()[dynamic_chunk_segment(c, &offset)];
+        alloc->recycle(segment[offset], thread_id);
+        segment[offset] = nullptr;
       }
-      node->ptr = nullptr;
+      atomic_exchange_u64((u64 *)&node->directory, 0);
+      dynamic_directory_retire(meta, directory);
     });
   }
 }
@@ -64,27 +213,11 @@ Ptr Dynamic_allocate(Ptr meta_, Ptr node_, i32 *len) {
   auto chunk_size = meta->chunk_size;
   auto i = atomic_add_i32(&node->n, 1);
   *len = i;
-  int chunk_start = 0;
-  auto p_chunk_ptr = &node->ptr;
-  while (true) {
-    if (*p_chunk_ptr == nullptr) {
-      locked_task(Ptr(&node->lock), [&] {
-        if (*p_chunk_ptr == nullptr) {
-          auto rt = meta->context->runtime;
-          auto alloc = rt->node_allocators[meta->snode_id];
-          *p_chunk_ptr = alloc->allocate();
-        }
-      });
-    }
-    if (i < chunk_start + chunk_size) {
-      return *p_chunk_ptr + sizeof(Ptr) +
-             (i - chunk_start) * meta->element_size;
-    }
-    p_chunk_ptr = (Ptr *)(*p_chunk_ptr);
-    chunk_start += chunk_size;
+  auto chunk = dynamic_node_touch_chunk(meta, node, i / chunk_size);
+  if (chunk == nullptr) {
+    return (meta->context->runtime)->ambient_elements[meta->snode_id];
   }
-  // Unreachable
-  return nullptr;
+  return chunk + (i % chunk_size) * meta->element_size;
 }
 
 i32 Dynamic_is_active(Ptr meta_, Ptr node_, int i) {
@@ -96,21 +229,14 @@ Ptr Dynamic_lookup_element(Ptr meta_, Ptr node_, int i) {
   auto meta = (DynamicMeta *)(meta_);
   auto node = (DynamicNode *)(node_);
   if (Dynamic_is_active(meta_, node_, i)) {
-    int chunk_start = 0;
-    auto chunk_ptr = node->ptr;
     auto chunk_size = meta->chunk_size;
-    while (true) {
-      if (i < chunk_start + chunk_size) {
-        auto addr =
-            chunk_ptr + sizeof(Ptr) + (i - chunk_start) * meta->element_size;
-        return addr;
-      }
-      chunk_ptr = *(Ptr *)chunk_ptr;
-      chunk_start += chunk_size;
+    auto chunk = dynamic_node_get_chunk(node, i / chunk_size);
+    // The chunk might not be allocated yet if another thread is activating it
+    if (chunk != nullptr) {
+      return chunk + (i % chunk_size) * meta->element_size;
     }
-  } else {
-    return (meta->context->runtime)->ambient_elements[meta->snode_id];
   }
+  return (meta->context->runtime)->ambient_elements[meta->snode_id];
 }
 
 i32 Dynamic_get_num_elements(Ptr meta_, Ptr node_) {
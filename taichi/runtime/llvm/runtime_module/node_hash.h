@@ -0,0 +1,338 @@
+#pragma once
+
+// A hash node stores its active children in an open-addressing table keyed by
+// the linearized cell index, so its memory footprint scales with the number of
+// active cells instead of max_num_elements.
+//
+// Lookups are lock-free. Insertions, rehashes and deactivations are serialized
+// by the node lock. A deactivated cell keeps its slot (with a null data
+// pointer) until the slot is reused by an insertion or dropped by a rehash.
+// Tables replaced by a rehash might still be read through a stale pointer by
+// the running kernel, so they are retired and only reused after the next gc
+// of the SNode.
+//
+// A hash node must be a direct child of the root, so each hash SNode has a
+// single node, whose lock also guards the table pool of the SNode. Keys are
+// the 32-bit linearized cell indices; the struct compiler rejects hash nodes
+// with more cells than that.
+//
+// Note that the containers of a hash node are enumerated by *slot*, i.e. the
+// loop bounds of a hash node's list elements range over
+// [0, Hash_get_num_elements) and Hash_get_slot_key recovers the cell index.
+
+struct HashEntry {
+  i32 key;
+  Ptr data;
+};
+
+struct HashTable {
+  i64 capacity;
+  // Links retired and reclaimed tables of an SNode
+  HashTable *next;
+
+  HashEntry *entries() {
+    return (HashEntry *)(this + 1);
+  }
+};
+
+struct HashNode {
+  i32 lock;
+  // Number of slots holding a key, including deactivated ones
+  i32 num_used;
+  HashTable *table;
+};
+
+constexpr i32 taichi_hash_empty_key = -1;
+constexpr i64 taichi_hash_initial_capacity = 64;
+
+// Specialized Attributes and functions
+struct HashMeta : public StructMeta {
+  bool _;
+};
+
+STRUCT_FIELD(HashMeta, _);
+
+u32 hash_node_home_slot(i32 key, i64 capacity) {
+  // Fibonacci hashing spreads consecutive cell indices over the table
+  u32 h = (u32)key * 2654435769u;
+  h ^= h >> 15;
+  return h & (u32)(capacity - 1);
+}
+
+HashEntry *hash_table_find(HashTable *table, i32 key) {
+  if (table == nullptr) {
+    return nullptr;
+  }
+  auto entries = table->entries();
+  auto mask = (u32)(table->capacity - 1);
+  // The load factor is kept below 1/2, so there is always an empty slot that
+  // terminates the probe sequence.
+  for (u32 s = hash_node_home_slot(key, table->capacity);; s = (s + 1) & mask) {
+    i32 k = *(volatile i32 *)&entries[s].key;
+    if (k == key) {
+      return &entries[s];
+    }
+    if (k == taichi_hash_empty_key) {
+      return nullptr;
+    }
+  }
+}
+
+// Returns the data of an active cell, or nullptr.
+Ptr hash_table_lookup(HashTable *table, i32 key) {
+  auto entry = hash_table_find(table, key);
+  if (entry == nullptr) {
+    return nullptr;
+  }
+  auto data = *(Ptr volatile *)&entry->data;
+  // The slot of a deactivated cell might have been handed to another cell
+  // after we matched its key.
+  if (*(volatile i32 *)&entry->key != key) {
+    return nullptr;
+  }
+  return data;
+}
+
+HashTable *hash_table_allocate(StructMeta *meta, i64 capacity) {
+  auto rt = meta->context->runtime;
+  HashTable *table = nullptr;
+  for (auto p = (HashTable **)&rt->hash_free_tables[meta->snode_id];
+       *p != nullptr; p = &(*p)->next) {
+    if ((*p)->capacity == capacity) {
+      table = *p;
+      *p = table->next;
+      break;
+    }
+  }
+  if (table == nullptr) {
+    table = (HashTable *)rt->request_allocate_aligned(
+        sizeof(HashTable) + sizeof(HashEntry) * capacity, 64);
+    table->capacity = capacity;
+  }
+  table->next = nullptr;
+  auto entries = table->entries();
+  for (i64 s = 0; s < capacity; s++) {
+    entries[s].key = taichi_hash_empty_key;
+    entries[s].data = nullptr;
+  }
+  return table;
+}
+
+void hash_table_retire(StructMeta *meta, HashTable *table) {
+  auto rt = meta->context->runtime;
+  table->next = (HashTable *)rt->hash_retired_tables[meta->snode_id];
+  rt->hash_retired_tables[meta->snode_id] = (Ptr)table;
+}
+
+// Makes the retired tables of an SNode reusable. Called by the gc of the
+// SNode, when no task can hold a pointer to them any more.
+void hash_tables_gc(LLVMRuntime *runtime, int snode_id) {
+  auto retired = (HashTable *)runtime->hash_retired_tables[snode_id];
+  while (retired != nullptr) {
+    auto next = retired->next;
+    retired->next = (HashTable *)runtime->hash_free_tables[snode_id];
+    runtime->hash_free_tables[snode_id] = (Ptr)retired;
+    retired = next;
+  }
+  runtime->hash_retired_tables[snode_id] = nullptr;
+}
+
+// Returns the first slot on the probe sequence of a key that is either empty
+// or held by a deactivated cell.
+HashEntry *hash_table_free_slot(HashTable *table, i32 key) {
+  auto entries = table->entries();
+  auto mask = (u32)(table->capacity - 1);
+  auto s = hash_node_home_slot(key, table->capacity);
+  while (entries[s].key != taichi_hash_empty_key &&
+         entries[s].data != nullptr) {
+    s = (s + 1) & mask;
+  }
+  return &entries[s];
+}
+
+// Must be called with the node lock held, for a key that is not in the table.
+HashEntry *hash_node_insert(StructMeta *meta, HashNode *node, i32 key) {
+  auto table = node->table;
+  if (table != nullptr) {
+    auto entry = hash_table_free_slot(table, key);
+    if (entry->key != taichi_hash_empty_key) {
+      // Take over the slot of a deactivated cell. Lookups of that cell keep
+      // probing past it, and find no data under its key any more.
+      atomic_exchange_i32(&entry->key, key);
+      return entry;
+    }
+  }
+  if (table == nullptr || (node->num_used + 1) * 2 > table->capacity) {
+    // Rehash into a table sized for the active cells only, dropping the
+    // slots of deactivated cells.
+    i32 num_active = 0;
+    if (table != nullptr) {
+      for (i64 s = 0; s < table->capacity; s++) {
+        num_active += table->entries()[s].data != nullptr;
+      }
+    }
+    auto capacity = taichi_hash_initial_capacity;
+    while (capacity < (i64)(num_active + 1) * 4) {
+      capacity *= 2;
+    }
+    auto new_table = hash_table_allocate(meta, capacity);
+    auto new_entries = new_table->entries();
+    auto mask = (u32)(capacity - 1);
+    if (table != nullptr) {
+      for (i64 s = 0; s < table->capacity; s++) {
+        auto &entry = table->entries()[s];
+        if (entry.data == nullptr) {
+          continue;
+        }
+        auto t = hash_node_home_slot(entry.key, capacity);
+        while (new_entries[t].key != taichi_hash_empty_key) {
+          t = (t + 1) & mask;
+        }
+        new_entries[t] = entry;
+      }
+    }
+    node->num_used = num_active;
+    atomic_exchange_u64((u64 *)&node->table, (u64)new_table);
+    if (table != nullptr) {
+      hash_table_retire(meta, table);
+    }
+    table = new_table;
+  }
+  auto entry = hash_table_free_slot(table, key);
+  node->num_used += 1;
+  atomic_exchange_i32(&entry->key, key);
+  return entry;
+}
+
+i32 Hash_get_num_elements(Ptr meta, Ptr node_) {
+  auto table = ((HashNode *)node_)->table;
+  return table == nullptr ? 0 : (i32)table->capacity;
+}
+
+void Hash_activate(Ptr meta_, Ptr node_, int i) {
+  auto node = (HashNode *)node_;
+  if (hash_table_lookup(node->table, i) != nullptr) {
+    return;
+  }
+  locked_task(Ptr(&node->lock), [&] {
+    auto meta = (StructMeta *)meta_;
+    auto entry = hash_table_find(node->table, i);
+    if (entry == nullptr) {
+      entry = hash_node_insert(meta, node, i);
+    }
+    if (entry->data == nullptr) {
+      auto rt = meta->context->runtime;
+      auto alloc = rt->node_allocators[meta->snode_id];
+      auto allocated = alloc->allocate(node_allocator_thread_id(meta->context));
+      atomic_exchange_u64((u64 *)&entry->data, (u64)allocated);
+    }
+  });
+}
+
+void Hash_deactivate(Ptr meta_, Ptr node_, int i) {
+  auto node = (HashNode *)node_;
+  if (hash_table_lookup(node->table, i) == nullptr) {
+    return;
+  }
+  locked_task(Ptr(&node->lock), [&] {
+    // The table might have been rehashed before we got the lock
+    auto entry = hash_table_find(node->table, i);
+    if (entry != nullptr && entry->data != nullptr) {
+      auto meta = (StructMeta *)meta_;
+      auto rt = meta->context->runtime;
+      auto alloc = rt->node_allocators[meta->snode_id];
+      alloc->recycle(entry->data, node_allocator_thread_id(meta->context));
+      entry->data = nullptr;
+    }
+  });
+}
+
+i32 Hash_is_active(Ptr meta, Ptr node_, int i) {
+  return hash_table_lookup(((HashNode *)node_)->table, i) != nullptr;
+}
+
+Ptr Hash_lookup_element(Ptr meta, Ptr node_, int i) {
+  auto data = hash_table_lookup(((HashNode *)node_)->table, i);
+  if (data == nullptr) {
+    auto smeta = (StructMeta *)meta;
+    auto context = smeta->context;
+    return (context->runtime)->ambient_elements[smeta->snode_id];
+  }
+  return data;
+}
+
+// Slot-based accessors used when iterating over a hash node
+i32 Hash_is_slot_active(Ptr meta, Ptr node_, int slot) {
+  auto table = ((HashNode *)node_)->table;
+  return table != nullptr && slot < table->capacity &&
+         table->entries()[slot].data != nullptr;
+}
+
+i32 Hash_get_slot_key(Ptr meta, Ptr node_, int slot) {
+  auto table = ((HashNode *)node_)->table;
+  if (table == nullptr || slot >= table->capacity) {
+    return taichi_hash_empty_key;
+  }
+  return table->entries()[slot].key;
+}
+
+Ptr Hash_lookup_slot(Ptr meta, Ptr node_, int slot) {
+  auto table = ((HashNode *)node_)->table;
+  if (table == nullptr || slot >= table->capacity) {
+    return nullptr;
+  }
+  return table->entries()[slot].data;
+}
+
+// Counterpart of element_listgen_nonroot for children of a hash node, whose
+// parent list elements range over table slots instead of cell indices.
+void element_listgen_hash(LLVMRuntime *runtime,
+                          StructMeta *parent,
+                          StructMeta *child) {
+  auto parent_list = runtime->element_lists[parent->snode_id];
+  int num_parent_elements = parent_list->size();
+  auto child_list = runtime->element_lists[child->snode_id];
+  auto parent_refine_coordinates = parent->refine_coordinates;
+  auto child_get_num_elements = child->get_num_elements;
+  auto child_from_parent_element = child->from_parent_element;
+#if ARCH_cuda || ARCH_amdgpu
+  int i_start = block_idx();
+  int i_step = grid_dim();
+  int j_start = thread_idx();
+  int j_step = block_dim();
+#else
+  int i_start = 0;
+  int i_step = 1;
+  int j_start = 0;
+  int j_step = 1;
+#endif
+  for (int i = i_start; i < num_parent_elements; i += i_step) {
+    auto element = parent_list->get<Element>(i);
+    int j_lower = element.loop_bounds[0] + j_start;
+    int j_higher = element.loop_bounds[1];
+    for (int j = j_lower; j < j_higher; j += j_step) {
+      auto data = Hash_lookup_slot((Ptr)parent, element.element, j);
+      if (data == nullptr) {
+        continue;
+      }
+      PhysicalCoordinates refined_coord;
+      parent_refine_coordinates(
+          &element.pcoord, &refined_coord,
+          Hash_get_slot_key((Ptr)parent, element.element, j));
+      auto ch_element = child_from_parent_element(data);
+      auto ch_num_elements = child_get_num_elements((Ptr)child, ch_element);
+      auto ch_element_size =
+          std::min(ch_num_elements, taichi_listgen_max_element_size);
+      for (int ch_lower = 0; ch_lower < ch_num_elements;
+           ch_lower += ch_element_size) {
+        Element elem;
+        elem.element = ch_element;
+        elem.loop_bounds[0] = ch_lower;
+        elem.loop_bounds[1] =
+            std::min(ch_lower + ch_element_size, ch_num_elements);
+        elem.pcoord = refined_coord;
+        child_list->append(&elem);
+      }
+    }
+  }
+}
@@ -41,10 +41,24 @@ bool is_representative(uint32 mask, uint64 value) {
 void Pointer_activate(Ptr meta_, Ptr node, int i) {
   auto meta = (StructMeta *)meta_;
   auto num_elements = Pointer_get_num_elements(meta_, node);
-  volatile Ptr lock = node + 8 * i;
   volatile Ptr *data_ptr = (Ptr *)(node + 8 * (num_elements + i));
 
   if (*data_ptr == nullptr) {
+#if ARCH_x64 || ARCH_arm64
+    // Allocate speculatively and publish the node with a compare-exchange.
+    // The loser of a race hands its untouched node back to its thread cache.
+    auto rt = meta->context->runtime;
+    auto alloc = rt->node_allocators[meta->snode_id];
+    auto thread_id = node_allocator_thread_id(meta->context);
+    auto allocated = alloc->allocate(thread_id);
+    u64 expected = 0;
+    if (!__atomic_compare_exchange_n((u64 *)data_ptr, &expected,
+                                     (u64)allocated, false, __ATOMIC_SEQ_CST,
+                                     __ATOMIC_SEQ_CST)) {
+      alloc->release_unused(thread_id, allocated);
+    }
+#else
+    volatile Ptr lock = node + 8 * i;
     // The cuda_ calls will return 0 or do noop on CPUs
     u32 mask = cuda_active_mask();
     if (is_representative(mask, (u64)lock)) {
@@ -61,14 +75,25 @@ void Pointer_activate(Ptr meta_, Ptr node, int i) {
           [&]() { return *data_ptr == nullptr; });
     }
     warp_barrier(mask);
+#endif
   }
 }
 
 void Pointer_deactivate(Ptr meta, Ptr node, int i) {
   auto num_elements = Pointer_get_num_elements(meta, node);
-  Ptr lock = node + 8 * i;
   Ptr &data_ptr = *(Ptr *)(node + 8 * (num_elements + i));
   if (data_ptr != nullptr) {
+#if ARCH_x64 || ARCH_arm64
+    // Only the thread that swaps the node out recycles it
+    auto old = (Ptr)atomic_exchange_u64((u64 *)&data_ptr, 0);
+    if (old != nullptr) {
+      auto smeta = (StructMeta *)meta;
+      auto rt = smeta->context->runtime;
+      auto alloc = rt->node_allocators[smeta->snode_id];
+      alloc->recycle(old, node_allocator_thread_id(smeta->context));
+    }
+#else
+    Ptr lock = node + 8 * i;
     locked_task(lock, [&] {
       if (data_ptr != nullptr) {
         auto smeta = (StructMeta *)meta;
@@ -78,6 +103,7 @@ void Pointer_deactivate(Ptr meta, Ptr node, int i) {
         data_ptr = nullptr;
       }
     });
+#endif
   }
 }
 
@@ -40,7 +40,13 @@ using host_vsnprintf_type = int (*)(char *,
                                     const char *,
                                     std::va_list);
 using vm_allocator_type = void *(*)(void *, std::size_t, std::size_t);
+using host_get_time_ns_type = int64_t (*)();
 using RangeForTaskFunc = void(RuntimeContext *, const char *tls, int i);
+// Runs the indices [block_begin, block_end) of a CPU range-for
+using RangeForBlockTaskFunc = void(RuntimeContext *,
+                                   const char *tls,
+                                   int block_begin,
+                                   int block_end);
 using MeshForTaskFunc = void(RuntimeContext *, const char *tls, uint32_t i);
 using parallel_for_type = void (*)(void *thread_pool,
                                    int splits,
@@ -454,6 +460,16 @@ struct ListManager {
     return i;
   }
 
+  // Reserves n consecutive elements and returns the index of the first one.
+  i32 reserve_new_elements(i32 n) {
+    auto i = atomic_add_i32(&num_elements, n);
+    for (auto chunk_id = i >> log2chunk_num_elements;
+         chunk_id <= ((i + n - 1) >> log2chunk_num_elements); chunk_id++) {
+      touch_chunk(chunk_id);
+    }
+    return i;
+  }
+
   template <typename T>
   void push_back(const T &t) {
     this->append((void *)&t);
@@ -540,6 +556,19 @@ void initialize_rand_state(RandState *state, u32 i) {
 }
 }
 
+// Chunk size of an offloaded range-for task, tuned across its launches by
+// cpu_parallel_range_for_adaptive. The states form a set-associative cache
+// keyed by the body function of the task, in which a task that is not tracked
+// yet replaces the least recently launched task of its set. Tasks of unloaded
+// kernels are thus evicted once newer tasks need their slots, and a new task
+// whose body happens to reuse an address only starts from a stale block size,
+// which is retuned within a few launches.
+struct RangeForChunkState {
+  Ptr task;  // The body function of the task, used as the key.
+  i32 block_dim;
+  u64 last_launch;
+};
+
 struct NodeManager;
 
 struct LLVMRuntime {
@@ -553,6 +582,7 @@ struct LLVMRuntime {
   assert_failed_type assert_failed;
   host_printf_type host_printf;
   host_vsnprintf_type host_vsnprintf;
+  host_get_time_ns_type host_get_time_ns;
   Ptr memory_pool;
 
   Ptr roots[kMaxNumSnodeTreesLlvm];
@@ -564,6 +594,14 @@ struct LLVMRuntime {
   NodeManager *node_allocators[taichi_max_num_snodes];
   NodeManager *runtime_context_buffer_allocator;
   Ptr ambient_elements[taichi_max_num_snodes];
+  // Tables of hash nodes replaced by a rehash, and those reclaimed by gc
+  Ptr hash_retired_tables[taichi_max_num_snodes];
+  Ptr hash_free_tables[taichi_max_num_snodes];
+  // Chunk directories given up by deactivated dynamic nodes, and those
+  // reclaimed by gc
+  Ptr dynamic_retired_directories[taichi_max_num_snodes];
+  Ptr dynamic_free_directories[taichi_max_num_snodes];
+  i32 dynamic_directories_lock;
   Ptr temporaries;
   RandState *rand_states;
   Ptr allocate(std::size_t size);
@@ -586,6 +624,15 @@ struct LLVMRuntime {
 
   i64 total_requested_memory;
 
+  RangeForChunkState
+      range_for_chunk_states[taichi_max_num_range_for_chunk_states];
+  i32 range_for_chunk_states_lock;
+  u64 num_range_for_launches;
+  // TLS storage of CPU parallel loops too large for the stack, reused by
+  // later loops
+  Ptr cpu_tls_free_blocks;
+  i32 cpu_tls_blocks_lock;
+
   template <typename T>
   void set_result(std::size_t i, T t) {
     static_assert(sizeof(T) <= sizeof(uint64));
@@ -610,10 +657,29 @@ STRUCT_FIELD(LLVMRuntime, temporaries);
 STRUCT_FIELD(LLVMRuntime, assert_failed);
 STRUCT_FIELD(LLVMRuntime, host_printf);
 STRUCT_FIELD(LLVMRuntime, host_vsnprintf);
+STRUCT_FIELD(LLVMRuntime, host_get_time_ns);
 STRUCT_FIELD(LLVMRuntime, profiler);
 STRUCT_FIELD(LLVMRuntime, profiler_start);
 STRUCT_FIELD(LLVMRuntime, profiler_stop);
 
+// A per-thread cache (magazine) of a NodeManager. For allocation it owns a
+// contiguous range [begin, end) of either free list positions or freshly
+// reserved data list indices, so that refilling it costs a single atomic on
+// the shared counters. Recycled node indices are buffered and flushed to the
+// recycled list in batches.
+struct alignas(64) NodeAllocatorCache {
+  i32 begin;
+  i32 end;
+  i32 from_free_list;
+  i32 num_recycled;
+  // A zero-filled node handed back by an activation that lost a race
+  Ptr spare;
+  // Allocations served without / with touching the shared free list
+  i64 num_hits;
+  i64 num_misses;
+  i32 recycled[taichi_node_allocator_magazine_size];
+};
+
 // NodeManager of node S (hash, pointer) managers the memory allocation of S_ch
 // It makes use of three ListManagers.
 struct NodeManager {
@@ -627,6 +693,15 @@ struct NodeManager {
   ListManager *free_list, *recycled_list, *data_list;
   i32 recycle_list_size_backup;
 
+  // The free list entries from this position on were put there by
+  // gc_incremental without being zero-filled. They are zero-filled when they
+  // are allocated.
+  i32 zero_fill_begin;
+
+  // Number of nodes a thread cache grabs at once
+  i32 cache_batch_size;
+  NodeAllocatorCache caches[taichi_max_num_node_allocator_caches];
+
   using list_data_type = i32;
 
   NodeManager(LLVMRuntime *runtime,
@@ -644,12 +719,16 @@ struct NodeManager {
     }
     this->chunk_num_elements = chunk_num_elements;
     free_list_used = 0;
+    zero_fill_begin = std::numeric_limits<i32>::max();
     free_list = runtime->create<ListManager>(runtime, sizeof(list_data_type),
                                              chunk_num_elements);
     recycled_list = runtime->create<ListManager>(
         runtime, sizeof(list_data_type), chunk_num_elements);
     data_list =
         runtime->create<ListManager>(runtime, element_size, chunk_num_elements);
+    // Keep at most 64 KB of nodes in each thread cache
+    cache_batch_size = max_i32(1, min_i32(32, 65536 / element_size));
+    std::memset(caches, 0, sizeof(caches));
   }
 
   Ptr allocate() {
@@ -661,10 +740,113 @@ struct NodeManager {
     } else {
       // reuse
       l = free_list->get<list_data_type>(old_cursor);
+      if (old_cursor >= zero_fill_begin) {
+        auto ptr = data_list->get_element_ptr(l);
+        std::memset(ptr, 0, element_size);
+        return ptr;
+      }
     }
     return data_list->get_element_ptr(l);
   }
 
+  // Allocates through the cache of the calling CPU thread, touching the shared
+  // counters only once every cache_batch_size allocations.
+  Ptr allocate(i32 thread_id) {
+    if (thread_id < 0 || thread_id >= taichi_max_num_node_allocator_caches) {
+      return allocate();
+    }
+    auto &cache = caches[thread_id];
+    if (cache.spare != nullptr) {
+      auto ptr = cache.spare;
+      cache.spare = nullptr;
+      cache.num_hits++;
+      return ptr;
+    }
+    if (cache.begin == cache.end) {
+      cache.num_misses++;
+      int old_cursor = atomic_add_i32(&free_list_used, cache_batch_size);
+      int free_list_size = free_list->size();
+      if (old_cursor < free_list_size) {
+        cache.begin = old_cursor;
+        cache.end = min_i32(old_cursor + cache_batch_size, free_list_size);
+        cache.from_free_list = 1;
+      } else {
+        cache.begin = data_list->reserve_new_elements(cache_batch_size);
+        cache.end = cache.begin + cache_batch_size;
+        cache.from_free_list = 0;
+      }
+    } else {
+      cache.num_hits++;
+    }
+    auto i = cache.begin++;
+    if (!cache.from_free_list) {
+      return data_list->get_element_ptr(i);
+    }
+    auto ptr = data_list->get_element_ptr(free_list->get<list_data_type>(i));
+    if (i >= zero_fill_begin) {
+      std::memset(ptr, 0, element_size);
+    }
+    return ptr;
+  }
+
+  // Returns a node that was allocated but never written to the thread cache.
+  void release_unused(i32 thread_id, Ptr ptr) {
+    if (thread_id < 0 || thread_id >= taichi_max_num_node_allocator_caches ||
+        caches[thread_id].spare != nullptr) {
+      recycle(ptr, thread_id);
+    } else {
+      caches[thread_id].spare = ptr;
+    }
+  }
+
+  // Puts the nodes held by thread caches back to the free list. Must be called
+  // when no kernel is allocating from this manager.
+  void flush_caches() {
+    // Cache refills may have moved the cursor past the end of the free list.
+    // Clamp it so that the nodes appended below survive the compaction.
+    free_list_used = min_i32(free_list_used, free_list->size());
+    for (int t = 0; t < taichi_max_num_node_allocator_caches; t++) {
+      auto &cache = caches[t];
+      for (int i = cache.begin; i < cache.end; i++) {
+        auto l = cache.from_free_list ? free_list->get<list_data_type>(i) : i;
+        free_list->push_back(l);
+      }
+      if (cache.spare != nullptr) {
+        free_list->push_back(locate(cache.spare));
+      }
+      cache.begin = cache.end = 0;
+      cache.spare = nullptr;
+      flush_recycled(cache);
+    }
+  }
+
+  void flush_recycled(NodeAllocatorCache &cache) {
+    if (cache.num_recycled == 0) {
+      return;
+    }
+    auto l = recycled_list->reserve_new_elements(cache.num_recycled);
+    for (int k = 0; k < cache.num_recycled; k++) {
+      recycled_list->get<list_data_type>(l + k) = cache.recycled[k];
+    }
+    cache.num_recycled = 0;
+  }
+
+  i64 get_num_cache_hits() {
+    i64 sum = 0;
+    for (int t = 0; t < taichi_max_num_node_allocator_caches; t++) {
+      sum += caches[t].num_hits;
+    }
+    return sum;
+  }
+
+  i64 get_num_cache_misses() {
+    i64 sum = 0;
+    for (int t = 0; t < taichi_max_num_node_allocator_caches; t++) {
+      sum += caches[t].num_misses;
+    }
+    return sum;
+  }
+
   i32 locate(Ptr ptr) {
     return data_list->ptr2index(ptr);
   }
@@ -674,7 +856,32 @@ struct NodeManager {
     recycled_list->append(&index);
   }
 
+  // Recycles through the magazine of the calling CPU thread.
+  void recycle(Ptr ptr, i32 thread_id) {
+    if (thread_id < 0 || thread_id >= taichi_max_num_node_allocator_caches) {
+      recycle(ptr);
+      return;
+    }
+    auto &cache = caches[thread_id];
+    cache.recycled[cache.num_recycled++] = locate(ptr);
+    if (cache.num_recycled == taichi_node_allocator_magazine_size) {
+      flush_recycled(cache);
+    }
+  }
+
+  // Zero-fills the nodes at [begin, end) of the free list that gc_incremental
+  // has not zero-filled.
+  void zero_fill_free_nodes(i32 begin, i32 end) {
+    for (int i = max_i32(begin, zero_fill_begin); i < end; i++) {
+      auto ptr = data_list->get_element_ptr(free_list->get<list_data_type>(i));
+      std::memset(ptr, 0, element_size);
+    }
+  }
+
   void gc_serial() {
+    flush_caches();
+    zero_fill_free_nodes(free_list_used, free_list->size());
+    zero_fill_begin = std::numeric_limits<i32>::max();
     // compact free list
     for (int i = free_list_used; i < free_list->size(); i++) {
       free_list->get<list_data_type>(i - free_list_used) =
@@ -693,8 +900,50 @@ struct NodeManager {
     }
     recycled_list->clear();
   }
+
+  // Reclaims at most max(budget, 1/8 of the backlog) recycled nodes, leaving
+  // the rest to later calls. Reclaimed nodes are zero-filled on re-allocation
+  // instead of here, so the cost is bounded by the budget and the number of
+  // allocations since the last gc. The nodes the previous call reclaimed but
+  // nothing allocated are zero-filled here, which keeps the nodes that need
+  // it at the end of the free list.
+  void gc_incremental(i32 budget) {
+    flush_caches();
+    zero_fill_free_nodes(free_list_used, free_list->size());
+
+    // Drop the consumed prefix of the free list. The order of free nodes does
+    // not matter, so only the smaller of the two parts has to move.
+    auto size = free_list->size();
+    auto used = min_i32(free_list_used, size);
+    auto num_unused = size - used;
+    auto num_moved = min_i32(used, num_unused);
+    for (int i = 0; i < num_moved; i++) {
+      free_list->get<list_data_type>(i) =
+          free_list->get<list_data_type>(size - num_moved + i);
+    }
+    free_list_used = 0;
+    free_list->resize(num_unused);
+
+    auto num_recycled = recycled_list->size();
+    auto n = min_i32(num_recycled, max_i32(budget, num_recycled / 8));
+    zero_fill_begin = n > 0 ? num_unused : std::numeric_limits<i32>::max();
+    for (int i = num_recycled - n; i < num_recycled; i++) {
+      free_list->push_back(recycled_list->get<list_data_type>(i));
+    }
+    recycled_list->resize(num_recycled - n);
+  }
 };
 
+// Selects the NodeManager thread cache used by the calling thread. GPU threads
+// go through the shared lists.
+i32 node_allocator_thread_id(RuntimeContext *context) {
+#if ARCH_x64 || ARCH_arm64
+  return context->cpu_thread_id;
+#else
+  return -1;
+#endif
+}
+
 extern "C" {
 
 void RuntimeContext_store_result(RuntimeContext *ctx, u64 ret, u32 idx) {
@@ -735,6 +984,18 @@ void runtime_ListManager_get_num_active_chunks(LLVMRuntime *runtime,
                       list_manager->get_num_active_chunks());
 }
 
+void runtime_NodeManager_get_num_cache_hits(LLVMRuntime *runtime,
+                                            NodeManager *node_manager) {
+  runtime->set_result(taichi_result_buffer_runtime_query_id,
+                      node_manager->get_num_cache_hits());
+}
+
+void runtime_NodeManager_get_num_cache_misses(LLVMRuntime *runtime,
+                                              NodeManager *node_manager) {
+  runtime->set_result(taichi_result_buffer_runtime_query_id,
+                      node_manager->get_num_cache_misses());
+}
+
 RUNTIME_STRUCT_FIELD_ARRAY(LLVMRuntime, node_allocators);
 RUNTIME_STRUCT_FIELD_ARRAY(LLVMRuntime, element_lists);
 RUNTIME_STRUCT_FIELD(LLVMRuntime, total_requested_memory);
@@ -915,6 +1176,22 @@ void runtime_initialize(
   runtime->memory_pool = memory_pool;
 
   runtime->total_requested_memory = 0;
+  runtime->host_get_time_ns = nullptr;
+  std::memset(runtime->range_for_chunk_states, 0,
+              sizeof(runtime->range_for_chunk_states));
+  runtime->range_for_chunk_states_lock = 0;
+  runtime->num_range_for_launches = 0;
+  runtime->cpu_tls_free_blocks = nullptr;
+  runtime->cpu_tls_blocks_lock = 0;
+  std::memset(runtime->hash_retired_tables, 0,
+              sizeof(runtime->hash_retired_tables));
+  std::memset(runtime->hash_free_tables, 0,
+              sizeof(runtime->hash_free_tables));
+  std::memset(runtime->dynamic_retired_directories, 0,
+              sizeof(runtime->dynamic_retired_directories));
+  std::memset(runtime->dynamic_free_directories, 0,
+              sizeof(runtime->dynamic_free_directories));
+  runtime->dynamic_directories_lock = 0;
 
   runtime->temporaries = (Ptr)runtime->allocate_aligned(
       taichi_global_tmp_buffer_size, taichi_page_size);
@@ -1330,6 +1607,137 @@ void element_listgen_nonroot(LLVMRuntime *runtime,
 }
 
 using BlockTask = void(RuntimeContext *, char *, Element *, int, int);
+using range_for_xlogue = void (*)(RuntimeContext *, /*TLS*/ char *tls_base);
+using mesh_for_xlogue = void (*)(RuntimeContext *,
+                                 /*TLS*/ char *tls_base,
+                                 uint32_t patch_idx);
+
+// The thread-local storage of a parallel loop on CPU lives with the threads
+// instead of the blocks: a thread runs the TLS prologue on its buffer before
+// its first block, and the TLS epilogue of every buffer runs once all the
+// blocks have finished. E.g. a reduction flushes its partial result to the
+// destination once per thread, not once per block.
+//
+// The schedulers only pass thread ids in [0, num_threads).
+struct cpu_thread_local_storage {
+  RuntimeContext *context;
+  range_for_xlogue prologue{nullptr};
+  range_for_xlogue epilogue{nullptr};
+  char *buffers{nullptr};
+  // Buffers are a multiple of the cache line size apart, so that threads
+  // updating their own buffers don't share cache lines.
+  std::size_t stride{0};
+  i32 *initialized{nullptr};
+
+  char *get(int thread_id) {
+    auto buffer = buffers + thread_id * stride;
+    if (!initialized[thread_id]) {
+      if (prologue)
+        prologue(context, buffer);
+      initialized[thread_id] = 1;
+    }
+    return buffer;
+  }
+};
+
+constexpr std::size_t kCpuCacheLineSize = 64;
+// TLS storage up to this size lives on the stack of the launching thread
+constexpr std::size_t kCpuTlsStackStorageSize = 4096;
+
+// TLS storage of a CPU parallel loop which does not fit on the stack. The
+// runtime allocator can't free, so a finished loop returns its block to
+// LLVMRuntime::cpu_tls_free_blocks, from which later loops take theirs.
+struct alignas(kCpuCacheLineSize) cpu_tls_block {
+  cpu_tls_block *next;
+  // Bytes of storage following the header
+  std::size_t size;
+
+  char *storage() {
+    return (char *)(this + 1);
+  }
+};
+
+cpu_tls_block *acquire_cpu_tls_block(LLVMRuntime *runtime, std::size_t size) {
+  cpu_tls_block *block = nullptr;
+  locked_task(&runtime->cpu_tls_blocks_lock, [&] {
+    for (auto p = (cpu_tls_block **)&runtime->cpu_tls_free_blocks;
+         *p != nullptr; p = &(*p)->next) {
+      if ((*p)->size >= size) {
+        block = *p;
+        *p = block->next;
+        break;
+      }
+    }
+  });
+  if (block == nullptr) {
+    // Powers of two keep the number of distinct blocks small
+    auto capacity = kCpuTlsStackStorageSize;
+    while (capacity < size) {
+      capacity *= 2;
+    }
+    block = (cpu_tls_block *)runtime->request_allocate_aligned(
+        sizeof(cpu_tls_block) + capacity, kCpuCacheLineSize);
+    block->size = capacity;
+  }
+  return block;
+}
+
+void release_cpu_tls_block(LLVMRuntime *runtime, cpu_tls_block *block) {
+  locked_task(&runtime->cpu_tls_blocks_lock, [&] {
+    block->next = (cpu_tls_block *)runtime->cpu_tls_free_blocks;
+    runtime->cpu_tls_free_blocks = (Ptr)block;
+  });
+}
+
+// Runs |func| on |num_tasks| tasks on the thread pool, with |tls| backed by
+// buffers on the stack of the calling thread, or in a block of the runtime if
+// they don't fit. |task_context| is passed to |func| and usually holds |tls|.
+void cpu_parallel_for_with_tls(RuntimeContext *context,
+                               int num_tasks,
+                               int num_threads,
+                               void *task_context,
+                               void (*func)(void *, int thread_id, int i),
+                               cpu_thread_local_storage *tls,
+                               range_for_xlogue prologue,
+                               range_for_xlogue epilogue,
+                               std::size_t tls_size) {
+  num_threads = std::max(num_threads, 1);
+  auto stride = std::max((tls_size + kCpuCacheLineSize - 1) /
+                             kCpuCacheLineSize * kCpuCacheLineSize,
+                         kCpuCacheLineSize);
+  // The buffers, followed by the flags telling which ones are initialized
+  auto storage_size = num_threads * (stride + sizeof(i32));
+  auto runtime = context->runtime;
+  alignas(kCpuCacheLineSize) char stack_storage[kCpuTlsStackStorageSize];
+  cpu_tls_block *block = nullptr;
+  char *storage = stack_storage;
+  if (storage_size > kCpuTlsStackStorageSize) {
+    block = acquire_cpu_tls_block(runtime, storage_size);
+    storage = block->storage();
+  }
+  auto initialized = (i32 *)(storage + num_threads * stride);
+  for (int i = 0; i < num_threads; i++) {
+    initialized[i] = 0;
+  }
+  tls->context = context;
+  tls->prologue = prologue;
+  tls->epilogue = epilogue;
+  tls->buffers = storage;
+  tls->stride = stride;
+  tls->initialized = initialized;
+  runtime->parallel_for(runtime->thread_pool, num_tasks, num_threads,
+                        task_context, func);
+  if (epilogue) {
+    for (int i = 0; i < num_threads; i++) {
+      if (initialized[i]) {
+        epilogue(context, tls->buffers + i * stride);
+      }
+    }
+  }
+  if (block != nullptr) {
+    release_cpu_tls_block(runtime, block);
+  }
+}
 
 struct cpu_block_task_helper_context {
   RuntimeContext *context;
@@ -1337,16 +1745,13 @@ struct cpu_block_task_helper_context {
   ListManager *list;
   int element_size;
   int element_split;
-  std::size_t tls_buffer_size;
+  cpu_thread_local_storage tls;
 };
 
 // TODO: To enforce inlining, we need to create in LLVM a new function that
 // calls block_helper and the BLS xlogues, and pass that function to the
 // scheduler.
 
-// TODO: TLS should be directly passed to the scheduler, so that it lives
-// with the threads (instead of blocks).
-
 void cpu_struct_for_block_helper(void *ctx_, int thread_id, int i) {
   auto ctx = (cpu_block_task_helper_context *)(ctx_);
   int element_id = i / ctx->element_split;
@@ -1356,16 +1761,39 @@ void cpu_struct_for_block_helper(void *ctx_, int thread_id, int i) {
   int lower = e.loop_bounds[0] + part_id * part_size;
   int upper = e.loop_bounds[0] + (part_id + 1) * part_size;
   upper = std::min(upper, e.loop_bounds[1]);
-  alignas(8) char tls_buffer[ctx->tls_buffer_size];
 
   RuntimeContext this_thread_context = *ctx->context;
   this_thread_context.cpu_thread_id = thread_id;
   if (lower < upper) {
-    (*ctx->task)(&this_thread_context, tls_buffer,
+    (*ctx->task)(&this_thread_context, ctx->tls.get(thread_id),
                  &ctx->list->get<Element>(element_id), lower, upper);
   }
 }
 
+// The CPU struct-for. Unlike parallel_struct_for, whose block task runs the
+// TLS xlogues itself, the xlogues are passed separately so that they run once
+// per thread.
+void cpu_parallel_struct_for(RuntimeContext *context,
+                             int snode_id,
+                             int element_size,
+                             int element_split,
+                             BlockTask *task,
+                             range_for_xlogue prologue,
+                             range_for_xlogue epilogue,
+                             std::size_t tls_size,
+                             int num_threads) {
+  auto list = (context->runtime)->element_lists[snode_id];
+  cpu_block_task_helper_context ctx;
+  ctx.context = context;
+  ctx.task = task;
+  ctx.list = list;
+  ctx.element_size = element_size;
+  ctx.element_split = element_split;
+  cpu_parallel_for_with_tls(context, list->size() * element_split, num_threads,
+                            &ctx, cpu_struct_for_block_helper, &ctx.tls,
+                            prologue, epilogue, tls_size);
+}
+
 void parallel_struct_for(RuntimeContext *context,
                          int snode_id,
                          int element_size,
@@ -1397,30 +1825,15 @@ void parallel_struct_for(RuntimeContext *context,
     i += grid_dim();
   }
 #else
-  cpu_block_task_helper_context ctx;
-  ctx.context = context;
-  ctx.task = task;
-  ctx.list = list;
-  ctx.element_size = element_size;
-  ctx.element_split = element_split;
-  ctx.tls_buffer_size = tls_buffer_size;
-  auto runtime = context->runtime;
-  runtime->parallel_for(runtime->thread_pool, list_tail * element_split,
-                        num_threads, &ctx, cpu_struct_for_block_helper);
+  cpu_parallel_struct_for(context, snode_id, element_size, element_split, task,
+                          nullptr, nullptr, tls_buffer_size, num_threads);
 #endif
 }
 
-using range_for_xlogue = void (*)(RuntimeContext *, /*TLS*/ char *tls_base);
-using mesh_for_xlogue = void (*)(RuntimeContext *,
-                                 /*TLS*/ char *tls_base,
-                                 uint32_t patch_idx);
-
 struct range_task_helper_context {
   RuntimeContext *context;
-  range_for_xlogue prologue{nullptr};
-  RangeForTaskFunc *body{nullptr};
-  range_for_xlogue epilogue{nullptr};
-  std::size_t tls_size{1};
+  RangeForBlockTaskFunc *body{nullptr};
+  cpu_thread_local_storage tls;
   int begin;
   int end;
   int block_size;
@@ -1430,29 +1843,21 @@ struct range_task_helper_context {
 void cpu_parallel_range_for_task(void *range_context,
                                  int thread_id,
                                  int task_id) {
-  auto ctx = *(range_task_helper_context *)range_context;
-  alignas(8) char tls_buffer[ctx.tls_size];
-  auto tls_ptr = &tls_buffer[0];
-  if (ctx.prologue)
-    ctx.prologue(ctx.context, tls_ptr);
+  auto &ctx = *(range_task_helper_context *)range_context;
+  auto tls_ptr = ctx.tls.get(thread_id);
 
   RuntimeContext this_thread_context = *ctx.context;
   this_thread_context.cpu_thread_id = thread_id;
+  // The body iterates over the block in the order of the loop
   if (ctx.step == 1) {
-    int block_start = ctx.begin + task_id * ctx.block_size;
-    int block_end = std::min(block_start + ctx.block_size, ctx.end);
-    for (int i = block_start; i < block_end; i++) {
-      ctx.body(&this_thread_context, tls_ptr, i);
-    }
+    int block_begin = ctx.begin + task_id * ctx.block_size;
+    int block_end = std::min(block_begin + ctx.block_size, ctx.end);
+    ctx.body(&this_thread_context, tls_ptr, block_begin, block_end);
   } else if (ctx.step == -1) {
-    int block_start = ctx.end - task_id * ctx.block_size;
-    int block_end = std::max(ctx.begin, block_start * ctx.block_size);
-    for (int i = block_start - 1; i >= block_end; i--) {
-      ctx.body(&this_thread_context, tls_ptr, i);
-    }
+    int block_end = ctx.end - task_id * ctx.block_size;
+    int block_begin = std::max(ctx.begin, block_end - ctx.block_size);
+    ctx.body(&this_thread_context, tls_ptr, block_begin, block_end);
   }
-  if (ctx.epilogue)
-    ctx.epilogue(ctx.context, tls_ptr);
 }
 
 void cpu_parallel_range_for(RuntimeContext *context,
@@ -1462,15 +1867,12 @@ void cpu_parallel_range_for(RuntimeContext *context,
                             int step,
                             int block_dim,
                             range_for_xlogue prologue,
-                            RangeForTaskFunc *body,
+                            RangeForBlockTaskFunc *body,
                             range_for_xlogue epilogue,
                             std::size_t tls_size) {
   range_task_helper_context ctx;
   ctx.context = context;
-  ctx.prologue = prologue;
-  ctx.tls_size = tls_size;
   ctx.body = body;
-  ctx.epilogue = epilogue;
   ctx.begin = begin;
   ctx.end = end;
   ctx.step = step;
@@ -1479,10 +1881,144 @@ void cpu_parallel_range_for(RuntimeContext *context,
     exit(-1);
   }
   ctx.block_size = block_dim;
+  cpu_parallel_for_with_tls(context, (end - begin + block_dim - 1) / block_dim,
+                            num_threads, &ctx, cpu_parallel_range_for_task,
+                            &ctx.tls, prologue, epilogue, tls_size);
+}
+
+// Targeted execution time of a single block. Long enough to amortize the
+// scheduling overhead, short enough to keep all threads busy.
+constexpr i64 kAdaptiveRangeForTargetBlockNs = 50 * 1000;
+
+struct range_task_timing_context {
+  range_task_helper_context base;
+  i64 total_ns{0};
+  i64 max_block_ns{0};
+};
+
+void cpu_parallel_range_for_timed_task(void *range_context,
+                                       int thread_id,
+                                       int task_id) {
+  auto ctx = (range_task_timing_context *)range_context;
+  auto get_time_ns = ctx->base.context->runtime->host_get_time_ns;
+  i64 t = get_time_ns();
+  cpu_parallel_range_for_task(&ctx->base, thread_id, task_id);
+  t = get_time_ns() - t;
+  atomic_add_i64(&ctx->total_ns, t);
+  atomic_max_i64(&ctx->max_block_ns, t);
+}
+
+constexpr int kRangeForChunkStateWays = 8;
+static_assert(taichi_max_num_range_for_chunk_states %
+                  kRangeForChunkStateWays ==
+              0);
+
+// Returns the chunk state of `task`, claiming the least recently launched
+// slot of its set if the task is not tracked yet. The caller holds
+// range_for_chunk_states_lock.
+RangeForChunkState *find_range_for_chunk_state(LLVMRuntime *runtime,
+                                               Ptr task) {
+  constexpr int num_sets =
+      taichi_max_num_range_for_chunk_states / kRangeForChunkStateWays;
+  u64 hash = ((u64)task >> 4) * 11400714819323198485ull;
+  auto set = &runtime->range_for_chunk_states[(hash >> 32) % num_sets *
+                                               kRangeForChunkStateWays];
+  auto victim = &set[0];
+  for (int i = 0; i < kRangeForChunkStateWays; i++) {
+    if (set[i].task == task) {
+      return &set[i];
+    }
+    if (set[i].last_launch < victim->last_launch) {
+      victim = &set[i];
+    }
+  }
+  victim->task = task;
+  victim->block_dim = 0;
+  return victim;
+}
+
+// Returns the block size tuned for `task`, or 0 if there is none yet.
+i32 get_range_for_block_dim(LLVMRuntime *runtime, Ptr task) {
+  i32 block_dim = 0;
+  locked_task(&runtime->range_for_chunk_states_lock, [&] {
+    auto state = find_range_for_chunk_state(runtime, task);
+    state->last_launch = ++runtime->num_range_for_launches;
+    block_dim = state->block_dim;
+  });
+  return block_dim;
+}
+
+void set_range_for_block_dim(LLVMRuntime *runtime, Ptr task, i32 block_dim) {
+  locked_task(&runtime->range_for_chunk_states_lock, [&] {
+    find_range_for_chunk_state(runtime, task)->block_dim = block_dim;
+  });
+}
+
+// Guided chunking: picks the block size for the next launch of a task from
+// the per-block costs measured in this launch. Blocks are sized to run for
+// about kAdaptiveRangeForTargetBlockNs, but there are always several blocks
+// per thread so that work stealing can balance irregular bodies. The block
+// size moves by at most 2x per launch to damp noise.
+i32 next_adaptive_block_dim(i32 block_dim,
+                            i32 num_iterations,
+                            int num_threads,
+                            i64 total_ns,
+                            i64 max_block_ns) {
+  i32 num_blocks = (num_iterations + block_dim - 1) / block_dim;
+  f64 ns_per_iteration = max_f64((f64)total_ns / num_iterations, 1.0);
+  f64 mean_block_ns = (f64)total_ns / num_blocks;
+  i64 ideal = (i64)(kAdaptiveRangeForTargetBlockNs / ns_per_iteration);
+  // Blocks with very different costs call for finer granularity.
+  i32 blocks_per_thread = max_block_ns > 4 * mean_block_ns ? 16 : 4;
+  i64 balanced =
+      max_i64(1, num_iterations / ((i64)num_threads * blocks_per_thread));
+  ideal = min_i64(ideal, balanced);
+  ideal = max_i64(ideal, (block_dim + 1) / 2);
+  ideal = min_i64(ideal, (i64)block_dim * 2);
+  return (i32)max_i64(ideal, 1);
+}
+
+void cpu_parallel_range_for_adaptive(RuntimeContext *context,
+                                     int num_threads,
+                                     int begin,
+                                     int end,
+                                     int step,
+                                     int block_dim,
+                                     range_for_xlogue prologue,
+                                     RangeForBlockTaskFunc *body,
+                                     range_for_xlogue epilogue,
+                                     std::size_t tls_size) {
   auto runtime = context->runtime;
-  runtime->parallel_for(runtime->thread_pool,
-                        (end - begin + block_dim - 1) / block_dim, num_threads,
-                        &ctx, cpu_parallel_range_for_task);
+  if (!runtime->host_get_time_ns || end <= begin) {
+    cpu_parallel_range_for(context, num_threads, begin, end, step, block_dim,
+                           prologue, body, epilogue, tls_size);
+    return;
+  }
+  auto tuned_block_dim = get_range_for_block_dim(runtime, (Ptr)body);
+  if (tuned_block_dim > 0) {
+    block_dim = tuned_block_dim;
+  }
+  block_dim = std::min(block_dim, end - begin);
+
+  range_task_timing_context ctx;
+  ctx.base.context = context;
+  ctx.base.body = body;
+  ctx.base.begin = begin;
+  ctx.base.end = end;
+  ctx.base.step = step;
+  if (step != 1 && step != -1) {
+    taichi_printf(runtime, "step must not be %d\n", step);
+    exit(-1);
+  }
+  ctx.base.block_size = block_dim;
+  cpu_parallel_for_with_tls(context, (end - begin + block_dim - 1) / block_dim,
+                            num_threads, &ctx,
+                            cpu_parallel_range_for_timed_task, &ctx.base.tls,
+                            prologue, epilogue, tls_size);
+  set_range_for_block_dim(
+      runtime, (Ptr)body,
+      next_adaptive_block_dim(block_dim, end - begin, num_threads,
+                              ctx.total_ns, ctx.max_block_ns));
 }
 
 void gpu_parallel_range_for(RuntimeContext *context,
@@ -1607,6 +2143,7 @@ i32 linear_thread_idx(RuntimeContext *context) {
 #include "node_pointer.h"
 #include "node_root.h"
 #include "node_bitmasked.h"
+#include "node_hash.h"
 
 void ListManager::touch_chunk(int chunk_id) {
   taichi_assert_runtime(runtime, chunk_id < max_num_chunks,
@@ -1636,6 +2173,14 @@ Ptr ListManager::allocate() {
 
 void node_gc(LLVMRuntime *runtime, int snode_id) {
   runtime->node_allocators[snode_id]->gc_serial();
+  hash_tables_gc(runtime, snode_id);
+  dynamic_directories_gc(runtime, snode_id);
+}
+
+void node_gc_incremental(LLVMRuntime *runtime, int snode_id, int budget) {
+  runtime->node_allocators[snode_id]->gc_incremental(budget);
+  hash_tables_gc(runtime, snode_id);
+  dynamic_directories_gc(runtime, snode_id);
 }
 
 void runtime_context_gc(LLVMRuntime *runtime) {
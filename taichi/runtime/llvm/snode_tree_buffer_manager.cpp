@@ -60,6 +60,10 @@ Ptr SNodeTreeBufferManager::allocate(JITModule *runtime_jit,
       ptr_map_[x.second + size] = x.first - size;
     }
     TI_ASSERT(x.second);
+    if (arch_is_cpu(runtime_exec_->get_config().arch)) {
+      MemoryPool::get_instance(runtime_exec_->get_config().arch)
+          .reuse_pages(x.second, size);
+    }
     roots_[snode_tree_id] = x.second;
     sizes_[snode_tree_id] = size;
     return x.second;
@@ -75,6 +79,12 @@ void SNodeTreeBufferManager::destroy(SNodeTree *snode_tree) {
     return;
   }
   Ptr ptr = roots_[snode_tree_id];
+  if (arch_is_cpu(runtime_exec_->get_config().arch)) {
+    // Give the pages of the destroyed tree back to the OS. They are zeroed
+    // again when the range is reused by a new tree.
+    MemoryPool::get_instance(runtime_exec_->get_config().arch)
+        .release_pages(ptr, size);
+  }
   merge_and_insert(ptr, size);
   TI_DEBUG("SNode tree {} destroyed.", snode_tree_id);
 }
@@ -76,6 +76,7 @@ FunctionType LlvmProgramImpl::compile(const CompileConfig &compile_config,
                                       Kernel *kernel) {
   // NOTE: Temporary implementation
   // TODO(PGZXB): Final solution: compile -> load_or_compile + launch_kernel
+  std::lock_guard<std::mutex> _(compile_mut_);
   auto &mgr = get_kernel_compilation_manager();
   const auto &compiled = mgr.load_or_compile(compile_config, {}, *kernel);
   auto &llvm_data = dynamic_cast<const LLVM::CompiledKernelData &>(compiled);
@@ -85,8 +86,39 @@ FunctionType LlvmProgramImpl::compile(const CompileConfig &compile_config,
       llvm_data.get_internal_data().compiled_data.clone());
 }
 
+std::future<FunctionType> LlvmProgramImpl::compile_async(
+    const CompileConfig &compile_config,
+    Kernel *kernel) {
+  auto task = std::make_shared<std::packaged_task<FunctionType()>>(
+      [this, compile_config, kernel]() {
+        // Runs the whole optimization pipeline on each task in the LLVM
+        // context of this thread, so that only linking the tasks and loading
+        // the kernel into the JIT block the compiles of the calling thread.
+        auto config = compile_config;
+        config.llvm_per_task_opt = true;
+        auto *tlctx = runtime_exec_->get_llvm_context();
+        std::unique_lock<std::mutex> snode_trees_lock(snode_trees_mut_);
+        // Bypasses the KernelCompilationManager, which is not thread-safe
+        auto ir = make_kernel_compiler()->compile(config, *kernel);
+        auto codegen = KernelCodeGen::create(config, kernel, ir.get(), *tlctx);
+        auto tasks = codegen->compile_tasks(/*worker=*/nullptr);
+        std::lock_guard<std::mutex> _(compile_mut_);
+        return llvm_compiled_kernel_to_executable(
+            config.arch, tlctx, runtime_exec_.get(), kernel,
+            codegen->link_tasks(std::move(tasks)));
+      });
+  auto future = task->get_future();
+  if (!background_compiler_) {
+    background_compiler_ =
+        std::make_unique<ParallelExecutor>("background_compile", 1);
+  }
+  background_compiler_->enqueue([task]() { (*task)(); });
+  return future;
+}
+
 std::unique_ptr<StructCompiler> LlvmProgramImpl::compile_snode_tree_types_impl(
     SNodeTree *tree) {
+  std::scoped_lock _(snode_trees_mut_, compile_mut_);
   auto *const root = tree->root();
   std::unique_ptr<StructCompiler> struct_compiler{nullptr};
   auto module = runtime_exec_->llvm_context_.get()->new_module("struct");
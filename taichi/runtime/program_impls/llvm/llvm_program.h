@@ -2,6 +2,7 @@
 
 #include <cstddef>
 #include <memory>
+#include <mutex>
 
 #include "taichi/runtime/llvm/llvm_offline_cache.h"
 #include "taichi/program/compile_config.h"
@@ -48,6 +49,9 @@ class LlvmProgramImpl : public ProgramImpl {
   FunctionType compile(const CompileConfig &compile_config,
                        Kernel *kernel) override;
 
+  std::future<FunctionType> compile_async(const CompileConfig &compile_config,
+                                          Kernel *kernel) override;
+
   void compile_snode_tree_types(SNodeTree *tree) override;
 
   // TODO(zhanlue): refactor materialize_snode_tree()
@@ -101,6 +105,7 @@ class LlvmProgramImpl : public ProgramImpl {
   }
 
   void destroy_snode_tree(SNodeTree *snode_tree) override {
+    std::scoped_lock _(snode_trees_mut_, compile_mut_);
     return runtime_exec_->destroy_snode_tree(snode_tree);
   }
 
@@ -110,6 +115,9 @@ class LlvmProgramImpl : public ProgramImpl {
   }
 
   void finalize() override {
+    if (background_compiler_) {
+      background_compiler_->flush();
+    }
     runtime_exec_->finalize();
   }
 
@@ -259,6 +267,11 @@ class LlvmProgramImpl : public ProgramImpl {
   //
   // Make sure the above mentioned objects are destructed in order.
   ~LlvmProgramImpl() override {
+    // Background compilations use both of the members below
+    if (background_compiler_) {
+      background_compiler_->flush();
+    }
+
     // Explicitly enforce "LlvmOfflineCache::CachedKernelData::owned_module"
     // destructs before
     // "LlvmRuntimeExecutor::TaichiLLVMContext::ThreadSafeContext"
@@ -278,6 +291,18 @@ class LlvmProgramImpl : public ProgramImpl {
   std::size_t num_snode_trees_processed_{0};
   std::unique_ptr<LlvmRuntimeExecutor> runtime_exec_;
   std::unique_ptr<LlvmOfflineCache> cache_data_;
+  // Guards the linking context of the TaichiLLVMContext and
+  // |compilation_workers|. Held by kernel and SNode tree compiles of the
+  // calling thread, and by |background_compiler_| only while it links a
+  // kernel and loads it into the JIT.
+  std::mutex compile_mut_;
+  // Keeps SNode trees from being added or destroyed while
+  // |background_compiler_| generates code with the struct modules of its
+  // thread. Always taken before |compile_mut_|.
+  std::mutex snode_trees_mut_;
+  // Created by the first compile_async(). Does not use
+  // |compilation_workers|, since compiling a kernel flushes it.
+  std::unique_ptr<ParallelExecutor> background_compiler_;
 };
 
 LlvmProgramImpl *get_llvm_program(Program *prog);
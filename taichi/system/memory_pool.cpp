@@ -1,5 +1,6 @@
 #include "memory_pool.h"
 #include "taichi/system/timer.h"
+#include "taichi/math/arithmetic.h"
 #include "taichi/rhi/cuda/cuda_driver.h"
 #include "taichi/rhi/cuda/cuda_device.h"
 
@@ -7,6 +8,11 @@
 
 #if defined(TI_PLATFORM_UNIX)
 #include <sys/mman.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <fstream>
+#endif
 #else
 #include "taichi/platform/windows/windows.h"
 #endif
@@ -33,6 +39,7 @@ MemoryPool::MemoryPool(Arch arch) : arch_(arch) {
   TI_TRACE("Memory pool created. Default buffer size per allocator = {} MB",
            default_allocator_size / 1024 / 1024);
   // TODO: initialize allocator according to arch
+  size_class_free_lists_.resize(get_size_class(max_size_class_bytes) + 1);
 }
 
 void *MemoryPool::allocate(std::size_t size,
@@ -43,26 +50,42 @@ void *MemoryPool::allocate(std::size_t size,
 
   // TODO: refactor this part to allocator->allocate(size, alignment)
   if (arch_is_cpu(arch_)) {
-    if (releasable) {
+    // Bytes of the block handed out for this allocation, which is what
+    // committed_bytes accounts for
+    std::size_t block_size = size;
+    if (releasable && size <= max_size_class_bytes) {
+      // Reuse a free block of the size class if possible. Its pages have been
+      // released and read as zero, just like freshly mapped memory.
+      auto size_class = get_size_class(size);
+      block_size = get_size_class_bytes(size_class);
+      auto &free_list = size_class_free_lists_[size_class];
+      for (auto it = free_list.rbegin(); it != free_list.rend(); ++it) {
+        if ((std::size_t)*it % alignment == 0) {
+          ret = *it;
+          free_list.erase(std::next(it).base());
+          break;
+        }
+      }
+      if (!ret) {
+        ret = allocate_from_allocators(block_size,
+                                       std::max(alignment, page_size));
+      }
+      releasable_blocks_[ret] = {size_class, block_size};
+    } else if (releasable) {
       // For UnifiedAllocator, we have to make it exclusive to make sure it's
-      // releasable, usually used for small memory allocations so it's easy to
-      // alloc - release
+      // releasable, usually used for large memory allocations so that the
+      // whole allocator can be unmapped on release
       allocators.emplace_back(std::make_unique<UnifiedAllocator>(
           size, arch_, true /* is_exclusive */));
       ret = allocators.back()->allocate(size, alignment);
-
-    } else if (!allocators.empty()) {
-      ret = allocators.back()->allocate(size, alignment);
-    }
-
-    if (!ret) {
-      // allocation have failed
-      auto new_buffer_size = std::max(size, default_allocator_size);
-      allocators.emplace_back(
-          std::make_unique<UnifiedAllocator>(new_buffer_size, arch_));
-      ret = allocators.back()->allocate(size, alignment);
+      block_size = iroundup(size, page_size);
+      releasable_blocks_[ret] = {-1, block_size};
+    } else {
+      ret = allocate_from_allocators(size, alignment);
     }
     TI_ASSERT(ret);
+    stats_.committed_bytes += block_size;
+    stats_.in_use_bytes += size;
   } else {
     TI_NOT_IMPLEMENTED;
   }
@@ -70,15 +93,170 @@ void *MemoryPool::allocate(std::size_t size,
   return ret;
 }
 
+void *MemoryPool::allocate_from_allocators(std::size_t size,
+                                           std::size_t alignment) {
+  void *ret = nullptr;
+  if (!allocators.empty()) {
+    ret = allocators.back()->allocate(size, alignment);
+  }
+
+  if (!ret) {
+    // allocation have failed
+    auto new_buffer_size = std::max(size, default_allocator_size);
+    allocators.emplace_back(
+        std::make_unique<UnifiedAllocator>(new_buffer_size, arch_));
+    ret = allocators.back()->allocate(size, alignment);
+  }
+  return ret;
+}
+
 void MemoryPool::release(std::size_t size, void *ptr) {
   std::lock_guard<std::mutex> _(mut_allocators);
 
-  for (auto &allocator : allocators) {
-    if (allocator->is_releasable((uint64_t *)ptr)) {
-      allocator->release(size, (uint64_t *)ptr);
+  auto it = releasable_blocks_.find(ptr);
+  if (it == releasable_blocks_.end()) {
+    return;
+  }
+  auto block = it->second;
+  releasable_blocks_.erase(it);
+  if (block.size_class >= 0) {
+    decommit(ptr, block.size);
+    size_class_free_lists_[block.size_class].push_back(ptr);
+  } else {
+    for (auto &allocator : allocators) {
+      if (allocator->is_releasable((uint64_t *)ptr)) {
+        allocator->release(size, (uint64_t *)ptr);
+        break;
+      }
+    }
+  }
+  stats_.committed_bytes -= block.size;
+  stats_.in_use_bytes -= size;
+}
+
+std::pair<std::size_t, std::size_t> MemoryPool::get_inner_pages(
+    void *ptr,
+    std::size_t size) {
+  auto begin = iroundup((std::size_t)ptr, page_size);
+  auto end = ((std::size_t)ptr + size) / page_size * page_size;
+  return {begin, std::max(begin, end)};
+}
+
+void MemoryPool::release_pages(void *ptr, std::size_t size) {
+  std::lock_guard<std::mutex> _(mut_allocators);
+  auto [begin, end] = get_inner_pages(ptr, size);
+  if (begin == end) {
+    return;
+  }
+  decommit((void *)begin, end - begin);
+  stats_.committed_bytes -= end - begin;
+}
+
+void MemoryPool::reuse_pages(void *ptr, std::size_t size) {
+  std::lock_guard<std::mutex> _(mut_allocators);
+  auto [begin, end] = get_inner_pages(ptr, size);
+  stats_.committed_bytes += end - begin;
+}
+
+MemoryPool::Stats MemoryPool::get_stats() {
+  std::lock_guard<std::mutex> _(mut_allocators);
+  return stats_;
+}
+
+#if defined(__linux__)
+namespace {
+
+// Parses a node list such as "0-1,3" from sysfs into a bit mask.
+unsigned long get_online_numa_nodes() {
+  std::ifstream fin("/sys/devices/system/node/online");
+  unsigned long mask = 0;
+  int begin, end;
+  char sep;
+  while (fin >> begin) {
+    end = begin;
+    if (fin.peek() == '-') {
+      fin >> sep >> end;
+    }
+    for (int i = begin; i <= end && i < 64; i++) {
+      mask |= 1UL << i;
+    }
+    if (fin.peek() == ',') {
+      fin >> sep;
+    }
+  }
+  return mask;
+}
+
+}  // namespace
+#endif
+
+void MemoryPool::advise_placement(void *ptr,
+                                  std::size_t size,
+                                  bool huge_pages,
+                                  bool numa_interleave) {
+#if defined(__linux__)
+  auto [begin, end] = get_inner_pages(ptr, size);
+  if (begin == end) {
+    return;
+  }
+  if (huge_pages && madvise((void *)begin, end - begin, MADV_HUGEPAGE) != 0) {
+    TI_WARN("Failed to enable transparent huge pages ({} B)", end - begin);
+  }
+  if (numa_interleave) {
+    static const unsigned long nodes = get_online_numa_nodes();
+    if ((nodes & (nodes - 1)) == 0) {
+      // Nothing to interleave on a single node
       return;
     }
+    constexpr int kMpolInterleave = 3;
+    if (syscall(SYS_mbind, begin, end - begin, kMpolInterleave, &nodes,
+                sizeof(nodes) * 8 + 1, 0) != 0) {
+      TI_WARN("Failed to interleave memory over NUMA nodes ({} B)",
+              end - begin);
+    }
   }
+#endif
+}
+
+void MemoryPool::decommit(void *ptr, std::size_t size) {
+  /*
+    Be aware that this methods is not protected by the mutex.
+
+    The range must be page-aligned and must lie within the raw memory
+    allocated by allocate_raw_memory().
+  */
+  if (!arch_is_cpu(arch_)) {
+    return;
+  }
+#if defined(__linux__)
+  TI_ERROR_IF(madvise(ptr, size, MADV_DONTNEED) != 0,
+              "Failed to release pages ({} B)", size);
+#elif defined(TI_PLATFORM_UNIX)
+  // MADV_DONTNEED does not zero the pages on every Unix, so map fresh
+  // anonymous pages over the range instead
+  TI_ERROR_IF(mmap(ptr, size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1,
+                   0) == MAP_FAILED,
+              "Failed to release pages ({} B)", size);
+#else
+  // Committed pages that have never been touched are not backed by physical
+  // memory and read as zero
+  TI_ERROR_IF(!VirtualFree(ptr, size, MEM_DECOMMIT) ||
+                  !VirtualAlloc(ptr, size, MEM_COMMIT, PAGE_READWRITE),
+              "Failed to release pages ({} B)", size);
+#endif
+}
+
+int MemoryPool::get_size_class(std::size_t size) {
+  int size_class = 0;
+  while (get_size_class_bytes(size_class) < size) {
+    size_class++;
+  }
+  return size_class;
+}
+
+std::size_t MemoryPool::get_size_class_bytes(int size_class) {
+  return page_size << size_class;
 }
 
 void *MemoryPool::allocate_raw_memory(std::size_t size) {
@@ -124,6 +302,7 @@ void *MemoryPool::allocate_raw_memory(std::size_t size) {
   }
 
   raw_memory_chunks_[ptr] = size;
+  stats_.reserved_bytes += size;
   return ptr;
 }
 
@@ -152,16 +331,22 @@ void MemoryPool::deallocate_raw_memory(void *ptr) {
     TI_ERROR("Failed to free virtual memory ({} B)", size);
 
   raw_memory_chunks_.erase(ptr);
+  stats_.reserved_bytes -= size;
 }
 
 void MemoryPool::reset() {
   std::lock_guard<std::mutex> _(mut_allocators);
   allocators.clear();
+  for (auto &free_list : size_class_free_lists_) {
+    free_list.clear();
+  }
+  releasable_blocks_.clear();
 
   const auto ptr_map_copied = raw_memory_chunks_;
   for (auto &ptr : ptr_map_copied) {
     deallocate_raw_memory(ptr.first);
   }
+  stats_ = Stats();
 }
 
 MemoryPool::~MemoryPool() {
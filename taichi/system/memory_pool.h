@@ -9,6 +9,8 @@
 #include <vector>
 #include <memory>
 #include <thread>
+#include <unordered_map>
+#include <utility>
 
 namespace taichi::lang {
 
@@ -20,10 +22,23 @@ class TI_DLL_EXPORT MemoryPool {
  public:
   static MemoryPool &get_instance(Arch arch);
 
+  struct Stats {
+    // Virtual address space obtained from the OS
+    std::size_t reserved_bytes{0};
+    // Part of the reserved space handed out and not yet returned to the OS
+    std::size_t committed_bytes{0};
+    // Bytes held by callers of allocate()
+    std::size_t in_use_bytes{0};
+  };
+
   std::vector<std::unique_ptr<UnifiedAllocator>> allocators;
   static constexpr std::size_t default_allocator_size =
       1 << 30;                                    // 1 GB per allocator
   static constexpr size_t page_size = (1 << 12);  // 4 KB page size by default
+  // Releasable allocations up to this size are served from power-of-two size
+  // classes carved from the shared allocators; larger ones get an exclusive
+  // allocator that is unmapped on release.
+  static constexpr std::size_t max_size_class_bytes = 1 << 26;  // 64 MB
   std::mutex mut_allocators;
 
   void *allocate(std::size_t size,
@@ -32,6 +47,23 @@ class TI_DLL_EXPORT MemoryPool {
   void release(std::size_t size, void *ptr);
   void reset();
 
+  // Returns the physical pages backing [ptr, ptr + size) to the OS while
+  // keeping the address range valid. The pages read as zero when touched
+  // again. Only pages entirely inside the range are released.
+  void release_pages(void *ptr, std::size_t size);
+  // Accounts for a range previously passed to release_pages() being reused.
+  void reuse_pages(void *ptr, std::size_t size);
+
+  Stats get_stats();
+
+  // Applies the CPU placement policy to [ptr, ptr + size), which must not
+  // have been touched yet for the NUMA policy to take effect. Unsupported
+  // policies are silently ignored on the current platform.
+  static void advise_placement(void *ptr,
+                               std::size_t size,
+                               bool huge_pages,
+                               bool numa_interleave);
+
   ~MemoryPool();
   MemoryPool(Arch arch);
 
@@ -39,6 +71,31 @@ class TI_DLL_EXPORT MemoryPool {
   void *allocate_raw_memory(std::size_t size);
   void deallocate_raw_memory(void *ptr);
 
+  void *allocate_from_allocators(std::size_t size, std::size_t alignment);
+  void decommit(void *ptr, std::size_t size);
+
+  // Returns the page-aligned [begin, end) range of the pages entirely inside
+  // [ptr, ptr + size), which is empty if there are none.
+  static std::pair<std::size_t, std::size_t> get_inner_pages(
+      void *ptr,
+      std::size_t size);
+
+  static int get_size_class(std::size_t size);
+  static std::size_t get_size_class_bytes(int size_class);
+
+  // Free blocks of each size class. Their pages have been returned to the OS.
+  std::vector<std::vector<void *>> size_class_free_lists_;
+  struct ReleasableBlock {
+    // -1 for blocks with an exclusive allocator
+    int size_class;
+    // Bytes added to committed_bytes by the allocation
+    std::size_t size;
+  };
+  // Every block handed out for a releasable allocation
+  std::unordered_map<void *, ReleasableBlock> releasable_blocks_;
+
+  Stats stats_;
+
   // All the raw memory allocated from OS/Driver
   // We need to keep track of them to guarantee that they are freed
   std::map<void *, std::size_t> raw_memory_chunks_;
@@ -10,6 +10,16 @@
 #include <thread>
 #include <vector>
 
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || \
+    defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
 namespace taichi {
 
 bool test_threading() {
@@ -26,7 +36,39 @@ bool test_threading() {
   return true;
 }
 
-ThreadPool::ThreadPool(int max_num_threads) : max_num_threads(max_num_threads) {
+namespace {
+
+// Pins the calling thread to the |index|-th CPU in the affinity mask of the
+// process, wrapping around if there are fewer CPUs than threads. Pinning keeps
+// a worker next to the memory it first touched on NUMA machines.
+void pin_current_thread(int index) {
+#if defined(__linux__)
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+    return;
+  }
+  int num_allowed = CPU_COUNT(&allowed);
+  if (num_allowed == 0) {
+    return;
+  }
+  index %= num_allowed;
+  for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if (CPU_ISSET(cpu, &allowed) && index-- == 0) {
+      cpu_set_t target;
+      CPU_ZERO(&target);
+      CPU_SET(cpu, &target);
+      pthread_setaffinity_np(pthread_self(), sizeof(target), &target);
+      return;
+    }
+  }
+#endif
+}
+
+}  // namespace
+
+ThreadPool::ThreadPool(int max_num_threads, bool pin_threads)
+    : max_num_threads(max_num_threads), pin_threads(pin_threads) {
   exiting = false;
   started = false;
   running_threads = 0;
@@ -76,6 +118,9 @@ void ThreadPool::target() {
     std::lock_guard<std::mutex> lock(mutex);
     thread_id = thread_counter++;
   }
+  if (pin_threads) {
+    pin_current_thread(thread_id);
+  }
   while (true) {
     {
       std::unique_lock<std::mutex> lock(mutex);
@@ -136,4 +181,289 @@ ThreadPool::~ThreadPool() {
     th.join();
 }
 
+namespace {
+
+// Number of polls of the launch epoch before an idle worker parks itself.
+constexpr int kWorkStealingSpinIterations = 1 << 14;
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || \
+    defined(_M_IX86)
+  _mm_pause();
+#else
+  std::this_thread::yield();
+#endif
+}
+
+// Spin-waits, but periodically gives up the time slice so that spinning
+// threads do not starve busy ones when the machine is oversubscribed.
+inline void spin_pause(int iteration) {
+  if (iteration % 64 == 63) {
+    std::this_thread::yield();
+  } else {
+    cpu_relax();
+  }
+}
+
+inline uint32 xorshift32(uint32 &state) {
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+}  // namespace
+
+WorkStealingThreadPool::WorkStealingThreadPool(int max_num_threads,
+                                               bool pin_threads)
+    : max_num_threads_(std::max(max_num_threads, 1)),
+      pin_threads_(pin_threads) {
+  ranges_ = std::make_unique<TaskRange[]>((std::size_t)max_num_threads_);
+  // The master thread acts as participant 0, so only spawn the others.
+  threads_.reserve((std::size_t)max_num_threads_ - 1);
+  for (int i = 1; i < max_num_threads_; i++) {
+    threads_.emplace_back([this, i] { this->target(i); });
+  }
+}
+
+void WorkStealingThreadPool::run(int splits,
+                                 int desired_num_threads,
+                                 void *range_for_task_context,
+                                 RangeForTaskFunc *func) {
+  if (splits <= 0) {
+    return;
+  }
+  const int num_participants =
+      std::min({desired_num_threads, max_num_threads_, splits});
+  TI_ASSERT(num_participants > 0);
+  if (num_participants == 1) {
+    // Not worth waking up anyone.
+    for (int i = 0; i < splits; i++) {
+      func(range_for_task_context, 0, i);
+    }
+    return;
+  }
+
+  // Enter the preparation phase (odd epoch) and wait until no worker is left
+  // from the previous launch. A worker either registers itself in
+  // |num_active_| before this store, or observes the odd epoch and backs off.
+  const uint64 epoch = epoch_.fetch_add(1) + 1;
+  for (int i = 0; num_active_.load() != 0; i++) {
+    spin_pause(i);
+  }
+
+  func_ = func;
+  range_for_task_context_ = range_for_task_context;
+  num_participants_ = num_participants;
+  for (int i = 0; i < num_participants; i++) {
+    auto begin = uint32((int64)splits * i / num_participants);
+    auto end = uint32((int64)splits * (i + 1) / num_participants);
+    ranges_[i].range.store(pack_range(begin, end), std::memory_order_relaxed);
+  }
+  num_remaining_tasks_.store(splits, std::memory_order_relaxed);
+
+  // Publish the launch.
+  num_active_.fetch_add(1);
+  epoch_.store(epoch + 1);
+  if (num_parked_.load() > 0) {
+    {
+      // Make sure parked workers are either waiting on the condition variable
+      // or will observe the new epoch before waiting.
+      std::lock_guard<std::mutex> _(park_mutex_);
+    }
+    park_cv_.notify_all();
+  }
+
+  // Returns only after every task of this launch has finished. Workers that
+  // are still leaving are waited for at the beginning of the next launch.
+  participate(0);
+  num_active_.fetch_sub(1, std::memory_order_release);
+}
+
+void WorkStealingThreadPool::target(int thread_id) {
+  if (pin_threads_) {
+    // The master thread is participant 0 and is left alone
+    pin_current_thread(thread_id);
+  }
+  uint64 last_epoch = 0;
+  while (true) {
+    uint64 epoch;
+    int spins = 0;
+    auto has_new_launch = [&] {
+      epoch = epoch_.load(std::memory_order_acquire);
+      return epoch != last_epoch && epoch % 2 == 0;
+    };
+    while (!has_new_launch()) {
+      if (exiting_.load(std::memory_order_relaxed)) {
+        return;
+      }
+      if (++spins < kWorkStealingSpinIterations) {
+        spin_pause(spins);
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(park_mutex_);
+      num_parked_.fetch_add(1);
+      park_cv_.wait(lock, [&] { return exiting_.load() || has_new_launch(); });
+      num_parked_.fetch_sub(1);
+      spins = 0;
+    }
+    last_epoch = epoch;
+
+    num_active_.fetch_add(1);
+    if (epoch_.load() == epoch && thread_id < num_participants_) {
+      participate(thread_id);
+    }
+    num_active_.fetch_sub(1, std::memory_order_release);
+  }
+}
+
+void WorkStealingThreadPool::participate(int thread_id) {
+  uint32 seed = uint32(thread_id) * 2654435761u + 1;
+  for (int attempt = 0;; attempt++) {
+    int num_finished = 0;
+    int task_id;
+    while (pop_local(thread_id, task_id)) {
+      func_(range_for_task_context_, thread_id, task_id);
+      num_finished++;
+    }
+    if (num_finished > 0) {
+      // Only touch the shared counter once per drained range.
+      num_remaining_tasks_.fetch_sub(num_finished, std::memory_order_acq_rel);
+    }
+    if (num_remaining_tasks_.load(std::memory_order_acquire) == 0) {
+      return;
+    }
+    if (!steal(thread_id, seed)) {
+      // Some tasks are still running, or in flight between two ranges.
+      spin_pause(attempt);
+    }
+  }
+}
+
+bool WorkStealingThreadPool::pop_local(int thread_id, int &task_id) {
+  auto &range = ranges_[thread_id].range;
+  uint64 current = range.load(std::memory_order_relaxed);
+  while (true) {
+    auto begin = uint32(current);
+    auto end = uint32(current >> 32);
+    if (begin >= end) {
+      return false;
+    }
+    if (range.compare_exchange_weak(current, pack_range(begin + 1, end),
+                                    std::memory_order_acquire,
+                                    std::memory_order_relaxed)) {
+      task_id = (int)begin;
+      return true;
+    }
+  }
+}
+
+bool WorkStealingThreadPool::steal(int thread_id, uint32 &seed) {
+  const int n = num_participants_;
+  const int start = int(xorshift32(seed) % uint32(n));
+  for (int k = 0; k < n; k++) {
+    int victim = (start + k) % n;
+    if (victim == thread_id) {
+      continue;
+    }
+    auto &range = ranges_[victim].range;
+    uint64 current = range.load(std::memory_order_relaxed);
+    while (true) {
+      auto begin = uint32(current);
+      auto end = uint32(current >> 32);
+      if (begin >= end) {
+        break;
+      }
+      // Take the back half, or the only remaining task.
+      auto mid = begin + (end - begin) / 2;
+      if (range.compare_exchange_weak(current, pack_range(begin, mid),
+                                      std::memory_order_acquire,
+                                      std::memory_order_relaxed)) {
+        // Our own range is empty, so nobody else is modifying it.
+        ranges_[thread_id].range.store(pack_range(mid, end),
+                                       std::memory_order_release);
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+  {
+    std::lock_guard<std::mutex> _(park_mutex_);
+    exiting_ = true;
+  }
+  park_cv_.notify_all();
+  for (auto &th : threads_)
+    th.join();
+}
+
+SerialTaskQueue::SerialTaskQueue(int max_num_pending)
+    : max_num_pending_(std::max(max_num_pending, 1)) {
+  thread_ = std::thread([this] { this->target(); });
+}
+
+void SerialTaskQueue::enqueue(std::function<void()> task) {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cv_.wait(lock,
+                  [this] { return (int)tasks_.size() < max_num_pending_; });
+    tasks_.push_back(std::move(task));
+  }
+  task_cv_.notify_one();
+}
+
+void SerialTaskQueue::wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_cv_.wait(lock, [this] { return tasks_.empty() && !running_; });
+  if (error_) {
+    auto error = error_;
+    error_ = nullptr;
+    std::rethrow_exception(error);
+  }
+}
+
+void SerialTaskQueue::target() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      task_cv_.wait(lock, [this] { return !tasks_.empty() || exiting_; });
+      if (tasks_.empty()) {
+        break;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+      running_ = true;
+    }
+    // Wakes up producers blocked on a full queue
+    idle_cv_.notify_all();
+    std::exception_ptr error = nullptr;
+    try {
+      task();
+    } catch (...) {
+      error = std::current_exception();
+    }
+    {
+      std::lock_guard<std::mutex> _(mutex_);
+      running_ = false;
+      if (error && !error_) {
+        error_ = error;
+      }
+    }
+    idle_cv_.notify_all();
+  }
+}
+
+SerialTaskQueue::~SerialTaskQueue() {
+  {
+    std::lock_guard<std::mutex> _(mutex_);
+    exiting_ = true;
+  }
+  // Pending tasks are still run before the thread exits
+  task_cv_.notify_all();
+  thread_.join();
+}
+
 }  // namespace taichi
@@ -9,7 +9,10 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <deque>
+#include <exception>
 #include <functional>
+#include <memory>
 #include <thread>
 
 namespace taichi {
@@ -38,8 +41,9 @@ class ThreadPool {
                                  // LLVM runtime, which is different from
                                  // taichi::lang::Context.
   int thread_counter;
+  bool pin_threads;
 
-  explicit ThreadPool(int max_num_threads);
+  explicit ThreadPool(int max_num_threads, bool pin_threads = false);
 
   void run(int splits,
            int desired_num_threads,
@@ -59,4 +63,103 @@ class ThreadPool {
   ~ThreadPool();
 };
 
+// A scheduler with the same interface as ThreadPool, designed for kernels with
+// many small offloaded tasks. Each participant owns a contiguous range of task
+// ids ("deque") that it consumes from the front, while idle participants steal
+// the back half of other participants' ranges. Workers spin for a while before
+// parking, so that back-to-back launches do not pay a condition variable round
+// trip, and the calling (master) thread executes tasks as participant 0.
+class WorkStealingThreadPool {
+ public:
+  explicit WorkStealingThreadPool(int max_num_threads,
+                                  bool pin_threads = false);
+
+  void run(int splits,
+           int desired_num_threads,
+           void *range_for_task_context,
+           RangeForTaskFunc *func);
+
+  static void static_run(WorkStealingThreadPool *pool,
+                         int splits,
+                         int desired_num_threads,
+                         void *range_for_task_context,
+                         RangeForTaskFunc *func) {
+    return pool->run(splits, desired_num_threads, range_for_task_context, func);
+  }
+
+  int get_max_num_threads() const {
+    return max_num_threads_;
+  }
+
+  ~WorkStealingThreadPool();
+
+ private:
+  // Task ids [begin, end) packed into one word so that the owner and the
+  // thieves can update a range with a single compare-and-swap.
+  struct alignas(64) TaskRange {
+    std::atomic<uint64> range{0};
+  };
+
+  static uint64 pack_range(uint32 begin, uint32 end) {
+    return (uint64(end) << 32) | uint64(begin);
+  }
+
+  void target(int thread_id);
+
+  // Executes tasks until no participant has any task left.
+  void participate(int thread_id);
+
+  bool pop_local(int thread_id, int &task_id);
+
+  bool steal(int thread_id, uint32 &seed);
+
+  int max_num_threads_;
+  bool pin_threads_;
+  std::vector<std::thread> threads_;
+  std::unique_ptr<TaskRange[]> ranges_;
+
+  // Odd while the master is preparing a launch, even once tasks are published.
+  std::atomic<uint64> epoch_{0};
+  // Number of tasks of the current launch that have not finished yet.
+  std::atomic<int> num_remaining_tasks_{0};
+  std::atomic<int> num_active_{0};
+  std::atomic<int> num_parked_{0};
+  std::atomic<bool> exiting_{false};
+
+  int num_participants_{0};
+  RangeForTaskFunc *func_{nullptr};
+  void *range_for_task_context_{nullptr};
+
+  std::mutex park_mutex_;
+  std::condition_variable park_cv_;
+};
+
+// Runs tasks one after another, in submission order, on a dedicated thread.
+// enqueue() returns immediately unless |max_num_pending| tasks are already
+// waiting. An exception thrown by a task is rethrown by the next wait().
+class SerialTaskQueue {
+ public:
+  explicit SerialTaskQueue(int max_num_pending = 1024);
+
+  void enqueue(std::function<void()> task);
+
+  // Blocks until all the enqueued tasks have finished.
+  void wait();
+
+  ~SerialTaskQueue();
+
+ private:
+  void target();
+
+  int max_num_pending_;
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable task_cv_;
+  std::condition_variable idle_cv_;
+  std::deque<std::function<void()>> tasks_;
+  bool running_{false};
+  bool exiting_{false};
+  std::exception_ptr error_{nullptr};
+};
+
 }  // namespace taichi
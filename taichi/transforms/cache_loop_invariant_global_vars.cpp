@@ -1,4 +1,5 @@
 #include "taichi/transforms/loop_invariant_detector.h"
+#include "taichi/analysis/gather_uniquely_accessed_pointers.h"
 #include "taichi/ir/analysis.h"
 
 namespace taichi::lang {
@@ -24,8 +25,11 @@ class CacheLoopInvariantGlobalVars : public LoopInvariantDetector {
 
   OffloadedStmt *current_offloaded;
 
-  explicit CacheLoopInvariantGlobalVars(const CompileConfig &config)
-      : LoopInvariantDetector(config) {
+  AnalysisManager *amgr;
+
+  CacheLoopInvariantGlobalVars(const CompileConfig &config,
+                               AnalysisManager *amgr)
+      : LoopInvariantDetector(config), amgr(amgr) {
   }
 
   void visit(OffloadedStmt *stmt) override {
@@ -33,9 +37,9 @@ class CacheLoopInvariantGlobalVars : public LoopInvariantDetector {
         stmt->task_type == OffloadedTaskType::mesh_for ||
         stmt->task_type == OffloadedTaskType::struct_for) {
       auto uniquely_accessed_pointers =
-          irpass::analysis::gather_uniquely_accessed_pointers(stmt);
-      loop_unique_ptr_ = std::move(uniquely_accessed_pointers.first);
-      loop_unique_arr_ptr_ = std::move(uniquely_accessed_pointers.second);
+          amgr->get_or_run<GatherUniquelyAccessedPointersPass>(stmt);
+      loop_unique_ptr_ = uniquely_accessed_pointers->ptrs;
+      loop_unique_arr_ptr_ = uniquely_accessed_pointers->arr_ptrs;
     }
     current_offloaded = stmt;
     // We don't need to visit TLS/BLS prologues/epilogues.
@@ -169,16 +173,21 @@ class CacheLoopInvariantGlobalVars : public LoopInvariantDetector {
     }
   }
 
-  static bool run(IRNode *node, const CompileConfig &config) {
+  static bool run(IRNode *node,
+                  const CompileConfig &config,
+                  AnalysisManager *amgr) {
     bool modified = false;
 
     while (true) {
-      CacheLoopInvariantGlobalVars eliminator(config);
+      CacheLoopInvariantGlobalVars eliminator(config, amgr);
       node->accept(&eliminator);
-      if (eliminator.modifier.modify_ir())
+      if (eliminator.modifier.modify_ir()) {
         modified = true;
-      else
+        // Hoisted pointers are no longer the ones analyzed
+        amgr->invalidate(PreservedAnalyses::none());
+      } else {
         break;
+      }
     };
 
     return modified;
@@ -187,9 +196,12 @@ class CacheLoopInvariantGlobalVars : public LoopInvariantDetector {
 
 namespace irpass {
 bool cache_loop_invariant_global_vars(IRNode *root,
-                                      const CompileConfig &config) {
+                                      const CompileConfig &config,
+                                      AnalysisManager *amgr) {
   TI_AUTO_PROF;
-  return CacheLoopInvariantGlobalVars::run(root, config);
+  AnalysisManager local_amgr;
+  return CacheLoopInvariantGlobalVars::run(root, config,
+                                           amgr ? amgr : &local_amgr);
 }
 }  // namespace irpass
 }  // namespace taichi::lang
@@ -15,9 +15,11 @@ bool cfg_optimization(
     const std::optional<ControlFlowGraph::LiveVarAnalysisConfig>
         &lva_config_opt) {
   TI_AUTO_PROF;
-  auto cfg = analysis::build_cfg(root);
   bool result_modified = false;
   if (!real_matrix_enabled) {
+    // The graph is simplified and updated along with the IR here, so it is
+    // built for this pass only.
+    auto cfg = analysis::build_cfg(root);
     cfg->simplify_graph();
     if (cfg->store_to_load_forwarding(after_lower_access, autodiff_enabled))
       result_modified = true;
@@ -25,7 +27,9 @@ bool cfg_optimization(
       result_modified = true;
   }
   // TODO: implement cfg->dead_instruction_elimination()
-  die(root);  // remove unused allocas
+  if (die(root)) {  // remove unused allocas
+    result_modified = true;
+  }
   return result_modified;
 }
 }  // namespace irpass
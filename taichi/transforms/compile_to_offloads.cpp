@@ -38,6 +38,8 @@ void compile_to_offloads(IRNode *ir,
                          bool ad_use_stack,
                          bool start_from_ast) {
   TI_AUTO_PROF;
+  // New statements go to the arena of the IR, if it has one
+  IRArena::Scope arena_scope(get_ir_arena(ir));
 
   auto print = make_pass_printer(verbose, kernel->get_name(), ir);
   print("Initial IR");
@@ -173,6 +175,8 @@ void offload_to_executable(IRNode *ir,
                            bool make_thread_local,
                            bool make_block_local) {
   TI_AUTO_PROF;
+  // New statements go to the arena of the IR, if it has one
+  IRArena::Scope arena_scope(get_ir_arena(ir));
 
   auto print = make_pass_printer(verbose, kernel->get_name(), ir);
 
@@ -191,13 +195,16 @@ void offload_to_executable(IRNode *ir,
     print("Detect read-only accesses");
   }
 
-  irpass::demote_atomics(ir, config);
+  // Both passes need the uniquely accessed pointers of each offload
+  irpass::demote_atomics(ir, config, amgr.get());
   print("Atomics demoted I");
   irpass::analysis::verify(ir);
   if (config.cache_loop_invariant_global_vars) {
-    irpass::cache_loop_invariant_global_vars(ir, config);
+    irpass::cache_loop_invariant_global_vars(ir, config, amgr.get());
     print("Cache loop-invariant global vars");
   }
+  // The passes below do not keep the analyses up to date
+  amgr->invalidate(PreservedAnalyses::none());
 
   if (config.demote_dense_struct_fors) {
     irpass::demote_dense_struct_fors(ir);
@@ -206,7 +213,10 @@ void offload_to_executable(IRNode *ir,
     irpass::analysis::verify(ir);
   }
 
-  if (config.make_cpu_multithreading_loop && arch_is_cpu(config.arch)) {
+  // The adaptive scheduler needs the original iteration space to pick chunk
+  // sizes, so do not pre-split range-fors per thread in that case.
+  if (config.make_cpu_multithreading_loop && !config.cpu_adaptive_chunking &&
+      arch_is_cpu(config.arch)) {
     irpass::make_cpu_multithreaded_range_for(ir, config);
     irpass::type_check(ir, config);
     print("Make CPU multithreaded range-for");
@@ -316,6 +326,13 @@ void offload_to_executable(IRNode *ir,
   // Final field registration correctness & type checking
   irpass::type_check(ir, config);
   irpass::analysis::verify(ir);
+
+  if (arch_is_cpu(config.arch) && config.cpu_slp_vectorization &&
+      config.real_matrix_scalarize) {
+    irpass::slp_vectorize(ir, config);
+    print("SLP vectorized");
+    irpass::analysis::verify(ir);
+  }
 }
 
 void compile_to_executable(IRNode *ir,
@@ -347,6 +364,8 @@ void compile_function(IRNode *ir,
                       bool verbose,
                       bool start_from_ast) {
   TI_AUTO_PROF;
+  // New statements go to the arena of the IR, if it has one
+  IRArena::Scope arena_scope(get_ir_arena(ir));
 
   auto print = make_pass_printer(verbose, func->get_name(), ir);
   print("Initial IR");
@@ -1,3 +1,4 @@
+#include "taichi/analysis/gather_uniquely_accessed_pointers.h"
 #include "taichi/ir/analysis.h"
 #include "taichi/ir/ir.h"
 #include "taichi/ir/statements.h"
@@ -20,8 +21,9 @@ class DemoteAtomics : public BasicStmtVisitor {
 
   OffloadedStmt *current_offloaded;
   DelayedIRModifier modifier;
+  AnalysisManager *amgr;
 
-  DemoteAtomics() {
+  explicit DemoteAtomics(AnalysisManager *amgr) : amgr(amgr) {
     current_offloaded = nullptr;
   }
 
@@ -164,10 +166,12 @@ class DemoteAtomics : public BasicStmtVisitor {
     if (stmt->task_type == OffloadedTaskType::range_for ||
         stmt->task_type == OffloadedTaskType::mesh_for ||
         stmt->task_type == OffloadedTaskType::struct_for) {
+      // Demoting atomics keeps the pointers, so the result stays valid
+      // across the iterations of this pass.
       auto uniquely_accessed_pointers =
-          irpass::analysis::gather_uniquely_accessed_pointers(stmt);
-      loop_unique_ptr_ = std::move(uniquely_accessed_pointers.first);
-      loop_unique_arr_ptr_ = std::move(uniquely_accessed_pointers.second);
+          amgr->get_or_run<GatherUniquelyAccessedPointersPass>(stmt);
+      loop_unique_ptr_ = uniquely_accessed_pointers->ptrs;
+      loop_unique_arr_ptr_ = uniquely_accessed_pointers->arr_ptrs;
     }
     // We don't need to visit TLS/BLS prologues/epilogues.
     if (stmt->body) {
@@ -176,8 +180,8 @@ class DemoteAtomics : public BasicStmtVisitor {
     current_offloaded = nullptr;
   }
 
-  static bool run(IRNode *node) {
-    DemoteAtomics demoter;
+  static bool run(IRNode *node, AnalysisManager *amgr) {
+    DemoteAtomics demoter(amgr);
     bool modified = false;
     while (true) {
       node->accept(&demoter);
@@ -193,10 +197,20 @@ class DemoteAtomics : public BasicStmtVisitor {
 
 namespace irpass {
 
-bool demote_atomics(IRNode *root, const CompileConfig &config) {
+bool demote_atomics(IRNode *root,
+                    const CompileConfig &config,
+                    AnalysisManager *amgr) {
   TI_AUTO_PROF;
-  bool modified = DemoteAtomics::run(root);
+  AnalysisManager local_amgr;
+  if (amgr == nullptr) {
+    amgr = &local_amgr;
+  }
+  bool modified = DemoteAtomics::run(root, amgr);
   type_check(root, config);
+  if (modified) {
+    amgr->invalidate(PreservedAnalyses::none()
+                         .preserve<GatherUniquelyAccessedPointersPass>());
+  }
   return modified;
 }
 
@@ -855,6 +855,20 @@ class IRPrinter : public IRVisitor {
     print(result);
   }
 
+  void visit(VectorPackStmt *stmt) override {
+    std::vector<std::string> values;
+    for (auto value : stmt->values) {
+      values.push_back(value->name());
+    }
+    print("{}{} = vector_pack({})", stmt->type_hint(), stmt->name(),
+          fmt::join(values, ", "));
+  }
+
+  void visit(VectorExtractStmt *stmt) override {
+    print("{}{} = vector_extract({}, {})", stmt->type_hint(), stmt->name(),
+          stmt->vector->name(), stmt->lane);
+  }
+
   void visit(GetElementStmt *stmt) override {
     print("{}{} = get_element({}, {})", stmt->type_hint(), stmt->name(),
           stmt->src->name(), fmt::join(stmt->index, ", "));
@@ -514,40 +514,49 @@ void full_simplify(IRNode *root,
                    const FullSimplifyPass::Args &args) {
   TI_AUTO_PROF;
   if (config.advanced_optimization) {
-    bool first_iteration = true;
-    while (true) {
-      bool modified = false;
-      if (extract_constant(root, config))
-        modified = true;
-      if (unreachable_code_elimination(root))
-        modified = true;
-      if (binary_op_simplify(root, config))
-        modified = true;
-      if (config.constant_folding && constant_fold(root))
-        modified = true;
-      if (die(root))
-        modified = true;
-      if (alg_simp(root, config))
-        modified = true;
-      if (loop_invariant_code_motion(root, config))
-        modified = true;
-      if (die(root))
-        modified = true;
-      if (simplify(root, config))
-        modified = true;
-      if (die(root))
-        modified = true;
-      if (config.opt_level > 0 && whole_kernel_cse(root))
-        modified = true;
+    // None of the passes below keeps any analysis up to date
+    AnalysisManager amgr;
+    PassManager passes(&amgr);
+    auto add_pass = [&](const PassID &name, std::function<bool(IRNode *)> func,
+                        bool run_once = false) {
+      passes.add_pass(
+          name, [func](IRNode *root, AnalysisManager *) { return func(root); },
+          PreservedAnalyses::none(), run_once);
+    };
+    add_pass("extract_constant",
+             [&](IRNode *root) { return extract_constant(root, config); });
+    add_pass("unreachable_code_elimination", unreachable_code_elimination);
+    add_pass("binary_op_simplify",
+             [&](IRNode *root) { return binary_op_simplify(root, config); });
+    if (config.constant_folding) {
+      add_pass("constant_fold", constant_fold);
+    }
+    add_pass("die", die);
+    add_pass("alg_simp", [&](IRNode *root) { return alg_simp(root, config); });
+    add_pass("loop_invariant_code_motion", [&](IRNode *root) {
+      return loop_invariant_code_motion(root, config);
+    });
+    add_pass("die", die);
+    add_pass("simplify", [&](IRNode *root) { return simplify(root, config); });
+    add_pass("die", die);
+    if (config.opt_level > 0) {
+      add_pass("whole_kernel_cse", whole_kernel_cse);
+    }
+    if (config.opt_level > 0 && config.cfg_optimization) {
       // Don't do this time-consuming optimization pass again if the IR is
       // not modified.
-      if (config.opt_level > 0 && first_iteration && config.cfg_optimization &&
-          cfg_optimization(root, args.after_lower_access, args.autodiff_enabled,
-                           !config.real_matrix_scalarize))
-        modified = true;
-      first_iteration = false;
-      if (!modified)
-        break;
+      add_pass(
+          "cfg_optimization",
+          [&](IRNode *root) {
+            return cfg_optimization(root, args.after_lower_access,
+                                    args.autodiff_enabled,
+                                    !config.real_matrix_scalarize);
+          },
+          /*run_once=*/true);
+    }
+    passes.run_until_fixpoint(root);
+    if (config.print_compile_time_breakdown) {
+      TI_INFO("full_simplify: {}", passes.timing_summary());
     }
     return;
   }
@@ -0,0 +1,483 @@
+// The superword-level parallelism (SLP) vectorizer
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+
+#include "taichi/ir/analysis.h"
+#include "taichi/ir/ir.h"
+#include "taichi/ir/statements.h"
+#include "taichi/ir/transforms.h"
+#include "taichi/ir/type_factory.h"
+#include "taichi/ir/type_utils.h"
+#include "taichi/ir/visitors.h"
+#include "taichi/program/compile_config.h"
+#include "taichi/system/profiler.h"
+
+/* After scalarization, elementwise matrix math is a sequence of isomorphic
+scalar operations, which LLVM often fails to pack back into SIMD instructions.
+This pass does it on CHI IR, block by block:
+
+1. Seeds: runs of isomorphic operations (same op, same type) which do not
+depend on each other form packs of at most as many lanes as a SIMD register
+holds (CompileConfig::simd_width 32-bit lanes, capped by max_vector_width).
+2. Extension: if the operands on one side of a pack are isomorphic operations
+themselves, they form a new pack, lane by lane.
+3. Packs whose lanes are used before the vector operation could be placed are
+dropped, and so are groups of connected packs which don't pay off: each pack
+saves (lanes - 1) operations, while packing scalar operands into a vector and
+extracting lanes used outside of the packs cost one operation per lane.
+4. Each remaining pack becomes, at the place of its last lane,
+
+    <n x f32> a = vector_pack(lhs0, lhs1, ...)   (unless lhs is a pack)
+    <n x f32> b = vector_pack(rhs0, rhs1, ...)   (unless rhs is a pack)
+    <n x f32> c = a op b
+    f32 c0 = vector_extract(c, 0)                (if used outside of packs)
+    ...
+
+Only floating-point arithmetic is packed, whose LLVM codegen is the same for
+scalars and vectors.
+*/
+
+namespace taichi::lang {
+
+namespace {
+
+BinaryOpStmt *as_packable(Stmt *stmt) {
+  auto bin = stmt->cast<BinaryOpStmt>();
+  if (!bin) {
+    return nullptr;
+  }
+  switch (bin->op_type) {
+    case BinaryOpType::add:
+    case BinaryOpType::sub:
+    case BinaryOpType::mul:
+    case BinaryOpType::div:
+    case BinaryOpType::max:
+    case BinaryOpType::min:
+      break;
+    default:
+      return nullptr;
+  }
+  auto type = bin->ret_type;
+  if (!type->is<PrimitiveType>() || !is_real(type) ||
+      type->is_primitive(PrimitiveTypeID::f16) || bin->lhs->ret_type != type ||
+      bin->rhs->ret_type != type) {
+    return nullptr;
+  }
+  return bin;
+}
+
+bool isomorphic(BinaryOpStmt *a, BinaryOpStmt *b) {
+  return a->op_type == b->op_type && a->ret_type == b->ret_type;
+}
+
+class SLPVectorize : public BasicStmtVisitor {
+ public:
+  using BasicStmtVisitor::visit;
+
+  explicit SLPVectorize(const CompileConfig &config) : config_(config) {
+  }
+
+  void visit(Block *block) override {
+    vectorize(block);
+    BasicStmtVisitor::visit(block);
+  }
+
+ private:
+  struct Pack {
+    std::vector<BinaryOpStmt *> lanes;
+    // The position of the last lane, where the vector operation goes
+    int position{0};
+    bool alive{true};
+  };
+
+  struct Use {
+    int position;  // of the statement of the block using it
+    Stmt *user;
+  };
+
+  int max_lanes(DataType type) const {
+    int lanes = config_.simd_width * 32 / data_type_bits(type);
+    return std::min(lanes, config_.max_vector_width);
+  }
+
+  void vectorize(Block *block) {
+    const int num_stmts = block->size();
+    positions_.clear();
+    for (int i = 0; i < num_stmts; i++) {
+      positions_[block->statements[i].get()] = i;
+    }
+    packs_.clear();
+    lane_of_.clear();
+
+    find_seeds(block);
+    if (packs_.empty()) {
+      return;
+    }
+    extend_packs();
+    gather_uses(block);
+    drop_illegal_packs();
+    drop_unprofitable_packs();
+    emit(block);
+  }
+
+  int position_of(Stmt *stmt) const {
+    auto it = positions_.find(stmt);
+    return it == positions_.end() ? -1 : it->second;
+  }
+
+  // Whether |stmt| depends on any of |stmts| through the statements of this
+  // block after |begin|.
+  bool depends_on(Stmt *stmt,
+                  const std::unordered_set<Stmt *> &stmts,
+                  int begin) const {
+    std::vector<Stmt *> to_visit{stmt};
+    std::unordered_set<Stmt *> visited{stmt};
+    while (!to_visit.empty()) {
+      auto now = to_visit.back();
+      to_visit.pop_back();
+      for (auto operand : now->get_operands()) {
+        if (!operand || position_of(operand) <= begin) {
+          continue;
+        }
+        if (stmts.count(operand)) {
+          return true;
+        }
+        if (visited.insert(operand).second) {
+          to_visit.push_back(operand);
+        }
+      }
+    }
+    return false;
+  }
+
+  bool independent(const std::vector<BinaryOpStmt *> &stmts) const {
+    int begin = -1;
+    for (auto stmt : stmts) {
+      int position = position_of(stmt);
+      begin = begin == -1 ? position : std::min(begin, position);
+    }
+    std::unordered_set<Stmt *> others(stmts.begin(), stmts.end());
+    for (auto stmt : stmts) {
+      others.erase(stmt);
+      bool dependent = depends_on(stmt, others, begin - 1);
+      others.insert(stmt);
+      if (dependent) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void add_pack(const std::vector<BinaryOpStmt *> &lanes) {
+    Pack pack;
+    pack.lanes = lanes;
+    for (int i = 0; i < (int)lanes.size(); i++) {
+      lane_of_[lanes[i]] = {(int)packs_.size(), i};
+      pack.position = std::max(pack.position, position_of(lanes[i]));
+    }
+    packs_.push_back(std::move(pack));
+  }
+
+  void find_seeds(Block *block) {
+    std::vector<BinaryOpStmt *> run;
+    std::unordered_set<Stmt *> run_set;
+    auto close_run = [&]() {
+      if (run.size() >= 2) {
+        add_pack(run);
+      }
+      run.clear();
+      run_set.clear();
+    };
+    for (auto &stmt : block->statements) {
+      // Other statements do not break a run
+      auto bin = as_packable(stmt.get());
+      if (!bin) {
+        continue;
+      }
+      if (!run.empty() &&
+          (!isomorphic(run[0], bin) ||
+           (int)run.size() >= max_lanes(run[0]->ret_type) ||
+           depends_on(bin, run_set, position_of(run[0]) - 1))) {
+        close_run();
+      }
+      run.push_back(bin);
+      run_set.insert(bin);
+    }
+    close_run();
+  }
+
+  void extend_packs() {
+    for (int p = 0; p < (int)packs_.size(); p++) {
+      for (int side = 0; side < 2; side++) {
+        std::vector<BinaryOpStmt *> operands;
+        std::unordered_set<Stmt *> distinct;
+        for (auto lane : packs_[p].lanes) {
+          auto operand = side == 0 ? lane->lhs : lane->rhs;
+          auto bin = as_packable(operand);
+          if (!bin || position_of(bin) == -1 || lane_of_.count(bin) ||
+              !distinct.insert(bin).second ||
+              (!operands.empty() && !isomorphic(operands[0], bin))) {
+            operands.clear();
+            break;
+          }
+          operands.push_back(bin);
+        }
+        if (!operands.empty() && independent(operands)) {
+          add_pack(operands);
+        }
+      }
+    }
+  }
+
+  void gather_uses(Block *block) {
+    uses_.clear();
+    for (int i = 0; i < (int)block->size(); i++) {
+      auto stmt = block->statements[i].get();
+      std::vector<Stmt *> users{stmt};
+      if (stmt->is_container_statement()) {
+        auto nested = irpass::analysis::gather_statements(
+            stmt, [](Stmt *) { return true; });
+        users.insert(users.end(), nested.begin(), nested.end());
+      }
+      for (auto user : users) {
+        for (auto operand : user->get_operands()) {
+          if (operand && lane_of_.count(operand)) {
+            uses_[operand].push_back({i, user});
+          }
+        }
+      }
+    }
+  }
+
+  // If one side of |pack| is exactly the lanes of an alive pack in order,
+  // returns that pack, otherwise -1.
+  int aligned_operand(const Pack &pack, int side) const {
+    int source = -1;
+    for (int i = 0; i < (int)pack.lanes.size(); i++) {
+      auto operand = side == 0 ? pack.lanes[i]->lhs : pack.lanes[i]->rhs;
+      auto it = lane_of_.find(operand);
+      if (it == lane_of_.end() || it->second.second != i ||
+          (source != -1 && it->second.first != source)) {
+        return -1;
+      }
+      source = it->second.first;
+    }
+    if (packs_[source].lanes.size() != pack.lanes.size() ||
+        !packs_[source].alive) {
+      return -1;
+    }
+    return source;
+  }
+
+  // Whether |user| reads |lane| through the vector of its pack
+  bool used_as_vector(Stmt *lane, Stmt *user) const {
+    auto it = lane_of_.find(user);
+    if (it == lane_of_.end() || !packs_[it->second.first].alive) {
+      return false;
+    }
+    auto &pack = packs_[it->second.first];
+    auto source = lane_of_.at(lane).first;
+    auto bin = pack.lanes[it->second.second];
+    return (bin->lhs == lane && aligned_operand(pack, 0) == source) ||
+           (bin->rhs == lane && aligned_operand(pack, 1) == source);
+  }
+
+  // The number of lanes of |pack| used as scalars, i.e. needing an extract
+  int num_extracts(const Pack &pack) const {
+    int result = 0;
+    for (auto lane : pack.lanes) {
+      auto it = uses_.find(lane);
+      if (it == uses_.end()) {
+        continue;
+      }
+      for (auto &use : it->second) {
+        if (!used_as_vector(lane, use.user)) {
+          result++;
+          break;
+        }
+      }
+    }
+    return result;
+  }
+
+  void drop_illegal_packs() {
+    // A lane used as a scalar before the position of the vector operation
+    // would be read before it is computed.
+    bool changed = true;
+    while (changed) {
+      changed = false;
+      for (auto &pack : packs_) {
+        if (!pack.alive) {
+          continue;
+        }
+        bool legal = true;
+        for (auto lane : pack.lanes) {
+          auto it = uses_.find(lane);
+          if (it == uses_.end()) {
+            continue;
+          }
+          for (auto &use : it->second) {
+            if (use.position <= pack.position &&
+                !used_as_vector(lane, use.user)) {
+              legal = false;
+            }
+          }
+        }
+        if (!legal) {
+          pack.alive = false;
+          changed = true;
+        }
+      }
+    }
+  }
+
+  int pack_cost(const Pack &pack, int side) const {
+    if (aligned_operand(pack, side) != -1) {
+      return 0;
+    }
+    bool all_same = true, all_const = true;
+    for (auto lane : pack.lanes) {
+      auto operand = side == 0 ? lane->lhs : lane->rhs;
+      auto first = side == 0 ? pack.lanes[0]->lhs : pack.lanes[0]->rhs;
+      all_same &= operand == first;
+      all_const &= operand->is<ConstStmt>();
+    }
+    if (all_const) {
+      return 0;  // Folded into a constant vector
+    }
+    return all_same ? 1 : pack.lanes.size();
+  }
+
+  void drop_unprofitable_packs() {
+    // Connected packs pay off together: the operands of the first ones are
+    // packed, the results of the last ones extracted.
+    std::vector<int> parent(packs_.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    std::function<int(int)> find = [&](int x) {
+      return parent[x] == x ? x : parent[x] = find(parent[x]);
+    };
+    for (int p = 0; p < (int)packs_.size(); p++) {
+      if (!packs_[p].alive) {
+        continue;
+      }
+      for (int side = 0; side < 2; side++) {
+        int source = aligned_operand(packs_[p], side);
+        if (source != -1) {
+          parent[find(source)] = find(p);
+        }
+      }
+    }
+    std::vector<int> savings(packs_.size(), 0);
+    for (int p = 0; p < (int)packs_.size(); p++) {
+      auto &pack = packs_[p];
+      if (pack.alive) {
+        savings[find(p)] += (int)pack.lanes.size() - 1 - pack_cost(pack, 0) -
+                            pack_cost(pack, 1) - num_extracts(pack);
+      }
+    }
+    for (int p = 0; p < (int)packs_.size(); p++) {
+      if (savings[find(p)] <= 0) {
+        packs_[p].alive = false;
+      }
+    }
+  }
+
+  void emit(Block *block) {
+    std::vector<int> order;
+    for (int p = 0; p < (int)packs_.size(); p++) {
+      if (packs_[p].alive) {
+        order.push_back(p);
+      }
+    }
+    if (order.empty()) {
+      return;
+    }
+    // The operands of a pack come from packs placed before it
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+      return packs_[a].position < packs_[b].position;
+    });
+    std::unordered_map<int, Stmt *> vectors;
+    std::unordered_map<Stmt *, Stmt *> replacements;
+    for (auto p : order) {
+      auto &pack = packs_[p];
+      const int num_lanes = pack.lanes.size();
+      auto element_type = pack.lanes[0]->ret_type;
+      auto vector_type =
+          TypeFactory::create_tensor_type({num_lanes}, element_type);
+      Stmt *last_lane = pack.lanes[0];
+      for (auto lane : pack.lanes) {
+        if (position_of(lane) > position_of(last_lane)) {
+          last_lane = lane;
+        }
+      }
+      Stmt *operands[2];
+      for (int side = 0; side < 2; side++) {
+        int source = aligned_operand(pack, side);
+        if (source != -1) {
+          operands[side] = vectors.at(source);
+          continue;
+        }
+        std::vector<Stmt *> values;
+        for (auto lane : pack.lanes) {
+          auto value = side == 0 ? lane->lhs : lane->rhs;
+          auto it = replacements.find(value);
+          values.push_back(it == replacements.end() ? value : it->second);
+        }
+        auto vector_pack = Stmt::make_typed<VectorPackStmt>(values);
+        vector_pack->ret_type = vector_type;
+        operands[side] = last_lane->insert_before_me(std::move(vector_pack));
+      }
+      auto vector_op = Stmt::make_typed<BinaryOpStmt>(
+          pack.lanes[0]->op_type, operands[0], operands[1]);
+      vector_op->ret_type = vector_type;
+      auto vector = last_lane->insert_before_me(std::move(vector_op));
+      vectors[p] = vector;
+      for (int i = 0; i < num_lanes; i++) {
+        auto extract = Stmt::make_typed<VectorExtractStmt>(vector, i);
+        extract->ret_type = element_type;
+        replacements[pack.lanes[i]] =
+            last_lane->insert_before_me(std::move(extract));
+      }
+    }
+
+    // Lanes only used by other packs leave unused extracts behind, which
+    // DIE removes.
+    for (auto stmt :
+         irpass::analysis::gather_statements(block, [](Stmt *) { return true; })) {
+      for (int i = 0; i < stmt->num_operands(); i++) {
+        auto it = replacements.find(stmt->operand(i));
+        if (it != replacements.end()) {
+          stmt->set_operand(i, it->second);
+        }
+      }
+    }
+    for (auto &[lane, _] : replacements) {
+      block->erase(lane);
+    }
+  }
+
+  const CompileConfig &config_;
+  std::unordered_map<Stmt *, int> positions_;
+  std::vector<Pack> packs_;
+  // The pack and the lane of each statement in a pack
+  std::unordered_map<Stmt *, std::pair<int, int>> lane_of_;
+  // The uses of the statements in packs by the statements of the block
+  std::unordered_map<Stmt *, std::vector<Use>> uses_;
+};
+
+}  // namespace
+
+namespace irpass {
+
+void slp_vectorize(IRNode *root, const CompileConfig &config) {
+  TI_AUTO_PROF;
+  SLPVectorize vectorizer(config);
+  root->accept(&vectorizer);
+  die(root);
+}
+
+}  // namespace irpass
+
+}  // namespace taichi::lang
@@ -50,6 +50,10 @@ Bitset::reference Bitset::operator[](int x) {
   return reference(vec_, x);
 }
 
+bool Bitset::test(int x) const {
+  return (vec_[x / kBits] >> (x % kBits)) & 1;
+}
+
 Bitset &Bitset::operator&=(const Bitset &other) {
   const int len = vec_.size();
   TI_ASSERT(len == other.vec_.size());
@@ -98,6 +102,23 @@ Bitset Bitset::operator~() const {
   return result;
 }
 
+Bitset &Bitset::operator-=(const Bitset &other) {
+  const int len = vec_.size();
+  TI_ASSERT(len == other.vec_.size());
+  for (int i = 0; i < len; i++) {
+    vec_[i] &= ~other.vec_[i];
+  }
+  return *this;
+}
+
+bool Bitset::operator==(const Bitset &other) const {
+  return vec_ == other.vec_;
+}
+
+bool Bitset::operator!=(const Bitset &other) const {
+  return vec_ != other.vec_;
+}
+
 int Bitset::find_first_one() const {
   return lower_bound(0);
 }
@@ -174,12 +174,17 @@ class Bitset {
   bool any() const;
   bool none() const;
   reference operator[](int x);
+  bool test(int x) const;
   Bitset &operator&=(const Bitset &other);
   Bitset operator&(const Bitset &other) const;
   Bitset &operator|=(const Bitset &other);
   Bitset operator|(const Bitset &other) const;
   Bitset &operator^=(const Bitset &other);
   Bitset operator~() const;
+  // Same as *this &= ~other, without the temporary.
+  Bitset &operator-=(const Bitset &other);
+  bool operator==(const Bitset &other) const;
+  bool operator!=(const Bitset &other) const;
 
   // Find the place of the first "1", or return -1 if it doesn't exist.
   int find_first_one() const;
@@ -23,6 +23,11 @@ constexpr char kLlvmCacheFilenameBCExt[] = "bc";
 constexpr char kSpirvCacheFilenameExt[] = "spv";
 constexpr char kMetalCacheFilenameExt[] = "metal";
 constexpr char kTiCacheFilenameExt[] = "tic";
+// Files of the PackedKernelCache, and the files it writes before renaming
+// them over the old ones
+constexpr char kPackedCacheDataFilename[] = "ticache.pack";
+constexpr char kPackedCacheIndexFilename[] = "ticache.idx";
+constexpr char kPackedCacheTmpFilenameExt[] = "tmp";
 constexpr char kLlvmCachSubPath[] = "llvm";
 constexpr char kSpirvCacheSubPath[] = "gfx";
 constexpr char kMetalCacheSubPath[] = "metal";
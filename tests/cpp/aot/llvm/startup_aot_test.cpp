@@ -0,0 +1,95 @@
+#include <chrono>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "taichi/program/kernel_profiler.h"
+#include "taichi/runtime/llvm/llvm_runtime_executor.h"
+#include "taichi/runtime/cpu/aot_module_loader_impl.h"
+#include "taichi/program/launch_context_builder.h"
+
+#define TI_RUNTIME_HOST
+#include "taichi/program/context.h"
+#undef TI_RUNTIME_HOST
+
+namespace taichi::lang {
+
+namespace {
+
+// Must match many_kernels_aot_test_.py
+constexpr int kNumKernels = 200;
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+void check_kernel(aot::Module *mod, int k) {
+  constexpr int kN = 10;
+  auto *kernel = mod->get_kernel(fmt::format("run_{}", k));
+  ASSERT_NE(kernel, nullptr);
+  LaunchContextBuilder builder(kernel);
+  builder.set_arg(0, kN);
+  kernel->launch(builder);
+  EXPECT_EQ(builder.get_struct_ret_int({0}), k * kN * (kN - 1) / 2 + kN);
+}
+
+}  // namespace
+
+// Checks that every kernel of a module with many kernels runs correctly when
+// loaded lazily and with prefetching, and reports the cold start times. The
+// timings are not asserted on, since wall-clock ratios depend on the load of
+// the machine.
+TEST(LlvmAotTest, CpuStartup) {
+  CompileConfig cfg;
+  cfg.arch = Arch::x64;
+  cfg.kernel_profiler = false;
+  constexpr KernelProfilerBase *kNoProfiler = nullptr;
+  LlvmRuntimeExecutor exec{cfg, kNoProfiler};
+  uint64 *result_buffer{nullptr};
+  exec.materialize_runtime(kNoProfiler, &result_buffer);
+
+  cpu::AotModuleParams aot_params;
+  aot_params.module_path = getenv("TAICHI_AOT_FOLDER_PATH");
+  aot_params.executor_ = &exec;
+
+  double one_lazy_time = 0;
+  {
+    auto start = std::chrono::steady_clock::now();
+    auto mod = cpu::make_aot_module(aot_params);
+    check_kernel(mod.get(), kNumKernels - 1);
+    one_lazy_time = seconds_since(start);
+    TI_INFO("Loading the module and one kernel lazily: {:.3f} s",
+            one_lazy_time);
+  }
+  double all_lazy_time = 0;
+  {
+    auto start = std::chrono::steady_clock::now();
+    auto mod = cpu::make_aot_module(aot_params);
+    for (int k = 0; k < kNumKernels; k++) {
+      check_kernel(mod.get(), k);
+    }
+    all_lazy_time = seconds_since(start);
+    TI_INFO("Loading the module and {} kernels lazily: {:.3f} s",
+            kNumKernels, all_lazy_time);
+  }
+  double prefetch_time = 0;
+  {
+    auto start = std::chrono::steady_clock::now();
+    aot_params.num_prefetch_threads =
+        std::max(1, (int)std::thread::hardware_concurrency());
+    auto mod = cpu::make_aot_module(aot_params);
+    for (int k = 0; k < kNumKernels; k++) {
+      check_kernel(mod.get(), k);
+    }
+    prefetch_time = seconds_since(start);
+    TI_INFO(
+        "Loading the module and {} kernels on {} threads: {:.3f} s, {:.2f}x "
+        "the speed of lazy loading",
+        kNumKernels, aot_params.num_prefetch_threads, prefetch_time,
+        all_lazy_time / prefetch_time);
+  }
+}
+
+}  // namespace taichi::lang
@@ -0,0 +1,39 @@
+import argparse
+import os
+
+import taichi as ti
+
+NUM_KERNELS = 200
+
+
+def make_kernel(k):
+    @ti.kernel
+    def run(n: ti.i32) -> ti.i32:
+        s = 0
+        for i in range(n):
+            s += i * k + 1
+        return s
+
+    return run
+
+
+def compile_many_kernels_aot(arch):
+    ti.init(arch=arch)
+
+    assert "TAICHI_AOT_FOLDER_PATH" in os.environ.keys()
+    dir_name = str(os.environ["TAICHI_AOT_FOLDER_PATH"])
+
+    m = ti.aot.Module()
+    for k in range(NUM_KERNELS):
+        m.add_kernel(make_kernel(k), template_args={}, name=f'run_{k}')
+    m.save(dir_name)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--arch", type=str)
+    args = parser.parse_args()
+    if args.arch == "cpu":
+        compile_many_kernels_aot(arch=ti.cpu)
+    else:
+        assert False
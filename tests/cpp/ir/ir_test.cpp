@@ -41,5 +41,44 @@ TEST(Block, EraseRange) {
   EXPECT_EQ(b.locate(stmt_ptrs.back()), 1);
 }
 
+TEST(IRArena, StatementOutlivesRoot) {
+  auto root = std::make_unique<Block>();
+  root->arena = IRArena::create();
+  std::unique_ptr<Stmt> extracted;
+  {
+    IRArena::Scope arena_scope(get_ir_arena(root.get()));
+    for (int i = 0; i < 1000; ++i) {
+      root->insert(make_const_i32(i));
+    }
+    EXPECT_GT(root->arena->allocated_bytes(), 0);
+  }
+  extracted = root->extract(/*location=*/10);
+  root.reset();
+  // The arena is only freed with its last statement
+  EXPECT_EQ(extracted->as<ConstStmt>()->val.val_i32, 10);
+
+  // Statements made outside of a scope come from the heap
+  EXPECT_EQ(IRArena::current(), nullptr);
+  auto s = make_const_i32(1);
+  EXPECT_EQ(s->as<ConstStmt>()->val.val_i32, 1);
+}
+
+TEST(IRArena, FreedStatementIsReused) {
+  auto root = std::make_unique<Block>();
+  root->arena = IRArena::create();
+  IRArena::Scope arena_scope(get_ir_arena(root.get()));
+  root->insert(make_const_i32(0));
+  auto allocated_bytes = root->arena->allocated_bytes();
+  auto num_reused = IRArena::get_stats().num_reused;
+  // Replacing a statement over and over takes no more memory from the arena
+  for (int i = 1; i < 100; ++i) {
+    root->extract(/*location=*/0).reset();
+    root->insert(make_const_i32(i));
+  }
+  EXPECT_EQ(root->arena->allocated_bytes(), allocated_bytes);
+  EXPECT_EQ(IRArena::get_stats().num_reused - num_reused, 99);
+  EXPECT_EQ(root->statements[0]->as<ConstStmt>()->val.val_i32, 99);
+}
+
 }  // namespace
 }  // namespace taichi::lang
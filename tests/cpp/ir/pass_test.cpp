@@ -0,0 +1,74 @@
+#include "gtest/gtest.h"
+
+#include "taichi/ir/pass.h"
+#include "taichi/ir/statements.h"
+
+namespace taichi::lang {
+
+namespace {
+
+class CountStatementsPass : public Pass {
+ public:
+  static const PassID id;
+
+  struct Result {
+    int num_statements;
+  };
+
+  static int num_runs;
+
+  static Result run(IRNode *root) {
+    num_runs++;
+    return {(int)root->as<Block>()->size()};
+  }
+};
+
+const PassID CountStatementsPass::id = "CountStatementsPass";
+int CountStatementsPass::num_runs = 0;
+
+}  // namespace
+
+TEST(AnalysisManager, CachesUntilInvalidated) {
+  auto block = std::make_unique<Block>();
+  block->push_back<ConstStmt>(TypedConstant(1));
+  AnalysisManager amgr;
+  CountStatementsPass::num_runs = 0;
+
+  EXPECT_EQ(amgr.get_or_run<CountStatementsPass>(block.get())->num_statements,
+            1);
+  EXPECT_EQ(amgr.get_or_run<CountStatementsPass>(block.get())->num_statements,
+            1);
+  EXPECT_EQ(CountStatementsPass::num_runs, 1);
+
+  block->push_back<ConstStmt>(TypedConstant(2));
+  amgr.invalidate(PreservedAnalyses::none().preserve<CountStatementsPass>());
+  EXPECT_EQ(CountStatementsPass::num_runs, 1);
+  amgr.invalidate(PreservedAnalyses::none());
+  EXPECT_EQ(amgr.get_or_run<CountStatementsPass>(block.get())->num_statements,
+            2);
+  EXPECT_EQ(CountStatementsPass::num_runs, 2);
+}
+
+TEST(PassManager, SkipsPassesAtFixpoint) {
+  auto block = std::make_unique<Block>();
+  AnalysisManager amgr;
+  PassManager passes(&amgr);
+  int remaining = 3;
+  int num_checks = 0;
+  // Modifies the IR three times, one per run
+  passes.add_pass("shrink", [&](IRNode *, AnalysisManager *) {
+    return remaining-- > 0;
+  });
+  passes.add_pass("check", [&](IRNode *, AnalysisManager *) {
+    num_checks++;
+    return false;
+  });
+
+  EXPECT_TRUE(passes.run_until_fixpoint(block.get()));
+  // The last run of "shrink" does not modify the IR, which "check" has seen
+  // already.
+  EXPECT_EQ(num_checks, 3);
+  EXPECT_EQ(remaining, -1);
+}
+
+}  // namespace taichi::lang
@@ -0,0 +1,146 @@
+#include <filesystem>
+#include <fstream>
+
+#include "gtest/gtest.h"
+#include "taichi/compilation_manager/packed_kernel_cache.h"
+
+namespace taichi::lang {
+
+namespace {
+
+namespace oc = offline_cache;
+
+// Creates an empty directory for the running test under the gtest temp dir
+std::string make_temp_dir() {
+  const auto *test_info =
+      testing::UnitTest::GetInstance()->current_test_info();
+  auto path = std::filesystem::path(testing::TempDir()) /
+              fmt::format("{}.{}", test_info->test_suite_name(),
+                          test_info->name());
+  std::filesystem::remove_all(path);
+  std::filesystem::create_directories(path);
+  return path.string();
+}
+
+std::vector<PackedKernelCache::Entry> gen_entries(int n) {
+  std::vector<PackedKernelCache::Entry> entries;
+  for (int i = 0; i < n; ++i) {
+    entries.push_back(
+        {fmt::format("kernel-{}", i), std::string(100 + i, 'a' + i % 26)});
+  }
+  return entries;
+}
+
+int count_found(PackedKernelCache &cache,
+                const std::vector<PackedKernelCache::Entry> &entries) {
+  int found = 0;
+  for (const auto &e : entries) {
+    std::string_view data;
+    if (cache.find(e.kernel_key, &data)) {
+      EXPECT_EQ(data, e.data);
+      ++found;
+    }
+  }
+  return found;
+}
+
+}  // namespace
+
+TEST(OfflineCache, PackedCacheCommitAndFind) {
+  auto path = make_temp_dir();
+  auto entries = gen_entries(100);
+
+  PackedKernelCache cache(path);
+  std::string_view data;
+  EXPECT_FALSE(cache.find(entries[0].kernel_key, &data));
+  EXPECT_TRUE(cache.commit(entries, {}));
+  EXPECT_EQ(cache.num_kernels(), entries.size());
+  EXPECT_EQ(count_found(cache, entries), entries.size());
+  EXPECT_FALSE(cache.find("kernel-not-cached", &data));
+
+  // Committing the same kernels again appends nothing
+  auto size = cache.size_bytes();
+  auto file_size = std::filesystem::file_size(
+      std::filesystem::path(path) / PackedKernelCache::kDataFilename);
+  EXPECT_TRUE(cache.commit(entries, {entries[0].kernel_key}));
+  EXPECT_EQ(cache.num_kernels(), entries.size());
+  EXPECT_EQ(cache.size_bytes(), size);
+  EXPECT_EQ(std::filesystem::file_size(std::filesystem::path(path) /
+                                       PackedKernelCache::kDataFilename),
+            file_size);
+
+  std::filesystem::remove_all(path);
+}
+
+TEST(OfflineCache, PackedCacheSharedBetweenInstances) {
+  auto path = make_temp_dir();
+  auto entries = gen_entries(20);
+  std::vector<PackedKernelCache::Entry> first(entries.begin(),
+                                              entries.begin() + 10);
+  std::vector<PackedKernelCache::Entry> second(entries.begin() + 10,
+                                               entries.end());
+
+  PackedKernelCache a(path);
+  PackedKernelCache b(path);
+  EXPECT_TRUE(a.commit(first, {}));
+  EXPECT_TRUE(b.commit(second, {}));
+  // |a| sees the records appended by |b| once it commits again
+  EXPECT_TRUE(a.commit({}, {first[0].kernel_key}));
+  EXPECT_EQ(a.num_kernels(), entries.size());
+  EXPECT_EQ(count_found(a, entries), entries.size());
+
+  PackedKernelCache c(path);
+  EXPECT_EQ(count_found(c, entries), entries.size());
+
+  std::filesystem::remove_all(path);
+}
+
+TEST(OfflineCache, PackedCacheClean) {
+  auto path = make_temp_dir();
+  auto entries = gen_entries(40);
+  auto data_path =
+      std::filesystem::path(path) / PackedKernelCache::kDataFilename;
+
+  PackedKernelCache cache(path);
+  EXPECT_TRUE(cache.commit(entries, {}));
+  auto file_size = std::filesystem::file_size(data_path);
+
+  // Below the size limit, nothing is removed
+  cache.clean(oc::LRU, cache.size_bytes() + 1, 0.25);
+  EXPECT_EQ(cache.num_kernels(), entries.size());
+
+  cache.clean(oc::LRU, 0, 0.25);
+  EXPECT_EQ(cache.num_kernels(), 30);
+  EXPECT_EQ(count_found(cache, entries), 30);
+  EXPECT_LT(std::filesystem::file_size(data_path), file_size);
+
+  cache.clean(oc::FIFO, 0, 0.5);
+  EXPECT_EQ(cache.num_kernels(), 15);
+  EXPECT_EQ(count_found(cache, entries), 15);
+
+  // A fresh instance reads the compacted files
+  PackedKernelCache other(path);
+  EXPECT_EQ(count_found(other, entries), 15);
+
+  std::filesystem::remove_all(path);
+}
+
+TEST(OfflineCache, PackedCacheRemovedByCleanFiles) {
+  auto path = make_temp_dir();
+  auto dir = std::filesystem::path(path);
+
+  PackedKernelCache cache(path);
+  EXPECT_TRUE(cache.commit(gen_entries(10), {}));
+  // Left behind by a writer that did not get to rename it
+  std::ofstream(dir / "ticache.idx.tmp") << "partial";
+
+  EXPECT_EQ(oc::clean_offline_cache_files(path), 3);
+  EXPECT_FALSE(std::filesystem::exists(dir / PackedKernelCache::kDataFilename));
+  EXPECT_FALSE(
+      std::filesystem::exists(dir / PackedKernelCache::kIndexFilename));
+  EXPECT_FALSE(std::filesystem::exists(dir / "ticache.idx.tmp"));
+
+  std::filesystem::remove_all(path);
+}
+
+}  // namespace taichi::lang
@@ -0,0 +1,142 @@
+#include "gtest/gtest.h"
+
+#include "taichi/ir/analysis.h"
+#include "taichi/ir/ir_builder.h"
+#include "taichi/ir/statements.h"
+#include "taichi/ir/transforms.h"
+#include "tests/cpp/program/test_program.h"
+
+namespace taichi::lang {
+
+class SLPVectorizeTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    tp_.setup();
+    config_.simd_width = 8;
+    config_.max_vector_width = 8;
+  }
+
+  template <typename T>
+  static int count(Block *block) {
+    return irpass::analysis::gather_statements(
+               block, [](Stmt *stmt) { return stmt->is<T>(); })
+        .size();
+  }
+
+  static int count_vector_ops(Block *block) {
+    return irpass::analysis::gather_statements(
+               block,
+               [](Stmt *stmt) {
+                 return stmt->is<BinaryOpStmt>() &&
+                        stmt->ret_type->is<TensorType>();
+               })
+        .size();
+  }
+
+  TestProgram tp_;
+  CompileConfig config_;
+};
+
+TEST_F(SLPVectorizeTest, ElementwiseChain) {
+  IRBuilder builder;
+  auto f32 = get_data_type<float32>();
+  // y[k] = (x[k] * s + 1) * 2 - 0.5 for k = 0..3
+  std::vector<Stmt *> x;
+  for (int k = 0; k < 4; k++) {
+    x.push_back(builder.create_arg_load(k, f32, false));
+  }
+  auto *s = builder.create_arg_load(4, f32, false);
+  std::vector<Stmt *> y = x;
+  for (auto &v : y) {
+    v = builder.create_mul(v, s);
+  }
+  for (auto &v : y) {
+    v = builder.create_add(v, builder.get_float32(1.0f));
+  }
+  for (auto &v : y) {
+    v = builder.create_mul(v, builder.get_float32(2.0f));
+  }
+  for (auto &v : y) {
+    v = builder.create_sub(v, builder.get_float32(0.5f));
+  }
+  for (auto *v : y) {
+    builder.create_local_store(builder.create_local_var(f32), v);
+  }
+  auto ir = builder.extract_ir();
+  auto *block = ir->as<Block>();
+  irpass::type_check(block, config_);
+
+  irpass::slp_vectorize(block, config_);
+
+  // Each level of the chain becomes one 4-lane operation. Only x, s and the
+  // constants are packed, and only the results of the last level are
+  // extracted.
+  EXPECT_EQ(count_vector_ops(block), 4);
+  EXPECT_EQ(count<VectorPackStmt>(block), 5);
+  EXPECT_EQ(count<VectorExtractStmt>(block), 4);
+  EXPECT_EQ(count<BinaryOpStmt>(block), 4);
+  for (auto *stmt : irpass::analysis::gather_statements(
+           block, [](Stmt *stmt) { return stmt->is<VectorPackStmt>(); })) {
+    EXPECT_EQ(stmt->ret_type->as<TensorType>()->get_num_elements(), 4);
+  }
+  for (auto *stmt : irpass::analysis::gather_statements(
+           block, [](Stmt *stmt) { return stmt->is<LocalStoreStmt>(); })) {
+    EXPECT_TRUE(stmt->as<LocalStoreStmt>()->val->is<VectorExtractStmt>());
+  }
+}
+
+TEST_F(SLPVectorizeTest, UnprofitablePackIsDropped) {
+  IRBuilder builder;
+  auto f32 = get_data_type<float32>();
+  // y[k] = a[k] + b[k] for k = 0..3: packing both sides and extracting every
+  // lane costs more than the three saved additions.
+  std::vector<Stmt *> a, b, y;
+  for (int k = 0; k < 4; k++) {
+    a.push_back(builder.create_arg_load(k, f32, false));
+    b.push_back(builder.create_arg_load(k + 4, f32, false));
+  }
+  for (int k = 0; k < 4; k++) {
+    y.push_back(builder.create_add(a[k], b[k]));
+  }
+  for (auto *v : y) {
+    builder.create_local_store(builder.create_local_var(f32), v);
+  }
+  auto ir = builder.extract_ir();
+  auto *block = ir->as<Block>();
+  irpass::type_check(block, config_);
+  auto num_stmts = block->size();
+
+  irpass::slp_vectorize(block, config_);
+
+  EXPECT_EQ(count_vector_ops(block), 0);
+  EXPECT_EQ(count<VectorPackStmt>(block), 0);
+  EXPECT_EQ(count<VectorExtractStmt>(block), 0);
+  EXPECT_EQ(block->size(), num_stmts);
+}
+
+TEST_F(SLPVectorizeTest, IntegerOpsAreNotPacked) {
+  IRBuilder builder;
+  auto i32 = get_data_type<int32>();
+  std::vector<Stmt *> y;
+  for (int k = 0; k < 4; k++) {
+    y.push_back(builder.create_arg_load(k, i32, false));
+  }
+  for (int level = 0; level < 4; level++) {
+    for (auto &v : y) {
+      v = builder.create_mul(v, builder.get_int32(3));
+    }
+  }
+  for (auto *v : y) {
+    builder.create_local_store(builder.create_local_var(i32), v);
+  }
+  auto ir = builder.extract_ir();
+  auto *block = ir->as<Block>();
+  irpass::type_check(block, config_);
+
+  irpass::slp_vectorize(block, config_);
+
+  EXPECT_EQ(count_vector_ops(block), 0);
+  EXPECT_EQ(count<VectorPackStmt>(block), 0);
+}
+
+}  // namespace taichi::lang
@@ -95,8 +95,8 @@ user_api[ti.Field] = [
     'parent', 'shape', 'snode', 'to_numpy', 'to_paddle', 'to_torch'
 ]
 user_api[ti.FieldsBuilder] = [
-    'bitmasked', 'deactivate_all', 'dense', 'dynamic', 'finalize', 'lazy_dual',
-    'lazy_grad', 'place', 'pointer', 'quant_array'
+    'bitmasked', 'deactivate_all', 'dense', 'dynamic', 'finalize', 'hash',
+    'lazy_dual', 'lazy_grad', 'place', 'pointer', 'quant_array'
 ]
 user_api[ti.math] = [
     'acos', 'asin', 'atan2', 'cconj', 'cdiv', 'ceil', 'cexp', 'cinv', 'clamp',
@@ -121,7 +121,7 @@ user_api[ti.MatrixNdarray] = [
 user_api[ti.Ndarray] = ['copy_from', 'element_shape', 'fill', 'get_type']
 user_api[ti.Texture] = ['from_field', 'from_image', 'from_ndarray', 'to_image']
 user_api[ti.SNode] = [
-    'bitmasked', 'deactivate_all', 'dense', 'dynamic', 'lazy_dual',
+    'bitmasked', 'deactivate_all', 'dense', 'dynamic', 'hash', 'lazy_dual',
     'lazy_grad', 'parent', 'place', 'pointer', 'quant_array', 'shape'
 ]
 user_api[ti.ScalarField] = [
@@ -315,3 +315,96 @@ def test_append_matrix_in_struct():
             for k in range(4):
                 assert f[i, j].b[k // 2, k % 2] == i * j * (k + 1) % 256
             assert f[i, j].c == i * j * 5000 % 65536
+
+
+@test_utils.test(require=ti.extension.sparse, exclude=[ti.metal])
+def test_dynamic_many_chunks():
+    x = ti.field(ti.i32)
+    n = 20000
+
+    ti.root.dense(ti.i, 4).dynamic(ti.j, n, chunk_size=4).place(x)
+
+    @ti.kernel
+    def fill():
+        for i in range(4):
+            for j in range(n):
+                ti.append(x.parent(), i, j * (i + 1))
+
+    @ti.kernel
+    def check() -> ti.i32:
+        bad = 0
+        for i, j in x:
+            if x[i, j] != j * (i + 1):
+                bad += 1
+        return bad
+
+    @ti.kernel
+    def clear():
+        for i in range(4):
+            ti.deactivate(x.parent(), [i])
+
+    for _ in range(2):
+        fill()
+        assert check() == 0
+        assert x[3, n - 1] == (n - 1) * 4
+        clear()
+        assert x[3, n - 1] == 0
+
+
+@test_utils.test(require=ti.extension.sparse, exclude=[ti.metal])
+def test_dynamic_fill_to_capacity():
+    x = ti.field(ti.i32)
+    # 13 chunks do not fill the last segment of the chunk directory
+    n = 13
+
+    ti.root.dense(ti.i, 2).dynamic(ti.j, n, chunk_size=1).place(x)
+
+    @ti.kernel
+    def fill():
+        for i in range(2):
+            for j in range(n):
+                ti.append(x.parent(), i, j + i * 100)
+
+    @ti.kernel
+    def length(i: ti.i32) -> ti.i32:
+        return ti.length(x.parent(), i)
+
+    for _ in range(2):
+        fill()
+        for i in range(2):
+            assert length(i) == n
+            for j in range(n):
+                assert x[i, j] == j + i * 100
+        x.parent().deactivate_all()
+
+
+@test_utils.test(require=ti.extension.sparse, exclude=[ti.metal])
+def test_dynamic_under_pointer_reuses_directories():
+    x = ti.field(ti.i32)
+    n = 64
+
+    ti.root.pointer(ti.i, 4).dynamic(ti.j, n, chunk_size=4).place(x)
+
+    @ti.kernel
+    def fill(m: ti.i32):
+        for i in range(4):
+            for j in range(m):
+                ti.append(x.parent(), i, j * 4 + i)
+
+    @ti.kernel
+    def check(m: ti.i32) -> ti.i32:
+        err = 0
+        for i in range(4):
+            if ti.length(x.parent(), i) != m:
+                err += 1
+            for j in range(m):
+                if x[i, j] != j * 4 + i:
+                    err += 1
+        return err
+
+    # Each round takes the directories given up by the previous one
+    for m in [n, 5, n // 2]:
+        fill(m)
+        assert check(m) == 0
+        x.parent().parent().deactivate_all()
+        assert x[0, 0] == 0
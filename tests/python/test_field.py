@@ -367,3 +367,40 @@ def test_write_u64():
     x = ti.field(ti.u64, shape=())
     x[None] = 2**64 - 1
     assert x[None] == 2**64 - 1
+
+
+@test_utils.test()
+def test_field_gather_scatter():
+    x = ti.field(ti.f32, shape=(16, 8))
+    indices = np.array([[i, (i * 3) % 8] for i in range(16)], dtype=np.int32)
+    x.scatter(indices, np.arange(16, dtype=np.float32) * 0.5)
+    for i in range(16):
+        assert x[i, (i * 3) % 8] == i * 0.5
+    assert x[0, 1] == 0
+    np.testing.assert_allclose(x.gather(indices),
+                               np.arange(16, dtype=np.float32) * 0.5)
+
+
+@test_utils.test(require=ti.extension.sparse)
+def test_field_gather_scatter_sparse():
+    x = ti.field(ti.i32)
+    ti.root.pointer(ti.i, 8).dense(ti.i, 4).place(x)
+    indices = np.array([3, 9, 30], dtype=np.int32)
+    x.scatter(indices, np.array([1, 2, 3], dtype=np.int32))
+    assert x[9] == 2
+    assert list(x.gather(np.array([3, 4, 30, 31]))) == [1, 0, 3, 0]
+
+
+@test_utils.test()
+def test_field_gather_scatter_out_of_bound():
+    x = ti.field(ti.f32, shape=(16, 8))
+    with pytest.raises(AssertionError, match=r"with indices \(16, 0\)"):
+        x.scatter(np.array([[0, 0], [16, 0]]), np.zeros(2, dtype=np.float32))
+    with pytest.raises(AssertionError):
+        x.gather(np.array([[0, -1]]))
+    y = ti.field(ti.i32)
+    ti.root.dense(ti.i, 8).place(y, offset=-4)
+    y.scatter(np.array([-4, 3]), np.array([1, 2], dtype=np.int32))
+    assert list(y.gather(np.array([-4, 3]))) == [1, 2]
+    with pytest.raises(AssertionError):
+        y.gather(np.array([4]))
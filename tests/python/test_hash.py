@@ -0,0 +1,154 @@
+import pytest
+
+import taichi as ti
+from tests import test_utils
+
+
+@test_utils.test(arch=ti.cpu)
+def test_hash_activate_and_read():
+    x = ti.field(ti.i32)
+    n = 1 << 20
+
+    ti.root.hash(ti.i, n).place(x)
+
+    @ti.kernel
+    def fill():
+        for i in range(1000):
+            x[i * 997] = i + 1
+
+    fill()
+    for i in range(1000):
+        assert x[i * 997] == i + 1
+    assert x[1] == 0
+
+
+@test_utils.test(arch=ti.cpu)
+def test_hash_struct_for():
+    x = ti.field(ti.i32)
+    s = ti.field(ti.i32, shape=())
+    n = 1 << 20
+
+    ti.root.hash(ti.i, n).dense(ti.i, 4).place(x)
+
+    @ti.kernel
+    def activate():
+        for i in range(500):
+            x[i * 4093] = 1
+
+    @ti.kernel
+    def count() -> ti.i32:
+        for i in x:
+            s[None] += 1
+            x[i] += i
+        return s[None]
+
+    activate()
+    # Each activated cell of the hash node holds a dense block of 4 elements
+    assert count() == 500 * 4
+    for i in range(500):
+        assert x[i * 4093] == 1 + i * 4093
+
+
+@test_utils.test(arch=ti.cpu)
+def test_hash_2d_leaf_struct_for():
+    x = ti.field(ti.i32)
+    s = ti.field(ti.i64, shape=())
+
+    ti.root.hash(ti.ij, 4096).place(x)
+
+    @ti.kernel
+    def activate():
+        for i in range(100):
+            x[i * 37, 4095 - i] = 1
+
+    @ti.kernel
+    def reduce():
+        for i, j in x:
+            s[None] += i * 4096 + j
+
+    activate()
+    reduce()
+    assert s[None] == sum(i * 37 * 4096 + 4095 - i for i in range(100))
+
+
+@test_utils.test(arch=ti.cpu)
+def test_hash_deactivate():
+    x = ti.field(ti.i32)
+    s = ti.field(ti.i32, shape=())
+    n = 1 << 16
+
+    h = ti.root.hash(ti.i, n)
+    h.place(x)
+
+    @ti.kernel
+    def activate():
+        for i in range(2000):
+            x[i * 31] = 1
+
+    @ti.kernel
+    def deactivate_odd():
+        for i in range(2000):
+            if i % 2 == 1:
+                ti.deactivate(h, i * 31)
+
+    @ti.kernel
+    def count() -> ti.i32:
+        s[None] = 0
+        for i in x:
+            s[None] += x[i]
+        return s[None]
+
+    @ti.kernel
+    def is_active(i: ti.i32) -> ti.i32:
+        return ti.is_active(h, [i])
+
+    activate()
+    assert count() == 2000
+    deactivate_odd()
+    assert count() == 1000
+    assert not is_active(31)
+    assert is_active(62)
+    # Reactivation after rehashing keeps the remaining cells intact
+    activate()
+    assert count() == 2000
+    h.deactivate_all()
+    assert count() == 0
+
+
+@test_utils.test(arch=ti.cpu)
+def test_hash_activation_cycles():
+    x = ti.field(ti.i32)
+    s = ti.field(ti.i32, shape=())
+
+    h = ti.root.hash(ti.i, 1 << 20)
+    h.place(x)
+
+    @ti.kernel
+    def activate(base: ti.i32):
+        for i in range(3000):
+            x[base + i * 7] = 1
+
+    @ti.kernel
+    def count() -> ti.i32:
+        s[None] = 0
+        for i in x:
+            s[None] += x[i]
+        return s[None]
+
+    # Each cycle reuses the slots of deactivated cells and the tables retired
+    # by the previous cycles.
+    for cycle in range(8):
+        activate(cycle * 100003)
+        assert count() == 3000
+        assert x[cycle * 100003 + 7] == 1
+        h.deactivate_all()
+        assert count() == 0
+
+
+@test_utils.test(arch=ti.cpu)
+def test_hash_too_many_cells():
+    x = ti.field(ti.i32)
+    ti.root.hash(ti.ij, 1 << 16).place(x)
+
+    with pytest.raises(RuntimeError, match='32-bit key range'):
+        x[0, 0] = 1
@@ -49,3 +49,77 @@ def test_oop_memory_leak():
         curr_mem = get_process_memory()
         assert (curr_mem - ref_mem < 5
                 )  # shouldn't increase more than 5.0 MB each loop
+
+
+@test_utils.test(arch=get_host_arch_list())
+def test_memory_pool_stats_ndarray_release():
+    n = 1024 * 1024
+    before = ti.profiler.get_memory_pool_stats()
+
+    a = ti.ndarray(ti.i32, shape=n)
+    a.fill(1)
+    during = ti.profiler.get_memory_pool_stats()
+    assert during['in_use_bytes'] - before['in_use_bytes'] >= n * 4
+    assert during['committed_bytes'] <= during['reserved_bytes']
+
+    del a
+    gc.collect()
+    after = ti.profiler.get_memory_pool_stats()
+    assert after['in_use_bytes'] == before['in_use_bytes']
+    assert after['committed_bytes'] == before['committed_bytes']
+
+    # The released block is reused and reads as zero
+    b = ti.ndarray(ti.i32, shape=n)
+    assert b[n - 1] == 0
+    assert ti.profiler.get_memory_pool_stats(
+    )['reserved_bytes'] == after['reserved_bytes']
+
+
+@test_utils.test(arch=get_host_arch_list())
+def test_memory_pool_stats_size_class():
+    # 12 MB and change, which is served from the 16 MB size class
+    n = (3 << 20) + 5
+    before = ti.profiler.get_memory_pool_stats()
+
+    a = ti.ndarray(ti.i32, shape=n)
+    during = ti.profiler.get_memory_pool_stats()
+    assert during['in_use_bytes'] - before['in_use_bytes'] >= n * 4
+    assert during['committed_bytes'] - before['committed_bytes'] >= 16 << 20
+
+    del a
+    gc.collect()
+    after = ti.profiler.get_memory_pool_stats()
+    assert after['in_use_bytes'] == before['in_use_bytes']
+    assert after['committed_bytes'] == before['committed_bytes']
+
+
+def _check_dense_field_and_ndarray():
+    n = 1 << 20
+    x = ti.field(ti.i32, shape=n)
+    a = ti.ndarray(ti.i32, shape=n)
+
+    @ti.kernel
+    def fill(a: ti.types.ndarray()):
+        for i in x:
+            x[i] += i
+            a[i] += 2 * i
+
+    fill(a)
+    assert x[n - 1] == n - 1
+    assert a[n - 1] == 2 * (n - 1)
+    assert x[0] == 0 and a[0] == 0
+
+
+@test_utils.test(arch=ti.cpu,
+                 cpu_pin_threads=True,
+                 cpu_huge_pages=True,
+                 cpu_numa_policy='interleave')
+def test_memory_placement_interleave():
+    _check_dense_field_and_ndarray()
+
+
+@test_utils.test(arch=ti.cpu,
+                 cpu_pin_threads=True,
+                 cpu_numa_policy='first_touch')
+def test_memory_placement_first_touch():
+    _check_dense_field_and_ndarray()
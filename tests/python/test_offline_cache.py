@@ -569,3 +569,52 @@ def test_offline_cache_for_kernels_calling_real_func(curr_arch):
 
     ti.reset()
     assert added_files() == expected_num_cache_files(2)
+
+
+@test_utils.test(arch=list(supported_llvm_archs), offline_cache=False)
+def test_kernel_cache_fingerprint():
+    x = ti.field(ti.i32, shape=8)
+
+    def make_kernel():
+        @ti.kernel
+        def fill():
+            for i in x:
+                x[i] = i
+
+        return fill
+
+    stats = lambda: ti.lang.impl.get_runtime().prog.get_kernel_cache_stats()
+    make_kernel()()
+    before = stats()
+    # The same kernel again, without the full key being hashed
+    make_kernel()()
+    after = stats()
+    assert after['fingerprint_hits'] == before['fingerprint_hits'] + 1
+    assert after['fingerprint_misses'] == before['fingerprint_misses']
+    assert after['memory_hits'] == before['memory_hits'] + 1
+    assert after['misses'] == before['misses']
+    assert x[7] == 7
+
+
+@pytest.mark.skipif(ti.cpu not in supported_archs_offline_cache,
+                    reason='Object code is only cached for CPU kernels')
+@_test_offline_cache_dec
+def test_offline_cache_object_code():
+    def my_init():
+        ti.init(arch=ti.cpu,
+                enable_fallback=False,
+                offline_cache_object_code=True,
+                **current_thread_ext_options())
+
+    stats = lambda: ti.lang.impl.get_runtime().prog.get_kernel_cache_stats()
+    for kernel, args, get_res in simple_kernels_to_test:
+        my_init()
+        res1 = kernel(*args)
+        assert stats()['misses'] == 1
+
+        my_init()
+        res2 = kernel(*args)
+        assert stats()['disk_hits'] == 1
+        assert stats()['misses'] == 0
+        assert res1 == test_utils.approx(get_res(*args))
+        assert res1 == test_utils.approx(res2)
@@ -82,3 +82,56 @@ def test_reduce_merged():
         assert b.grad[i] == 1
     for i in range(16):
         assert a.grad[i] == 1
+
+
+@test_utils.test(arch=ti.cpu,
+                 llvm_per_task_opt=True,
+                 print_compile_time_breakdown=True)
+def test_llvm_per_task_opt():
+    x = ti.field(ti.i32)
+    ti.root.pointer(ti.i, 16).dense(ti.i, 4).place(x)
+    s = ti.field(ti.i32, shape=())
+
+    @ti.kernel
+    def run() -> ti.i32:
+        for i in range(32):
+            x[i * 2] = i
+        for i in x:
+            x[i] += 1
+        for i in x:
+            s[None] += x[i]
+        return s[None]
+
+    # All 16 blocks of 4 elements are activated
+    assert run() == sum(range(32)) + 16 * 4
+
+
+def _test_llvm_shared_runtime():
+    x = ti.field(ti.f32)
+    ti.root.pointer(ti.i, 16).bitmasked(ti.i, 4).place(x)
+    s = ti.field(ti.f32, shape=())
+
+    @ti.kernel
+    def fill():
+        for i in range(32):
+            x[i * 2] = ti.sqrt(i * i)
+
+    @ti.kernel
+    def reduce() -> ti.f32:
+        # Links in the struct-for function specialized for its TLS buffer
+        for i in x:
+            s[None] += x[i]
+        return s[None]
+
+    fill()
+    assert reduce() == test_utils.approx(sum(range(32)))
+
+
+@test_utils.test(arch=ti.cpu, llvm_shared_runtime=True)
+def test_llvm_shared_runtime():
+    _test_llvm_shared_runtime()
+
+
+@test_utils.test(arch=ti.cpu, llvm_shared_runtime=True, llvm_per_task_opt=True)
+def test_llvm_shared_runtime_per_task_opt():
+    _test_llvm_shared_runtime()
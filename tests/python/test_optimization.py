@@ -143,3 +143,34 @@ def test_parallel_assignment():
     for i in range(3):
         for j in range(4):
             assert mat[i, j] == i + 1
+
+
+@test_utils.test(arch=ti.cpu, tiered_jit=True, tiered_jit_threshold=2)
+def test_tiered_jit():
+    x = ti.field(ti.f32, shape=64)
+
+    @ti.kernel
+    def inc(k: ti.f32):
+        for i in x:
+            x[i] += k * i
+
+    # The kernel is swapped for its optimized version at some point in between
+    for k in range(100):
+        inc(1.0)
+    ti.sync()
+    for i in range(64):
+        assert x[i] == 100 * i
+
+
+@test_utils.test(arch=ti.cpu, tiered_jit=True, external_optimization_level=0)
+def test_unoptimized_cpu_kernel():
+    x = ti.field(ti.i32, shape=16)
+
+    @ti.kernel
+    def fill():
+        for i in x:
+            x[i] = i * i
+
+    fill()
+    for i in range(16):
+        assert x[i] == i * i
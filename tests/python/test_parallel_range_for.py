@@ -87,3 +87,91 @@ def test_loop_config_block_dim_adaptive():
     val_np = val.to_numpy()
     for i in range(n):
         assert val_np[i] == i
+
+
+@test_utils.test(arch=[ti.cpu], cpu_work_stealing=True)
+def test_work_stealing_range_for():
+    n = 4096
+    val = ti.field(ti.i32, shape=(n))
+
+    @ti.kernel
+    def fill(m: ti.i32):
+        ti.loop_config(block_dim=8)
+        for i in range(m):
+            val[i] += i
+
+    for m in [0, 1, 7, 100, n]:
+        val.fill(0)
+        fill(m)
+        val_np = val.to_numpy()
+        for i in range(n):
+            assert val_np[i] == (i if i < m else 0)
+
+
+@test_utils.test(arch=[ti.cpu], cpu_work_stealing=True)
+def test_work_stealing_struct_for():
+    n = 1024
+    x = ti.field(ti.i32)
+    ti.root.pointer(ti.i, n // 16).dense(ti.i, 16).place(x)
+
+    @ti.kernel
+    def activate():
+        for i in range(n):
+            if i % 3 == 0:
+                x[i] = 1
+
+    @ti.kernel
+    def count() -> ti.i32:
+        s = 0
+        for i in x:
+            s += x[i]
+        return s
+
+    activate()
+    for _ in range(100):
+        assert count() == (n + 2) // 3
+
+
+@test_utils.test(arch=[ti.cpu], cpu_adaptive_chunking=True)
+def test_adaptive_chunking_range_for():
+    n = 10000
+    val = ti.field(ti.i32, shape=(n))
+
+    @ti.kernel
+    def fill(m: ti.i32):
+        for i in range(m):
+            s = 0
+            # Irregular per-iteration cost
+            for j in range(i % 100):
+                s += j
+            val[i] += s
+
+    # The chunk size changes across launches
+    for _ in range(10):
+        fill(n)
+    fill(17)
+    val_np = val.to_numpy()
+    for i in range(n):
+        k = i % 100
+        expected = k * (k - 1) // 2 * (11 if i < 17 else 10)
+        assert val_np[i] == expected
+
+
+@test_utils.test(arch=[ti.cpu], make_cpu_multithreading_loop=False)
+def test_range_for_block_body_continue():
+    n = 1000
+    val = ti.field(ti.i32, shape=n)
+
+    @ti.kernel
+    def fill(begin: ti.i32, end: ti.i32):
+        # Blocks which do not divide the range evenly
+        ti.loop_config(block_dim=7)
+        for i in range(begin, end):
+            if i % 3 == 0:
+                continue
+            val[i] = i
+
+    fill(5, n - 2)
+    val_np = val.to_numpy()
+    for i in range(n):
+        assert val_np[i] == (i if 5 <= i < n - 2 and i % 3 != 0 else 0)
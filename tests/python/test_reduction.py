@@ -160,3 +160,59 @@ def test_reduction_ndarray():
     n = 1024
     x = np.ones(n, dtype=np.int32)
     assert reduce(x) == -n
+
+
+@test_utils.test()
+def test_reduction_many_blocks_per_thread():
+    n = 100000
+    x = ti.field(ti.i32)
+    ti.root.pointer(ti.i, n // 64).dense(ti.i, 64).place(x)
+
+    @ti.kernel
+    def fill():
+        for i in range(n):
+            if i % 3 == 0:
+                x[i] = i
+
+    @ti.kernel
+    def range_reduce() -> ti.i32:
+        s = 0
+        ti.loop_config(block_dim=4)
+        for i in range(n):
+            s += 1
+        return s
+
+    @ti.kernel
+    def struct_reduce() -> ti.i32:
+        s = 0
+        for i in x:
+            ti.atomic_max(s, x[i])
+        return s
+
+    fill()
+    assert range_reduce() == n
+    assert struct_reduce() == (n - 1) // 3 * 3
+
+
+@test_utils.test(arch=ti.cpu, cpu_max_num_threads=4)
+def test_reduction_large_tls():
+    # Enough thread-local accumulators that the TLS buffers of all the
+    # threads don't fit on the stack of the launching thread
+    m = 512
+    n = 10000
+    s = ti.field(ti.i32, shape=m)
+
+    @ti.kernel
+    def reduce():
+        ti.loop_config(block_dim=16)
+        for i in range(n):
+            for k in ti.static(range(m)):
+                s[k] += i % (k + 1)
+
+    i = np.arange(n)
+    expected = np.array([(i % (k + 1)).sum() for k in range(m)])
+    # The second launch reuses the TLS storage of the first one
+    for _ in range(2):
+        s.fill(0)
+        reduce()
+        np.testing.assert_array_equal(s.to_numpy(), expected)
@@ -0,0 +1,47 @@
+import numpy as np
+
+import taichi as ti
+from tests import test_utils
+
+
+@test_utils.test(arch=[ti.cpu], cpu_slp_vectorization=True)
+def test_slp_vectorize_elementwise():
+    n = 64
+    a = ti.Vector.field(8, ti.f32, shape=n)
+    b = ti.Vector.field(8, ti.f32, shape=n)
+    c = ti.Vector.field(8, ti.f32, shape=n)
+
+    @ti.kernel
+    def compute():
+        for i in a:
+            u = a[i] * b[i] + 2.0
+            v = ti.max(u - b[i], a[i]) / 4.0
+            c[i] = ti.min(u, v) * u
+
+    a_np = np.random.rand(n, 8).astype(np.float32)
+    b_np = np.random.rand(n, 8).astype(np.float32)
+    a.from_numpy(a_np)
+    b.from_numpy(b_np)
+    compute()
+    u = a_np * b_np + 2.0
+    v = np.maximum(u - b_np, a_np) / 4.0
+    np.testing.assert_allclose(c.to_numpy(), np.minimum(u, v) * u, rtol=1e-5)
+
+
+@test_utils.test(arch=[ti.cpu], cpu_slp_vectorization=True)
+def test_slp_vectorize_scalar_uses():
+    x = ti.field(ti.f64, shape=4)
+    y = ti.field(ti.f64, shape=4)
+
+    @ti.kernel
+    def compute() -> ti.f64:
+        p = ti.Vector([x[0], x[1], x[2], x[3]])
+        q = p * p
+        # Lanes used both as a vector and as scalars
+        for k in ti.static(range(4)):
+            y[k] = q[k] + p[k]
+        return q[0] + q[3]
+
+    x.from_numpy(np.array([1.0, 2.0, 3.0, 4.0]))
+    assert compute() == 17.0
+    np.testing.assert_allclose(y.to_numpy(), [2.0, 6.0, 12.0, 20.0])
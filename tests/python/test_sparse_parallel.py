@@ -78,3 +78,40 @@ def test_nested_struct_fill_and_clear():
     for i in range(10):
         task()
         ti.sync()
+
+
+@test_utils.test(require=ti.extension.sparse)
+def test_pointer_contended_activation():
+    x = ti.field(ti.i32)
+    s = ti.field(ti.i32, shape=())
+
+    n = 64
+
+    ptr = ti.root.pointer(ti.i, n)
+    ptr.dense(ti.i, 16).place(x)
+
+    @ti.kernel
+    def scatter():
+        # Many threads race to activate the same few blocks
+        for i in range(n * 16 * 64):
+            ti.atomic_add(x[i % (n * 16)], 1)
+
+    @ti.kernel
+    def count():
+        for i in x:
+            s[None] += x[i]
+
+    @ti.kernel
+    def clear():
+        for i in range(n):
+            ti.deactivate(ptr, [i])
+
+    for _ in range(3):
+        s[None] = 0
+        scatter()
+        count()
+        assert s[None] == n * 16 * 64
+        clear()
+        s[None] = 0
+        count()
+        assert s[None] == 0
@@ -25,3 +25,37 @@ def test_kernel_sync():
     # These [] calls are on CPU. They should be smart enough to sync only once.
     for i in range(n):
         assert y[i] == x[i % 3]
+
+
+@test_utils.test(arch=ti.cpu, cpu_async_launch=True)
+def test_cpu_async_launch():
+    n = 1024
+    x = ti.field(ti.i32, shape=n)
+    a = ti.ndarray(ti.i32, shape=n)
+
+    @ti.kernel
+    def inc(k: ti.i32, a: ti.types.ndarray()):
+        for i in x:
+            x[i] = x[i] * 2 + k
+            a[i] += k
+
+    @ti.kernel
+    def total() -> ti.i32:
+        s = 0
+        for i in x:
+            s += x[i]
+        return s
+
+    # Launches are queued in order, so each one sees the previous ones' results
+    for k in range(16):
+        inc(k, a)
+    expected = 0
+    for k in range(16):
+        expected = expected * 2 + k
+    # Kernels with return values wait for the queued launches
+    assert total() == expected * n
+    inc(1, a)
+    # So do host reads of fields and ndarrays
+    assert x[n - 1] == expected * 2 + 1
+    assert a[n - 1] == sum(range(16)) + 1
+    ti.sync()